@@ -6,9 +6,18 @@
  */
 
 #include "ast.h"
+#include "spans.h"
+#include "utf8.h"
+#include "base64.h"
+#include "strpool.h"
+#include "shape.h"
 #include <stdlib.h>
 #include <string.h>
 
+#ifndef __STDC_NO_ATOMICS__
+#include <stdatomic.h>
+#endif
+
 /* ── Internal helpers ─────────────────────────────────────────────────── */
 
 static char *xcdn_strdup(const char *s) {
@@ -21,6 +30,59 @@ static char *xcdn_strdup(const char *s) {
 
 #define INITIAL_CAP 4
 
+static int is_ident_start(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static int is_ident_part(unsigned char c) {
+    return is_ident_start(c) || (c >= '0' && c <= '9') || c == '-';
+}
+
+uint32_t xcdn_string_flags(const char *s, size_t len) {
+    unsigned char seen = 0;
+    int plain = 1;
+    int ident = len > 0 && is_ident_start((unsigned char)s[0]);
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)s[i];
+        seen |= c;
+        if (c < 32 || c == '"' || c == '\\') plain = 0;
+        if (!is_ident_part(c)) ident = 0;
+    }
+    return XCDN_FLAG_SCANNED |
+           (seen < 0x80 ? XCDN_FLAG_ASCII : 0) |
+           (plain ? XCDN_FLAG_PLAIN : 0) |
+           (ident ? XCDN_FLAG_IDENT : 0);
+}
+
+/*
+ * Store a string payload and its metadata, inline when it is short.
+ * Takes ownership of `owned` (a heap copy of `s`, or NULL to copy `s`).
+ */
+static void set_string(xcdn_value_t *val, const char *s, size_t len,
+                       uint32_t flags, char *owned) {
+    if (len < XCDN_SSO_CAP) {
+        memcpy(val->data.string_sso, s, len);
+        val->data.string_sso[len] = '\0';
+        val->data.string = val->data.string_sso;
+        free(owned);
+    } else if (owned) {
+        val->data.string = owned;
+    } else {
+        val->data.string = (char *)malloc(len + 1);
+        if (!val->data.string) return;
+        memcpy(val->data.string, s, len + 1);
+    }
+    val->data.string_len = len;
+    val->flags |= flags;
+}
+
+/* Store a NUL-terminated payload (NULL leaves the value without one). */
+static void set_cstring(xcdn_value_t *val, const char *s, char *owned) {
+    if (!s) return;
+    size_t len = strlen(s);
+    set_string(val, s, len, xcdn_string_flags(s, len), owned);
+}
+
 static void grow_ptr_array(void **ptr, size_t *cap, size_t elem_size) {
     size_t new_cap = (*cap == 0) ? INITIAL_CAP : (*cap * 2);
     void *new_ptr = realloc(*ptr, new_cap * elem_size);
@@ -30,6 +92,16 @@ static void grow_ptr_array(void **ptr, size_t *cap, size_t elem_size) {
     }
 }
 
+/* Make room for at least `need` elements. */
+static bool reserve_array(void **ptr, size_t *cap, size_t need, size_t elem_size) {
+    if (need <= *cap) return true;
+    void *new_ptr = realloc(*ptr, need * elem_size);
+    if (!new_ptr) return false;
+    *ptr = new_ptr;
+    *cap = need;
+    return true;
+}
+
 /* ── Document ─────────────────────────────────────────────────────────── */
 
 xcdn_document_t *xcdn_document_new(void) {
@@ -38,7 +110,7 @@ xcdn_document_t *xcdn_document_new(void) {
 }
 
 void xcdn_document_push_value(xcdn_document_t *doc, xcdn_node_t *node) {
-    if (!doc || !node) return;
+    if (!doc || doc->frozen || !node) return;
     if (doc->values_len >= doc->values_cap) {
         grow_ptr_array((void **)&doc->values, &doc->values_cap,
                        sizeof(xcdn_node_t *));
@@ -48,7 +120,7 @@ void xcdn_document_push_value(xcdn_document_t *doc, xcdn_node_t *node) {
 
 void xcdn_document_push_directive(xcdn_document_t *doc, const char *name,
                                   xcdn_value_t *value) {
-    if (!doc) return;
+    if (!doc || doc->frozen) return;
     if (doc->prolog_len >= doc->prolog_cap) {
         grow_ptr_array((void **)&doc->prolog, &doc->prolog_cap,
                        sizeof(xcdn_directive_t));
@@ -84,7 +156,7 @@ xcdn_node_t *xcdn_node_new(xcdn_value_t *value) {
 }
 
 void xcdn_node_add_tag(xcdn_node_t *node, const char *name) {
-    if (!node) return;
+    if (!node || (node->flags & XCDN_FLAG_FROZEN)) return;
     if (node->tags_len >= node->tags_cap) {
         grow_ptr_array((void **)&node->tags, &node->tags_cap,
                        sizeof(xcdn_tag_t));
@@ -94,7 +166,7 @@ void xcdn_node_add_tag(xcdn_node_t *node, const char *name) {
 }
 
 void xcdn_node_add_annotation(xcdn_node_t *node, const char *name) {
-    if (!node) return;
+    if (!node || (node->flags & XCDN_FLAG_FROZEN)) return;
     if (node->annotations_len >= node->annotations_cap) {
         grow_ptr_array((void **)&node->annotations, &node->annotations_cap,
                        sizeof(xcdn_annotation_t));
@@ -106,7 +178,7 @@ void xcdn_node_add_annotation(xcdn_node_t *node, const char *name) {
 }
 
 void xcdn_annotation_push_arg(xcdn_annotation_t *ann, xcdn_value_t *val) {
-    if (!ann || !val) return;
+    if (!ann || !val || (ann->flags & XCDN_FLAG_FROZEN)) return;
     if (ann->args_len >= ann->args_cap) {
         grow_ptr_array((void **)&ann->args, &ann->args_cap,
                        sizeof(xcdn_value_t *));
@@ -144,21 +216,59 @@ xcdn_value_t *xcdn_value_float(double v) {
     return val;
 }
 
+xcdn_value_t *xcdn_value_number_raw(const char *text, size_t len, bool is_float) {
+    xcdn_value_t *val = alloc_value(is_float ? XCDN_VAL_FLOAT : XCDN_VAL_INT);
+    if (!val) return NULL;
+    char *dst = val->data.number_sso;
+    if (len >= XCDN_SSO_CAP) {
+        dst = val->data.number_heap = (char *)malloc(len + 1);
+        if (!dst) {
+            free(val);
+            return NULL;
+        }
+    }
+    memcpy(dst, text, len);
+    dst[len] = '\0';
+    val->data.number_len = len;
+    val->flags |= XCDN_FLAG_RAW_NUMBER | XCDN_FLAG_PENDING;
+    return val;
+}
+
 xcdn_value_t *xcdn_value_decimal(const char *s) {
     xcdn_value_t *val = alloc_value(XCDN_VAL_DECIMAL);
-    if (val) val->data.string = xcdn_strdup(s);
+    if (val) set_cstring(val, s, NULL);
     return val;
 }
 
 xcdn_value_t *xcdn_value_string(const char *s) {
     xcdn_value_t *val = alloc_value(XCDN_VAL_STRING);
-    if (val) val->data.string = xcdn_strdup(s);
+    if (val) set_cstring(val, s, NULL);
     return val;
 }
 
 xcdn_value_t *xcdn_value_string_owned(char *s) {
     xcdn_value_t *val = alloc_value(XCDN_VAL_STRING);
-    if (val) val->data.string = s;
+    if (val) set_cstring(val, s, s);
+    return val;
+}
+
+xcdn_value_t *xcdn_value_string_scanned(char *s, size_t len, uint32_t flags) {
+    xcdn_value_t *val = alloc_value(XCDN_VAL_STRING);
+    if (val) set_string(val, s, len, flags, s);
+    else free(s);
+    return val;
+}
+
+xcdn_value_t *xcdn_value_string_pooled(xcdn_value_type_t type, char *text,
+                                       size_t len, uint32_t flags) {
+    xcdn_value_t *val = alloc_value(type);
+    if (!val) {
+        xcdn_strpool_release(text);
+        return NULL;
+    }
+    val->data.string = text;
+    val->data.string_len = len;
+    val->flags |= flags | XCDN_FLAG_POOLED;
     return val;
 }
 
@@ -183,21 +293,33 @@ xcdn_value_t *xcdn_value_bytes_owned(uint8_t *data, size_t len) {
     return val;
 }
 
+xcdn_value_t *xcdn_value_bytes_base64(char *text, size_t text_len, size_t len) {
+    xcdn_value_t *val = alloc_value(XCDN_VAL_BYTES);
+    if (!val) {
+        free(text);
+        return NULL;
+    }
+    val->data.bytes.encoded = text;
+    val->data.bytes.encoded_len = text_len;
+    val->data.bytes.len = len;
+    return val;
+}
+
 xcdn_value_t *xcdn_value_datetime(const char *s) {
     xcdn_value_t *val = alloc_value(XCDN_VAL_DATETIME);
-    if (val) val->data.string = xcdn_strdup(s);
+    if (val) set_cstring(val, s, NULL);
     return val;
 }
 
 xcdn_value_t *xcdn_value_duration(const char *s) {
     xcdn_value_t *val = alloc_value(XCDN_VAL_DURATION);
-    if (val) val->data.string = xcdn_strdup(s);
+    if (val) set_cstring(val, s, NULL);
     return val;
 }
 
 xcdn_value_t *xcdn_value_uuid(const char *s) {
     xcdn_value_t *val = alloc_value(XCDN_VAL_UUID);
-    if (val) val->data.string = xcdn_strdup(s);
+    if (val) set_cstring(val, s, NULL);
     return val;
 }
 
@@ -213,6 +335,7 @@ xcdn_value_t *xcdn_value_object(void) {
 
 void xcdn_array_push(xcdn_value_t *arr, xcdn_node_t *node) {
     if (!arr || arr->type != XCDN_VAL_ARRAY || !node) return;
+    if (arr->flags & XCDN_FLAG_FROZEN) return;
     if (arr->data.array.len >= arr->data.array.cap) {
         grow_ptr_array((void **)&arr->data.array.items, &arr->data.array.cap,
                        sizeof(xcdn_node_t *));
@@ -220,6 +343,61 @@ void xcdn_array_push(xcdn_value_t *arr, xcdn_node_t *node) {
     arr->data.array.items[arr->data.array.len++] = node;
 }
 
+bool xcdn_array_reserve(xcdn_value_t *arr, size_t cap) {
+    if (!arr || arr->type != XCDN_VAL_ARRAY || (arr->flags & XCDN_FLAG_FROZEN))
+        return false;
+    return reserve_array((void **)&arr->data.array.items, &arr->data.array.cap,
+                         cap, sizeof(xcdn_node_t *));
+}
+
+bool xcdn_array_splice(xcdn_value_t *arr, size_t index, size_t remove_count,
+                       xcdn_node_t *const *nodes, size_t count) {
+    if (!arr || arr->type != XCDN_VAL_ARRAY || (arr->flags & XCDN_FLAG_FROZEN))
+        return false;
+    size_t len = arr->data.array.len;
+    if (index > len || remove_count > len - index) return false;
+    if (count > 0 && !nodes) return false;
+    for (size_t i = 0; i < count; i++) {
+        if (!nodes[i]) return false;
+    }
+
+    size_t new_len = len - remove_count + count;
+    if (new_len > arr->data.array.cap) {
+        size_t cap = arr->data.array.cap ? arr->data.array.cap * 2 : INITIAL_CAP;
+        if (cap < new_len) cap = new_len;
+        xcdn_node_t **items = (xcdn_node_t **)realloc(arr->data.array.items,
+                                                      cap * sizeof(xcdn_node_t *));
+        if (!items) return false;
+        arr->data.array.items = items;
+        arr->data.array.cap = cap;
+    }
+
+    xcdn_node_t **items = arr->data.array.items;
+    for (size_t i = 0; i < remove_count; i++)
+        xcdn_node_free(items[index + i]);
+    /* Shift the tail once, then drop the new nodes into the gap */
+    size_t tail = len - index - remove_count;
+    if (count != remove_count && tail > 0)
+        memmove(&items[index + count], &items[index + remove_count],
+                tail * sizeof(xcdn_node_t *));
+    if (count > 0) memcpy(&items[index], nodes, count * sizeof(xcdn_node_t *));
+    arr->data.array.len = new_len;
+    return true;
+}
+
+bool xcdn_array_append(xcdn_value_t *arr, xcdn_node_t *const *nodes, size_t count) {
+    return arr && arr->type == XCDN_VAL_ARRAY &&
+           xcdn_array_splice(arr, arr->data.array.len, 0, nodes, count);
+}
+
+bool xcdn_array_insert(xcdn_value_t *arr, size_t index, xcdn_node_t *node) {
+    return node && xcdn_array_splice(arr, index, 0, &node, 1);
+}
+
+bool xcdn_array_remove(xcdn_value_t *arr, size_t index) {
+    return xcdn_array_splice(arr, index, 1, NULL, 0);
+}
+
 xcdn_node_t *xcdn_array_get(const xcdn_value_t *arr, size_t index) {
     if (!arr || arr->type != XCDN_VAL_ARRAY) return NULL;
     if (index >= arr->data.array.len) return NULL;
@@ -233,35 +411,207 @@ size_t xcdn_array_len(const xcdn_value_t *arr) {
 
 /* ── Object operations ────────────────────────────────────────────────── */
 
-void xcdn_object_set(xcdn_value_t *obj, const char *key, xcdn_node_t *node) {
-    if (!obj || obj->type != XCDN_VAL_OBJECT || !key || !node) return;
+/* Index of the entry with this key, or the object's length if none. */
+static size_t object_find(const xcdn_value_t *obj, const char *key, size_t key_len) {
+    if (obj->data.object.shape)
+        return xcdn_shape_find(obj->data.object.shape, key, key_len);
+    size_t i = 0;
+    for (; i < obj->data.object.len; i++) {
+        const xcdn_object_entry_t *e = &obj->data.object.entries[i];
+        if (e->key_len == key_len && memcmp(xcdn_entry_key(e), key, key_len) == 0)
+            break;
+    }
+    return i;
+}
 
-    /* Check if key already exists and update */
-    for (size_t i = 0; i < obj->data.object.len; i++) {
-        if (strcmp(obj->data.object.entries[i].key, key) == 0) {
-            xcdn_node_free(obj->data.object.entries[i].node);
-            obj->data.object.entries[i].node = node;
-            return;
+/* Turn a shaped object back into one owning its entries. */
+static bool object_unshape(xcdn_value_t *obj) {
+    xcdn_shape_t *shape = obj->data.object.shape;
+    size_t len = obj->data.object.len;
+    xcdn_object_entry_t *entries =
+        (xcdn_object_entry_t *)malloc((len + 1) * sizeof(xcdn_object_entry_t));
+    if (!entries) return false;
+    for (size_t i = 0; i < len; i++) {
+        entries[i] = shape->keys[i];
+        entries[i].node = obj->data.object.slots[i];
+        if (XCDN_KEY_INLINE(entries[i].key_len)) continue;
+        entries[i].key_heap = (char *)malloc(entries[i].key_len + 1);
+        if (!entries[i].key_heap) {
+            while (i-- > 0) {
+                if (!XCDN_KEY_INLINE(entries[i].key_len)) free(entries[i].key_heap);
+            }
+            free(entries);
+            return false;
         }
+        memcpy(entries[i].key_heap, shape->keys[i].key_heap, entries[i].key_len + 1);
     }
+    free(obj->data.object.slots);
+    xcdn_shape_release(shape);
+    obj->data.object.entries = entries;
+    obj->data.object.cap = len + 1;
+    obj->data.object.shape = NULL;
+    return true;
+}
 
-    /* Insert new entry */
+/*
+ * Add an entry for a key the object does not have yet. Takes ownership of
+ * `owned` (a heap copy of `key`, or NULL to copy `key` if it does not fit
+ * inline) only on success.
+ */
+static bool object_append(xcdn_value_t *obj, const char *key, size_t key_len,
+                          uint32_t key_flags, char *owned, xcdn_node_t *node) {
+    if (obj->data.object.shape && !object_unshape(obj)) return false;
     if (obj->data.object.len >= obj->data.object.cap) {
         grow_ptr_array((void **)&obj->data.object.entries, &obj->data.object.cap,
                        sizeof(xcdn_object_entry_t));
+        if (obj->data.object.len >= obj->data.object.cap) return false;
+    }
+    xcdn_object_entry_t *e = &obj->data.object.entries[obj->data.object.len];
+    if (XCDN_KEY_INLINE(key_len)) {
+        memcpy(e->key_sso, key, key_len);
+        e->key_sso[key_len] = '\0';
+        free(owned);
+    } else if (owned) {
+        e->key_heap = owned;
+    } else {
+        e->key_heap = (char *)malloc(key_len + 1);
+        if (!e->key_heap) return false;
+        memcpy(e->key_heap, key, key_len);
+        e->key_heap[key_len] = '\0';
     }
-    xcdn_object_entry_t *e = &obj->data.object.entries[obj->data.object.len++];
-    e->key = xcdn_strdup(key);
     e->node = node;
+    e->key_len = key_len;
+    e->key_flags = key_flags;
+    obj->data.object.len++;
+    return true;
+}
+
+/*
+ * Insert/update an entry. Takes ownership of `owned` (a heap copy of
+ * `key`, or NULL to copy `key` if it does not fit inline).
+ */
+static void object_put(xcdn_value_t *obj, const char *key, size_t key_len,
+                       uint32_t key_flags, char *owned, xcdn_node_t *node) {
+    size_t i = object_find(obj, key, key_len);
+    if (i < obj->data.object.len) {
+        xcdn_node_t **slot = xcdn_object_slot(obj, i);
+        xcdn_node_free(*slot);
+        *slot = node;
+        free(owned);
+        return;
+    }
+    if (!object_append(obj, key, key_len, key_flags, owned, node)) {
+        free(owned);
+        xcdn_node_free(node);
+    }
+}
+
+void xcdn_object_set(xcdn_value_t *obj, const char *key, xcdn_node_t *node) {
+    if (!obj || obj->type != XCDN_VAL_OBJECT || !key || !node) return;
+    if (obj->flags & XCDN_FLAG_FROZEN) return;
+    size_t len = strlen(key);
+    object_put(obj, key, len, xcdn_string_flags(key, len), NULL, node);
+}
+
+void xcdn_object_set_scanned(xcdn_value_t *obj, char *key, size_t key_len,
+                             uint32_t key_flags, xcdn_node_t *node) {
+    if (!obj || obj->type != XCDN_VAL_OBJECT || !key || !node ||
+        (obj->flags & XCDN_FLAG_FROZEN)) {
+        free(key);
+        return;
+    }
+    object_put(obj, key, key_len, key_flags, key, node);
+}
+
+bool xcdn_object_reserve(xcdn_value_t *obj, size_t cap) {
+    if (!obj || obj->type != XCDN_VAL_OBJECT || (obj->flags & XCDN_FLAG_FROZEN))
+        return false;
+    /* Room for more keys means leaving the shape */
+    if (obj->data.object.shape && cap > obj->data.object.len &&
+        !object_unshape(obj))
+        return false;
+    size_t elem = obj->data.object.shape ? sizeof(xcdn_node_t *)
+                                         : sizeof(xcdn_object_entry_t);
+    return reserve_array((void **)&obj->data.object.entries, &obj->data.object.cap,
+                         cap, elem);
+}
+
+bool xcdn_object_append(xcdn_value_t *obj, const char *key, size_t key_len,
+                        uint32_t key_flags, xcdn_node_t *node) {
+    if (!obj || obj->type != XCDN_VAL_OBJECT || !key || !node ||
+        (obj->flags & XCDN_FLAG_FROZEN))
+        return false;
+    return object_append(obj, key, key_len, key_flags, NULL, node);
+}
+
+bool xcdn_object_append_owned(xcdn_value_t *obj, char *key, size_t key_len,
+                              uint32_t key_flags, xcdn_node_t *node) {
+    if (!obj || obj->type != XCDN_VAL_OBJECT || !key || !node ||
+        (obj->flags & XCDN_FLAG_FROZEN))
+        return false;
+    return object_append(obj, key, key_len, key_flags, key, node);
+}
+
+bool xcdn_object_remove(xcdn_value_t *obj, const char *key) {
+    if (!obj || obj->type != XCDN_VAL_OBJECT || !key ||
+        (obj->flags & XCDN_FLAG_FROZEN))
+        return false;
+    size_t i = object_find(obj, key, strlen(key));
+    if (i >= obj->data.object.len) return false;
+    /* Shapes are shared, so the object takes its keys back first */
+    if (obj->data.object.shape && !object_unshape(obj)) return false;
+
+    xcdn_object_entry_t *e = &obj->data.object.entries[i];
+    if (!XCDN_KEY_INLINE(e->key_len)) free(e->key_heap);
+    xcdn_node_free(e->node);
+    memmove(e, e + 1, (obj->data.object.len - i - 1) * sizeof(*e));
+    obj->data.object.len--;
+    return true;
+}
+
+bool xcdn_object_intern_shape(xcdn_value_t *obj, xcdn_shape_table_t *shapes) {
+    if (!obj || obj->type != XCDN_VAL_OBJECT || obj->data.object.shape ||
+        obj->data.object.len == 0 || (obj->flags & XCDN_FLAG_FROZEN))
+        return false;
+    size_t len = obj->data.object.len;
+    xcdn_object_entry_t *entries = obj->data.object.entries;
+    xcdn_node_t **slots = (xcdn_node_t **)malloc(len * sizeof(xcdn_node_t *));
+    xcdn_shape_t *shape = slots ? xcdn_shape_intern(shapes, entries, len) : NULL;
+    if (!shape) {
+        free(slots);
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        slots[i] = entries[i].node;
+        if (!XCDN_KEY_INLINE(entries[i].key_len)) free(entries[i].key_heap);
+    }
+    free(entries);
+    obj->data.object.slots = slots;
+    obj->data.object.cap = len;
+    obj->data.object.shape = shape;
+    return true;
 }
 
 xcdn_node_t *xcdn_object_get(const xcdn_value_t *obj, const char *key) {
     if (!obj || obj->type != XCDN_VAL_OBJECT || !key) return NULL;
-    for (size_t i = 0; i < obj->data.object.len; i++) {
-        if (strcmp(obj->data.object.entries[i].key, key) == 0)
-            return obj->data.object.entries[i].node;
+    size_t i = object_find(obj, key, strlen(key));
+    return i < obj->data.object.len ? *xcdn_object_slot(obj, i) : NULL;
+}
+
+xcdn_node_t *xcdn_object_get_cached(const xcdn_value_t *obj, const char *key,
+                                    size_t *hint) {
+    if (!obj || obj->type != XCDN_VAL_OBJECT || !key) return NULL;
+    size_t len = strlen(key);
+    size_t i = hint ? *hint : obj->data.object.len;
+    if (i < obj->data.object.len) {
+        const xcdn_object_entry_t *e = xcdn_object_key_entry(obj, i);
+        if (e->key_len == len && memcmp(xcdn_entry_key(e), key, len) == 0)
+            return *xcdn_object_slot(obj, i);
     }
-    return NULL;
+    i = object_find(obj, key, len);
+    if (i >= obj->data.object.len) return NULL;
+    if (hint) *hint = i;
+    return *xcdn_object_slot(obj, i);
 }
 
 bool xcdn_object_has(const xcdn_value_t *obj, const char *key) {
@@ -276,13 +626,855 @@ size_t xcdn_object_len(const xcdn_value_t *obj) {
 const char *xcdn_object_key_at(const xcdn_value_t *obj, size_t i) {
     if (!obj || obj->type != XCDN_VAL_OBJECT || i >= obj->data.object.len)
         return NULL;
-    return obj->data.object.entries[i].key;
+    return xcdn_entry_key(xcdn_object_key_entry(obj, i));
 }
 
 xcdn_node_t *xcdn_object_node_at(const xcdn_value_t *obj, size_t i) {
     if (!obj || obj->type != XCDN_VAL_OBJECT || i >= obj->data.object.len)
         return NULL;
-    return obj->data.object.entries[i].node;
+    return *xcdn_object_slot(obj, i);
+}
+
+/* ── Freezing ─────────────────────────────────────────────────────────── */
+
+static void freeze_node(xcdn_node_t *node);
+
+static void number_convert(xcdn_value_t *val);
+
+static void freeze_value(xcdn_value_t *val) {
+    if (!val) return;
+    val->flags |= XCDN_FLAG_FROZEN;
+    switch (val->type) {
+        case XCDN_VAL_INT:
+        case XCDN_VAL_FLOAT:
+            number_convert(val);
+            break;
+        case XCDN_VAL_ARRAY:
+            for (size_t i = 0; i < val->data.array.len; i++)
+                freeze_node(val->data.array.items[i]);
+            break;
+        case XCDN_VAL_OBJECT:
+            for (size_t i = 0; i < val->data.object.len; i++)
+                freeze_node(*xcdn_object_slot(val, i));
+            break;
+        default:
+            break;
+    }
+}
+
+static void freeze_node(xcdn_node_t *node) {
+    if (!node) return;
+    node->flags |= XCDN_FLAG_FROZEN;
+    for (size_t i = 0; i < node->annotations_len; i++) {
+        node->annotations[i].flags |= XCDN_FLAG_FROZEN;
+        for (size_t j = 0; j < node->annotations[i].args_len; j++)
+            freeze_value(node->annotations[i].args[j]);
+    }
+    freeze_value(node->value);
+}
+
+void xcdn_document_freeze(xcdn_document_t *doc) {
+    if (!doc || doc->frozen) return;
+    for (size_t i = 0; i < doc->prolog_len; i++)
+        freeze_value(doc->prolog[i].value);
+    for (size_t i = 0; i < doc->values_len; i++)
+        freeze_node(doc->values[i]);
+    doc->frozen = true;
+}
+
+bool xcdn_document_is_frozen(const xcdn_document_t *doc) {
+    return doc && doc->frozen;
+}
+
+/* ── Subtree sharing ──────────────────────────────────────────────────── */
+
+static uint64_t hash_mem(uint64_t h, const void *p, size_t n) {
+    const unsigned char *b = (const unsigned char *)p;
+    for (size_t i = 0; i < n; i++) {
+        h ^= b[i];
+        h *= 0x100000001B3ull;
+    }
+    return h;
+}
+
+static uint64_t hash_word(uint64_t h, uint64_t w) {
+    return hash_mem(h, &w, sizeof(w));
+}
+
+/* Text a string-like value holds, with its length. */
+static const char *value_text(const xcdn_value_t *v, size_t *len) {
+    const char *s = xcdn_value_as_string(v);
+    if (!s) s = "";
+    *len = (v->flags & XCDN_FLAG_SCANNED) ? v->data.string_len : strlen(s);
+    return s;
+}
+
+/*
+ * Hash of a value. Child nodes are hashed by address: sharing runs bottom
+ * up, so identical children are already the same node.
+ */
+static uint64_t value_hash(uint64_t h, const xcdn_value_t *v) {
+    if (!v) return hash_word(h, 0);
+    h = hash_word(h, (uint64_t)v->type + 1);
+    size_t len;
+    const char *text;
+    switch (v->type) {
+        case XCDN_VAL_BOOL:
+            return hash_word(h, v->data.boolean);
+        case XCDN_VAL_INT:
+        case XCDN_VAL_FLOAT:
+            if ((text = xcdn_value_number_text(v, &len)))
+                return hash_mem(h, text, len);
+            return hash_word(h, (uint64_t)v->data.integer);
+        case XCDN_VAL_STRING:
+        case XCDN_VAL_DECIMAL:
+        case XCDN_VAL_UUID:
+        case XCDN_VAL_DATETIME:
+        case XCDN_VAL_DURATION:
+            text = value_text(v, &len);
+            return hash_mem(h, text, len);
+        case XCDN_VAL_BYTES:
+            if (v->data.bytes.encoded)
+                return hash_mem(h, v->data.bytes.encoded, v->data.bytes.encoded_len);
+            return hash_mem(h, v->data.bytes.data, v->data.bytes.len);
+        case XCDN_VAL_ARRAY:
+            for (size_t i = 0; i < v->data.array.len; i++)
+                h = hash_word(h, (uint64_t)(uintptr_t)v->data.array.items[i]);
+            return h;
+        case XCDN_VAL_OBJECT:
+            for (size_t i = 0; i < v->data.object.len; i++) {
+                const xcdn_object_entry_t *e = xcdn_object_key_entry(v, i);
+                h = hash_mem(h, xcdn_entry_key(e), e->key_len + 1);
+                h = hash_word(h, (uint64_t)(uintptr_t)*xcdn_object_slot(v, i));
+            }
+            return h;
+        default:
+            return h;
+    }
+}
+
+static uint64_t node_hash(const xcdn_node_t *node) {
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < node->tags_len; i++)
+        h = hash_mem(h, node->tags[i].name, strlen(node->tags[i].name) + 1);
+    h = hash_word(h, node->tags_len);
+    for (size_t i = 0; i < node->annotations_len; i++) {
+        const xcdn_annotation_t *a = &node->annotations[i];
+        h = hash_mem(h, a->name, strlen(a->name) + 1);
+        h = hash_word(h, a->args_len);
+    }
+    return value_hash(h, node->value);
+}
+
+static bool node_identical(const xcdn_node_t *a, const xcdn_node_t *b, bool deep);
+
+/*
+ * Value identity. Child nodes are compared structurally when `deep`,
+ * otherwise by address.
+ */
+static bool value_identical(const xcdn_value_t *a, const xcdn_value_t *b,
+                            bool deep) {
+    if (a == b) return true;
+    if (!a || !b || a->type != b->type) return false;
+    const char *ta, *tb;
+    size_t la, lb;
+    switch (a->type) {
+        case XCDN_VAL_NULL:
+            return true;
+        case XCDN_VAL_BOOL:
+            return a->data.boolean == b->data.boolean;
+        case XCDN_VAL_INT:
+        case XCDN_VAL_FLOAT:
+            ta = xcdn_value_number_text(a, &la);
+            tb = xcdn_value_number_text(b, &lb);
+            if (ta || tb)
+                return ta && tb && la == lb && memcmp(ta, tb, la) == 0;
+            /* Bitwise, so 0.0 and -0.0 stay apart and NaN matches itself */
+            return memcmp(&a->data.integer, &b->data.integer,
+                          sizeof(a->data.integer)) == 0;
+        case XCDN_VAL_STRING:
+        case XCDN_VAL_DECIMAL:
+        case XCDN_VAL_UUID:
+        case XCDN_VAL_DATETIME:
+        case XCDN_VAL_DURATION:
+            ta = value_text(a, &la);
+            tb = value_text(b, &lb);
+            return la == lb && memcmp(ta, tb, la) == 0;
+        case XCDN_VAL_BYTES:
+            if (a->data.bytes.encoded || b->data.bytes.encoded)
+                return a->data.bytes.encoded && b->data.bytes.encoded &&
+                       a->data.bytes.encoded_len == b->data.bytes.encoded_len &&
+                       memcmp(a->data.bytes.encoded, b->data.bytes.encoded,
+                              a->data.bytes.encoded_len) == 0;
+            return a->data.bytes.len == b->data.bytes.len &&
+                   (a->data.bytes.len == 0 ||
+                    memcmp(a->data.bytes.data, b->data.bytes.data,
+                           a->data.bytes.len) == 0);
+        case XCDN_VAL_ARRAY:
+            if (a->data.array.len != b->data.array.len) return false;
+            for (size_t i = 0; i < a->data.array.len; i++) {
+                const xcdn_node_t *x = a->data.array.items[i];
+                const xcdn_node_t *y = b->data.array.items[i];
+                if (deep ? !node_identical(x, y, true) : x != y) return false;
+            }
+            return true;
+        case XCDN_VAL_OBJECT:
+            if (a->data.object.len != b->data.object.len) return false;
+            /* Objects of one shape have the same keys */
+            if (a->data.object.shape != b->data.object.shape ||
+                !a->data.object.shape) {
+                for (size_t i = 0; i < a->data.object.len; i++) {
+                    const xcdn_object_entry_t *x = xcdn_object_key_entry(a, i);
+                    const xcdn_object_entry_t *y = xcdn_object_key_entry(b, i);
+                    if (x->key_len != y->key_len ||
+                        memcmp(xcdn_entry_key(x), xcdn_entry_key(y), x->key_len) != 0)
+                        return false;
+                }
+            }
+            for (size_t i = 0; i < a->data.object.len; i++) {
+                const xcdn_node_t *x = *xcdn_object_slot(a, i);
+                const xcdn_node_t *y = *xcdn_object_slot(b, i);
+                if (deep ? !node_identical(x, y, true) : x != y) return false;
+            }
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool node_identical(const xcdn_node_t *a, const xcdn_node_t *b, bool deep) {
+    if (a == b) return true;
+    if (!a || !b) return false;
+    if (a->tags_len != b->tags_len || a->annotations_len != b->annotations_len)
+        return false;
+    for (size_t i = 0; i < a->tags_len; i++) {
+        if (strcmp(a->tags[i].name, b->tags[i].name) != 0) return false;
+    }
+    for (size_t i = 0; i < a->annotations_len; i++) {
+        const xcdn_annotation_t *x = &a->annotations[i], *y = &b->annotations[i];
+        if (x->args_len != y->args_len || strcmp(x->name, y->name) != 0)
+            return false;
+        /* Argument values are never shared, so always compare them fully */
+        for (size_t j = 0; j < x->args_len; j++) {
+            if (!value_identical(x->args[j], y->args[j], true)) return false;
+        }
+    }
+    return value_identical(a->value, b->value, deep);
+}
+
+bool xcdn_node_equal(const xcdn_node_t *a, const xcdn_node_t *b) {
+    return node_identical(a, b, true);
+}
+
+/* Canonical nodes seen so far, open addressing on the subtree hash. */
+typedef struct {
+    uint64_t           *hashes;
+    xcdn_node_t       **nodes;   /* NULL = empty slot */
+    size_t              len;
+    size_t              cap;
+    size_t              replaced;
+    xcdn_span_table_t  *spans;
+} share_table_t;
+
+static bool share_grow(share_table_t *t) {
+    size_t cap = (t->cap == 0) ? 256 : t->cap * 2;
+    uint64_t *hashes = (uint64_t *)malloc(cap * sizeof(uint64_t));
+    xcdn_node_t **nodes = (xcdn_node_t **)calloc(cap, sizeof(xcdn_node_t *));
+    if (!hashes || !nodes) {
+        free(hashes);
+        free(nodes);
+        return false;
+    }
+    for (size_t i = 0; i < t->cap; i++) {
+        if (!t->nodes[i]) continue;
+        size_t slot = (size_t)t->hashes[i] & (cap - 1);
+        while (nodes[slot]) slot = (slot + 1) & (cap - 1);
+        hashes[slot] = t->hashes[i];
+        nodes[slot] = t->nodes[i];
+    }
+    free(t->hashes);
+    free(t->nodes);
+    t->hashes = hashes;
+    t->nodes = nodes;
+    t->cap = cap;
+    return true;
+}
+
+/* Share the children of `node`, then return the canonical copy of it. */
+static xcdn_node_t *share_node(share_table_t *t, xcdn_node_t *node) {
+    if (!node) return NULL;
+    xcdn_value_t *v = node->value;
+    if (v && v->type == XCDN_VAL_ARRAY) {
+        for (size_t i = 0; i < v->data.array.len; i++)
+            v->data.array.items[i] = share_node(t, v->data.array.items[i]);
+    } else if (v && v->type == XCDN_VAL_OBJECT) {
+        for (size_t i = 0; i < v->data.object.len; i++) {
+            xcdn_node_t **slot = xcdn_object_slot(v, i);
+            *slot = share_node(t, *slot);
+        }
+    }
+
+    if ((t->len + 1) * 2 > t->cap && !share_grow(t)) return node;
+    uint64_t h = node_hash(node);
+    size_t slot = (size_t)h & (t->cap - 1);
+    for (; t->nodes[slot]; slot = (slot + 1) & (t->cap - 1)) {
+        xcdn_node_t *canon = t->nodes[slot];
+        if (t->hashes[slot] != h || !node_identical(canon, node, false)) continue;
+        canon->refs++;
+        freeze_node(canon);
+        xcdn_span_table_remove(t->spans, node);
+        xcdn_node_free(node);
+        t->replaced++;
+        return canon;
+    }
+    t->hashes[slot] = h;
+    t->nodes[slot] = node;
+    t->len++;
+    return node;
+}
+
+size_t xcdn_document_share_subtrees(xcdn_document_t *doc) {
+    if (!doc || doc->frozen) return 0;
+    share_table_t t;
+    memset(&t, 0, sizeof(t));
+    t.spans = doc->spans;
+    for (size_t i = 0; i < doc->values_len; i++)
+        doc->values[i] = share_node(&t, doc->values[i]);
+    free(t.hashes);
+    free(t.nodes);
+    return t.replaced;
+}
+
+/* ── Compaction ───────────────────────────────────────────────────────── */
+
+/* Old → new addresses of storage reachable more than once. */
+typedef struct {
+    const void **keys;   /* NULL = empty slot */
+    void       **vals;
+    size_t       len;
+    size_t       cap;
+} ptr_map_t;
+
+/*
+ * Copy state. The tree is copied twice: once with `base` NULL to measure
+ * the block, then into it. Every piece is laid out in the same order both
+ * times, so the second pass fills the block exactly.
+ */
+typedef struct {
+    char              *base;
+    size_t             used;
+    ptr_map_t          seen;
+    xcdn_span_table_t *old_spans;
+    xcdn_span_table_t *spans;
+    bool               failed;
+} compact_t;
+
+static size_t ptr_slot(const ptr_map_t *m, const void *key) {
+    uint64_t h = (uint64_t)(uintptr_t)key * 0x9E3779B97F4A7C15ull;
+    size_t slot = (size_t)(h >> 32) & (m->cap - 1);
+    while (m->keys[slot] && m->keys[slot] != key) slot = (slot + 1) & (m->cap - 1);
+    return slot;
+}
+
+static void *ptr_map_get(const ptr_map_t *m, const void *key) {
+    if (m->len == 0) return NULL;
+    size_t slot = ptr_slot(m, key);
+    return m->keys[slot] ? m->vals[slot] : NULL;
+}
+
+static bool ptr_map_put(ptr_map_t *m, const void *key, void *val) {
+    if ((m->len + 1) * 2 > m->cap) {
+        ptr_map_t g = { NULL, NULL, 0, m->cap ? m->cap * 2 : 64 };
+        g.keys = (const void **)calloc(g.cap, sizeof(void *));
+        g.vals = (void **)malloc(g.cap * sizeof(void *));
+        if (!g.keys || !g.vals) {
+            free(g.keys);
+            free(g.vals);
+            return false;
+        }
+        for (size_t i = 0; i < m->cap; i++) {
+            if (!m->keys[i]) continue;
+            size_t slot = ptr_slot(&g, m->keys[i]);
+            g.keys[slot] = m->keys[i];
+            g.vals[slot] = m->vals[i];
+        }
+        g.len = m->len;
+        free(m->keys);
+        free(m->vals);
+        *m = g;
+    }
+    size_t slot = ptr_slot(m, key);
+    if (!m->keys[slot]) m->len++;
+    m->keys[slot] = key;
+    m->vals[slot] = val;
+    return true;
+}
+
+static void ptr_map_clear(ptr_map_t *m) {
+    free(m->keys);
+    free(m->vals);
+    memset(m, 0, sizeof(*m));
+}
+
+/* Reserve `size` bytes of the block; NULL while measuring. */
+static void *take(compact_t *c, size_t size, size_t align) {
+    size_t at = (c->used + align - 1) & ~(align - 1);
+    c->used = at + size;
+    return c->base ? c->base + at : NULL;
+}
+
+#define TAKE(c, type, n) ((type *)take((c), sizeof(type) * (n), _Alignof(type)))
+
+static char *copy_text(compact_t *c, const char *s, size_t len) {
+    char *out = (char *)take(c, len + 1, 1);
+    if (out) {
+        if (len > 0) memcpy(out, s, len);
+        out[len] = '\0';
+    }
+    return out;
+}
+
+/* Copy a key into an entry already copied into `out` (which may be NULL). */
+static void copy_entry_key(compact_t *c, xcdn_object_entry_t *out,
+                           const xcdn_object_entry_t *e) {
+    if (XCDN_KEY_INLINE(e->key_len)) return;
+    char *key = copy_text(c, e->key_heap, e->key_len);
+    if (out) out->key_heap = key;
+}
+
+static xcdn_shape_t *copy_shape(compact_t *c, const xcdn_shape_t *shape) {
+    /* While measuring, the map records the shape itself */
+    xcdn_shape_t *out = (xcdn_shape_t *)ptr_map_get(&c->seen, shape);
+    if (out) return c->base ? out : NULL;
+    size_t size = sizeof(xcdn_shape_t) + shape->len * sizeof(xcdn_object_entry_t);
+    out = (xcdn_shape_t *)take(c, size, _Alignof(xcdn_shape_t));
+    if (out) memcpy(out, shape, size);
+    for (size_t i = 0; i < shape->len; i++)
+        copy_entry_key(c, out ? &out->keys[i] : NULL, &shape->keys[i]);
+    if (shape->index) {
+        uint32_t *index = TAKE(c, uint32_t, shape->index_cap);
+        if (index) {
+            memcpy(index, shape->index, shape->index_cap * sizeof(uint32_t));
+            out->index = index;
+        }
+    }
+    if (!ptr_map_put(&c->seen, shape, out ? (void *)out : (void *)shape))
+        c->failed = true;
+    return out;
+}
+
+static xcdn_node_t *copy_node(compact_t *c, const xcdn_node_t *node);
+
+static xcdn_value_t *copy_value(compact_t *c, const xcdn_value_t *val) {
+    if (!val) return NULL;
+    xcdn_value_t *out = TAKE(c, xcdn_value_t, 1);
+    if (out) {
+        *out = *val;
+        out->flags = (val->flags & ~XCDN_FLAG_POOLED) | XCDN_FLAG_FROZEN |
+                     XCDN_FLAG_COMPACT;
+    }
+    switch (val->type) {
+        case XCDN_VAL_STRING:
+        case XCDN_VAL_DECIMAL:
+        case XCDN_VAL_DATETIME:
+        case XCDN_VAL_DURATION:
+        case XCDN_VAL_UUID: {
+            if (!val->data.string) break;
+            if (val->data.string == val->data.string_sso) {
+                if (out) out->data.string = out->data.string_sso;
+                break;
+            }
+            size_t len = (val->flags & XCDN_FLAG_SCANNED) ? val->data.string_len
+                                                          : strlen(val->data.string);
+            /* Pooled strings stay deduplicated inside the block */
+            bool pooled = (val->flags & XCDN_FLAG_POOLED) != 0;
+            char *text = pooled ? (char *)ptr_map_get(&c->seen, val->data.string) : NULL;
+            if (!text) {
+                text = copy_text(c, val->data.string, len);
+                if (pooled && !ptr_map_put(&c->seen, val->data.string,
+                                           text ? text : val->data.string))
+                    c->failed = true;
+            }
+            if (out) out->data.string = text;
+            break;
+        }
+        case XCDN_VAL_INT:
+        case XCDN_VAL_FLOAT:
+            if ((val->flags & XCDN_FLAG_RAW_NUMBER) &&
+                val->data.number_len >= XCDN_SSO_CAP) {
+                char *text = copy_text(c, val->data.number_heap, val->data.number_len);
+                if (out) out->data.number_heap = text;
+            }
+            break;
+        case XCDN_VAL_BYTES:
+            if (val->data.bytes.encoded) {
+                /* Lazy values stay lazy; the decoded cache is dropped */
+                char *text = copy_text(c, val->data.bytes.encoded,
+                                       val->data.bytes.encoded_len);
+                if (out) {
+                    out->data.bytes.encoded = text;
+                    out->data.bytes.data = NULL;
+                }
+            } else if (val->data.bytes.data) {
+                uint8_t *data = (uint8_t *)take(c, val->data.bytes.len, 1);
+                if (data) {
+                    memcpy(data, val->data.bytes.data, val->data.bytes.len);
+                    out->data.bytes.data = data;
+                }
+            }
+            break;
+        case XCDN_VAL_ARRAY: {
+            size_t len = val->data.array.len;
+            xcdn_node_t **items = len ? TAKE(c, xcdn_node_t *, len) : NULL;
+            if (out) {
+                out->data.array.items = items;
+                out->data.array.cap = len;
+            }
+            for (size_t i = 0; i < len; i++) {
+                xcdn_node_t *child = copy_node(c, val->data.array.items[i]);
+                if (items) items[i] = child;
+            }
+            break;
+        }
+        case XCDN_VAL_OBJECT: {
+            size_t len = val->data.object.len;
+            if (val->data.object.shape) {
+                xcdn_node_t **slots = len ? TAKE(c, xcdn_node_t *, len) : NULL;
+                xcdn_shape_t *shape = copy_shape(c, val->data.object.shape);
+                if (out) {
+                    out->data.object.slots = slots;
+                    out->data.object.shape = shape;
+                    out->data.object.cap = len;
+                }
+                for (size_t i = 0; i < len; i++) {
+                    xcdn_node_t *child = copy_node(c, val->data.object.slots[i]);
+                    if (slots) slots[i] = child;
+                }
+                break;
+            }
+            xcdn_object_entry_t *entries = len ? TAKE(c, xcdn_object_entry_t, len) : NULL;
+            if (entries) memcpy(entries, val->data.object.entries, len * sizeof(*entries));
+            if (out) {
+                out->data.object.entries = entries;
+                out->data.object.cap = len;
+            }
+            for (size_t i = 0; i < len; i++)
+                copy_entry_key(c, entries ? &entries[i] : NULL, &val->data.object.entries[i]);
+            for (size_t i = 0; i < len; i++) {
+                xcdn_node_t *child = copy_node(c, val->data.object.entries[i].node);
+                if (entries) entries[i].node = child;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    return out;
+}
+
+static xcdn_node_t *copy_node(compact_t *c, const xcdn_node_t *node) {
+    if (!node) return NULL;
+    /* A shared node is copied once and stays shared */
+    if (node->refs > 0) {
+        void *done = ptr_map_get(&c->seen, node);
+        if (done) return c->base ? (xcdn_node_t *)done : NULL;
+    }
+    xcdn_node_t *out = TAKE(c, xcdn_node_t, 1);
+    if (out) {
+        *out = *node;
+        out->flags |= XCDN_FLAG_FROZEN | XCDN_FLAG_COMPACT;
+        out->tags_cap = node->tags_len;
+        out->annotations_cap = node->annotations_len;
+    }
+    if (node->refs > 0 &&
+        !ptr_map_put(&c->seen, node, out ? (void *)out : (void *)node))
+        c->failed = true;
+
+    xcdn_tag_t *tags = node->tags_len ? TAKE(c, xcdn_tag_t, node->tags_len) : NULL;
+    for (size_t i = 0; i < node->tags_len; i++) {
+        const char *name = node->tags[i].name;
+        char *copy = copy_text(c, name, strlen(name));
+        if (tags) tags[i].name = copy;
+    }
+    if (out) out->tags = tags;
+
+    size_t n = node->annotations_len;
+    xcdn_annotation_t *anns = n ? TAKE(c, xcdn_annotation_t, n) : NULL;
+    for (size_t i = 0; i < n; i++) {
+        const xcdn_annotation_t *a = &node->annotations[i];
+        char *name = copy_text(c, a->name, strlen(a->name));
+        xcdn_value_t **args = a->args_len ? TAKE(c, xcdn_value_t *, a->args_len) : NULL;
+        if (anns) {
+            anns[i].name = name;
+            anns[i].args = args;
+            anns[i].args_len = a->args_len;
+            anns[i].args_cap = a->args_len;
+            anns[i].flags = a->flags | XCDN_FLAG_FROZEN | XCDN_FLAG_COMPACT;
+        }
+        for (size_t j = 0; j < a->args_len; j++) {
+            xcdn_value_t *arg = copy_value(c, a->args[j]);
+            if (args) args[j] = arg;
+        }
+    }
+    if (out) out->annotations = anns;
+
+    xcdn_value_t *value = copy_value(c, node->value);
+    if (out) {
+        out->value = value;
+        size_t start, end;
+        if (c->spans && xcdn_span_table_get(c->old_spans, node, &start, &end) &&
+            !xcdn_span_table_set(c->spans, out, start, end))
+            c->failed = true;
+    }
+    return out;
+}
+
+/* Copy a document's contents, measuring only if c->base is NULL. */
+static void copy_document(compact_t *c, const xcdn_document_t *doc,
+                          xcdn_document_t *out) {
+    /* The block starts with its memory statistics */
+    TAKE(c, xcdn_memory_stats_t, 1);
+    xcdn_directive_t *prolog = doc->prolog_len
+        ? TAKE(c, xcdn_directive_t, doc->prolog_len) : NULL;
+    for (size_t i = 0; i < doc->prolog_len; i++) {
+        const xcdn_directive_t *d = &doc->prolog[i];
+        char *name = d->name ? copy_text(c, d->name, strlen(d->name)) : NULL;
+        xcdn_value_t *value = copy_value(c, d->value);
+        if (prolog) {
+            prolog[i].name = name;
+            prolog[i].value = value;
+        }
+    }
+    xcdn_node_t **values = doc->values_len
+        ? TAKE(c, xcdn_node_t *, doc->values_len) : NULL;
+    for (size_t i = 0; i < doc->values_len; i++) {
+        xcdn_node_t *node = copy_node(c, doc->values[i]);
+        if (values) values[i] = node;
+    }
+    if (!c->base) return;
+    out->prolog = prolog;
+    out->prolog_len = out->prolog_cap = doc->prolog_len;
+    out->values = values;
+    out->values_len = out->values_cap = doc->values_len;
+}
+
+static void document_free_contents(xcdn_document_t *doc);
+static bool usage_document(const xcdn_document_t *doc, xcdn_memory_stats_t *st);
+static size_t span_table_size(const xcdn_span_table_t *t);
+
+bool xcdn_document_compact(xcdn_document_t *doc) {
+    if (!doc) return false;
+    xcdn_document_freeze(doc);
+
+    compact_t c;
+    memset(&c, 0, sizeof(c));
+    copy_document(&c, doc, NULL);
+    size_t size = c.used;
+    bool ok = !c.failed;
+    ptr_map_clear(&c.seen);
+    if (!ok) return false;
+
+    memset(&c, 0, sizeof(c));
+    c.base = (char *)malloc(size ? size : 1);
+    if (!c.base) return false;
+    if (doc->spans) {
+        c.old_spans = doc->spans;
+        c.spans = xcdn_span_table_new();
+        if (!c.spans) {
+            free(c.base);
+            return false;
+        }
+    }
+    xcdn_document_t next = *doc;
+    copy_document(&c, doc, &next);
+    ptr_map_clear(&c.seen);
+    if (c.failed) {
+        xcdn_span_table_free(c.spans);
+        free(c.base);
+        return false;
+    }
+
+    if (c.spans) {
+        /* The line index describes the source text, not the nodes */
+        c.spans->lines = doc->spans->lines;
+        c.spans->lines_len = doc->spans->lines_len;
+        doc->spans->lines = NULL;
+        doc->spans->lines_len = 0;
+        next.spans = c.spans;
+    }
+    next.block = c.base;
+    document_free_contents(doc);
+    *doc = next;
+
+    /* Containers have no spare capacity left; what the block holds beyond
+     * the data is its header and alignment padding. */
+    xcdn_memory_stats_t *st = (xcdn_memory_stats_t *)c.base;
+    usage_document(doc, st);
+    st->total.reserved = size + sizeof(*doc) + span_table_size(doc->spans);
+    st->slack = st->total.reserved - st->total.used;
+    return true;
+}
+
+/* ── Memory usage ─────────────────────────────────────────────────────── */
+
+typedef struct {
+    xcdn_memory_stats_t *st;
+    ptr_map_t            seen;
+    bool                 failed;
+} usage_t;
+
+static void use(xcdn_memory_use_t *u, size_t used, size_t reserved) {
+    u->used += used;
+    u->reserved += reserved;
+}
+
+/* True the first time `p` is seen. */
+static bool first_visit(usage_t *u, const void *p) {
+    if (ptr_map_get(&u->seen, p)) return false;
+    if (!ptr_map_put(&u->seen, p, (void *)p)) u->failed = true;
+    return true;
+}
+
+static void usage_key(usage_t *u, const xcdn_object_entry_t *e) {
+    if (!XCDN_KEY_INLINE(e->key_len)) use(&u->st->keys, e->key_len + 1, e->key_len + 1);
+}
+
+static void usage_node(usage_t *u, const xcdn_node_t *node);
+
+static void usage_value(usage_t *u, const xcdn_value_t *val) {
+    if (!val) return;
+    xcdn_memory_stats_t *st = u->st;
+    use(&st->values, sizeof(xcdn_value_t), sizeof(xcdn_value_t));
+    if ((size_t)val->type <= XCDN_VAL_OBJECT) st->counts[val->type]++;
+    switch (val->type) {
+        case XCDN_VAL_STRING:
+        case XCDN_VAL_DECIMAL:
+        case XCDN_VAL_DATETIME:
+        case XCDN_VAL_DURATION:
+        case XCDN_VAL_UUID: {
+            const char *s = val->data.string;
+            if (!s || s == val->data.string_sso) break;
+            size_t len = (val->flags & XCDN_FLAG_SCANNED) ? val->data.string_len
+                                                          : strlen(s);
+            if (!(val->flags & XCDN_FLAG_POOLED))
+                use(&st->strings, len + 1, len + 1);
+            else if (first_visit(u, s))
+                use(&st->strings, len + 1, xcdn_strpool_footprint(s));
+            break;
+        }
+        case XCDN_VAL_INT:
+        case XCDN_VAL_FLOAT:
+            if ((val->flags & XCDN_FLAG_RAW_NUMBER) &&
+                val->data.number_len >= XCDN_SSO_CAP)
+                use(&st->strings, val->data.number_len + 1, val->data.number_len + 1);
+            break;
+        case XCDN_VAL_BYTES:
+            if (val->data.bytes.data)
+                use(&st->bytes, val->data.bytes.len, val->data.bytes.len);
+            if (val->data.bytes.encoded)
+                use(&st->bytes, val->data.bytes.encoded_len + 1,
+                    val->data.bytes.encoded_len + 1);
+            break;
+        case XCDN_VAL_ARRAY:
+            use(&st->containers, val->data.array.len * sizeof(xcdn_node_t *),
+                val->data.array.cap * sizeof(xcdn_node_t *));
+            for (size_t i = 0; i < val->data.array.len; i++)
+                usage_node(u, val->data.array.items[i]);
+            break;
+        case XCDN_VAL_OBJECT: {
+            const xcdn_shape_t *shape = val->data.object.shape;
+            size_t elem = shape ? sizeof(xcdn_node_t *) : sizeof(xcdn_object_entry_t);
+            use(&st->containers, val->data.object.len * elem,
+                val->data.object.cap * elem);
+            if (shape && first_visit(u, shape)) {
+                size_t size = sizeof(xcdn_shape_t) +
+                              shape->len * sizeof(xcdn_object_entry_t) +
+                              shape->index_cap * sizeof(uint32_t);
+                use(&st->keys, size, size);
+                for (size_t i = 0; i < shape->len; i++) usage_key(u, &shape->keys[i]);
+            }
+            for (size_t i = 0; i < val->data.object.len; i++) {
+                if (!shape) usage_key(u, &val->data.object.entries[i]);
+                usage_node(u, *xcdn_object_slot(val, i));
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static void usage_node(usage_t *u, const xcdn_node_t *node) {
+    if (!node) return;
+    if (node->refs > 0 && !first_visit(u, node)) return;
+    xcdn_memory_stats_t *st = u->st;
+    use(&st->nodes, sizeof(xcdn_node_t), sizeof(xcdn_node_t));
+    use(&st->tags, node->tags_len * sizeof(xcdn_tag_t),
+        node->tags_cap * sizeof(xcdn_tag_t));
+    for (size_t i = 0; i < node->tags_len; i++) {
+        size_t n = strlen(node->tags[i].name) + 1;
+        use(&st->tags, n, n);
+    }
+    use(&st->annotations, node->annotations_len * sizeof(xcdn_annotation_t),
+        node->annotations_cap * sizeof(xcdn_annotation_t));
+    for (size_t i = 0; i < node->annotations_len; i++) {
+        const xcdn_annotation_t *a = &node->annotations[i];
+        size_t n = strlen(a->name) + 1;
+        use(&st->annotations, n + a->args_len * sizeof(xcdn_value_t *),
+            n + a->args_cap * sizeof(xcdn_value_t *));
+        for (size_t j = 0; j < a->args_len; j++) usage_value(u, a->args[j]);
+    }
+    usage_value(u, node->value);
+}
+
+static size_t span_table_size(const xcdn_span_table_t *t) {
+    if (!t) return 0;
+    return sizeof(*t) +
+           t->cap * (sizeof(*t->nodes) + sizeof(*t->start) + sizeof(*t->end)) +
+           t->index_cap * sizeof(*t->index) + t->lines_len * sizeof(*t->lines);
+}
+
+/* Measure by traversal, whether or not the document is compacted. */
+static bool usage_document(const xcdn_document_t *doc, xcdn_memory_stats_t *st) {
+    usage_t u;
+    memset(&u, 0, sizeof(u));
+    memset(st, 0, sizeof(*st));
+    u.st = st;
+
+    size_t spans = span_table_size(doc->spans);
+    use(&st->other, sizeof(*doc) + spans, sizeof(*doc) + spans);
+    use(&st->other, doc->prolog_len * sizeof(xcdn_directive_t),
+        doc->prolog_cap * sizeof(xcdn_directive_t));
+    for (size_t i = 0; i < doc->prolog_len; i++) {
+        size_t n = doc->prolog[i].name ? strlen(doc->prolog[i].name) + 1 : 0;
+        use(&st->other, n, n);
+        usage_value(&u, doc->prolog[i].value);
+    }
+    use(&st->containers, doc->values_len * sizeof(xcdn_node_t *),
+        doc->values_cap * sizeof(xcdn_node_t *));
+    for (size_t i = 0; i < doc->values_len; i++)
+        usage_node(&u, doc->values[i]);
+    ptr_map_clear(&u.seen);
+
+    const xcdn_memory_use_t *parts[] = {
+        &st->values, &st->nodes, &st->strings, &st->keys, &st->bytes,
+        &st->tags, &st->annotations, &st->containers, &st->other,
+    };
+    for (size_t i = 0; i < sizeof(parts) / sizeof(parts[0]); i++)
+        use(&st->total, parts[i]->used, parts[i]->reserved);
+    st->slack = st->total.reserved - st->total.used;
+    return !u.failed;
+}
+
+bool xcdn_document_memory_usage(const xcdn_document_t *doc,
+                                xcdn_memory_stats_t *stats) {
+    if (!doc || !stats) return false;
+    if (doc->block) {
+        /* Recorded at the head of the block by xcdn_document_compact() */
+        *stats = *(const xcdn_memory_stats_t *)doc->block;
+        return true;
+    }
+    return usage_document(doc, stats);
 }
 
 /* ── Value accessors ──────────────────────────────────────────────────── */
@@ -301,13 +1493,57 @@ const char *xcdn_value_as_string(const xcdn_value_t *val) {
     }
 }
 
+bool xcdn_value_is_ascii(const xcdn_value_t *val) {
+    const char *s = xcdn_value_as_string(val);
+    if (!s) return false;
+    if (val->flags & XCDN_FLAG_SCANNED) return (val->flags & XCDN_FLAG_ASCII) != 0;
+    return (val->flags & XCDN_FLAG_ASCII) || xcdn_utf8_is_ascii(s, strlen(s));
+}
+
+bool xcdn_value_string_equal(const xcdn_value_t *a, const xcdn_value_t *b) {
+    const char *sa = xcdn_value_as_string(a), *sb = xcdn_value_as_string(b);
+    if (!sa || !sb || a->type != b->type) return false;
+    if (sa == sb) return true;
+    if ((a->flags & b->flags & XCDN_FLAG_POOLED) && xcdn_strpool_same_pool(sa, sb))
+        return false;
+    if (a->flags & b->flags & XCDN_FLAG_SCANNED)
+        return a->data.string_len == b->data.string_len &&
+               memcmp(sa, sb, a->data.string_len) == 0;
+    return strcmp(sa, sb) == 0;
+}
+
+const char *xcdn_value_number_text(const xcdn_value_t *val, size_t *len) {
+    if (!val || !(val->flags & XCDN_FLAG_RAW_NUMBER)) {
+        if (len) *len = 0;
+        return NULL;
+    }
+    if (len) *len = val->data.number_len;
+    return val->data.number_len < XCDN_SSO_CAP ? val->data.number_sso
+                                               : val->data.number_heap;
+}
+
+/* Convert a number held as text, once. */
+static void number_convert(xcdn_value_t *val) {
+    if (!(val->flags & XCDN_FLAG_PENDING)) return;
+    const char *text = xcdn_value_number_text(val, NULL);
+    if (val->type == XCDN_VAL_INT)
+        val->data.integer = (int64_t)strtoll(text, NULL, 10);
+    else
+        val->data.floating = strtod(text, NULL);
+    val->flags &= ~(uint32_t)XCDN_FLAG_PENDING;
+}
+
 int64_t xcdn_value_as_int(const xcdn_value_t *val) {
     if (!val || val->type != XCDN_VAL_INT) return 0;
+    /* The converted number is a cache, so it may be filled in through a
+     * const value; frozen documents were converted by the freeze. */
+    number_convert((xcdn_value_t *)val);
     return val->data.integer;
 }
 
 double xcdn_value_as_float(const xcdn_value_t *val) {
     if (!val || val->type != XCDN_VAL_FLOAT) return 0.0;
+    number_convert((xcdn_value_t *)val);
     return val->data.floating;
 }
 
@@ -322,7 +1558,30 @@ const uint8_t *xcdn_value_as_bytes(const xcdn_value_t *val, size_t *out_len) {
         return NULL;
     }
     if (out_len) *out_len = val->data.bytes.len;
-    return val->data.bytes.data;
+    if (!val->data.bytes.encoded) return val->data.bytes.data;
+
+    /* Lazy value: the decoded buffer is a cache, so it may be filled in
+     * through a const value. */
+    xcdn_value_t *v = (xcdn_value_t *)val;
+    size_t len = 0;
+#ifndef __STDC_NO_ATOMICS__
+    /* Readers may race on a shared document; the first decode wins */
+    _Atomic(uint8_t *) *slot = (_Atomic(uint8_t *) *)&v->data.bytes.data;
+    uint8_t *data = atomic_load(slot);
+    if (data) return data;
+    data = xcdn_base64_decode(v->data.bytes.encoded, v->data.bytes.encoded_len, &len);
+    uint8_t *expected = NULL;
+    if (data && !atomic_compare_exchange_strong(slot, &expected, data)) {
+        free(data);
+        return expected;
+    }
+    return data;
+#else
+    if (!v->data.bytes.data)
+        v->data.bytes.data = xcdn_base64_decode(v->data.bytes.encoded,
+                                                v->data.bytes.encoded_len, &len);
+    return v->data.bytes.data;
+#endif
 }
 
 /* ── Deep path access ─────────────────────────────────────────────────── */
@@ -402,18 +1661,54 @@ size_t xcdn_annotation_arg_count(const xcdn_annotation_t *ann) {
 
 /* ── Destructors ──────────────────────────────────────────────────────── */
 
+/*
+ * Values and nodes in a compacted document's block own no storage of
+ * their own, except bytes decoded after compaction.
+ */
+static void compact_value_free(xcdn_value_t *val) {
+    switch (val->type) {
+        case XCDN_VAL_BYTES:
+            if (val->data.bytes.encoded) free(val->data.bytes.data);
+            break;
+        case XCDN_VAL_ARRAY:
+            for (size_t i = 0; i < val->data.array.len; i++)
+                xcdn_node_free(val->data.array.items[i]);
+            break;
+        case XCDN_VAL_OBJECT:
+            for (size_t i = 0; i < val->data.object.len; i++)
+                xcdn_node_free(*xcdn_object_slot(val, i));
+            break;
+        default:
+            break;
+    }
+}
+
 void xcdn_value_free(xcdn_value_t *val) {
     if (!val) return;
+    if (val->flags & XCDN_FLAG_COMPACT) {
+        compact_value_free(val);
+        return;
+    }
     switch (val->type) {
         case XCDN_VAL_STRING:
         case XCDN_VAL_DECIMAL:
         case XCDN_VAL_DATETIME:
         case XCDN_VAL_DURATION:
         case XCDN_VAL_UUID:
-            free(val->data.string);
+            if (val->flags & XCDN_FLAG_POOLED)
+                xcdn_strpool_release(val->data.string);
+            else if (val->data.string != val->data.string_sso)
+                free(val->data.string);
+            break;
+        case XCDN_VAL_INT:
+        case XCDN_VAL_FLOAT:
+            if ((val->flags & XCDN_FLAG_RAW_NUMBER) &&
+                val->data.number_len >= XCDN_SSO_CAP)
+                free(val->data.number_heap);
             break;
         case XCDN_VAL_BYTES:
             free(val->data.bytes.data);
+            free(val->data.bytes.encoded);
             break;
         case XCDN_VAL_ARRAY:
             for (size_t i = 0; i < val->data.array.len; i++)
@@ -421,8 +1716,16 @@ void xcdn_value_free(xcdn_value_t *val) {
             free(val->data.array.items);
             break;
         case XCDN_VAL_OBJECT:
+            if (val->data.object.shape) {
+                for (size_t i = 0; i < val->data.object.len; i++)
+                    xcdn_node_free(val->data.object.slots[i]);
+                free(val->data.object.slots);
+                xcdn_shape_release(val->data.object.shape);
+                break;
+            }
             for (size_t i = 0; i < val->data.object.len; i++) {
-                free(val->data.object.entries[i].key);
+                if (!XCDN_KEY_INLINE(val->data.object.entries[i].key_len))
+                    free(val->data.object.entries[i].key_heap);
                 xcdn_node_free(val->data.object.entries[i].node);
             }
             free(val->data.object.entries);
@@ -442,6 +1745,18 @@ static void free_annotation(xcdn_annotation_t *ann) {
 
 void xcdn_node_free(xcdn_node_t *node) {
     if (!node) return;
+    if (node->refs > 0) {
+        node->refs--;
+        return;
+    }
+    if (node->flags & XCDN_FLAG_COMPACT) {
+        for (size_t i = 0; i < node->annotations_len; i++) {
+            for (size_t j = 0; j < node->annotations[i].args_len; j++)
+                xcdn_value_free(node->annotations[i].args[j]);
+        }
+        xcdn_value_free(node->value);
+        return;
+    }
     for (size_t i = 0; i < node->tags_len; i++)
         free(node->tags[i].name);
     free(node->tags);
@@ -452,16 +1767,25 @@ void xcdn_node_free(xcdn_node_t *node) {
     free(node);
 }
 
-void xcdn_document_free(xcdn_document_t *doc) {
-    if (!doc) return;
+/* Free everything a document holds but the document itself. */
+static void document_free_contents(xcdn_document_t *doc) {
     for (size_t i = 0; i < doc->prolog_len; i++) {
-        free(doc->prolog[i].name);
+        if (!doc->block) free(doc->prolog[i].name);
         xcdn_value_free(doc->prolog[i].value);
     }
-    free(doc->prolog);
     for (size_t i = 0; i < doc->values_len; i++)
         xcdn_node_free(doc->values[i]);
-    free(doc->values);
+    if (!doc->block) {
+        free(doc->prolog);
+        free(doc->values);
+    }
+    xcdn_span_table_free(doc->spans);
+    free(doc->block);
+}
+
+void xcdn_document_free(xcdn_document_t *doc) {
+    if (!doc) return;
+    document_free_contents(doc);
     free(doc);
 }
 
@@ -23,6 +23,8 @@ typedef struct xcdn_tag       xcdn_tag_t;
 typedef struct xcdn_annotation xcdn_annotation_t;
 typedef struct xcdn_directive xcdn_directive_t;
 typedef struct xcdn_document  xcdn_document_t;
+struct xcdn_span_table;
+struct xcdn_shape_table;
 
 /* ── Value types ──────────────────────────────────────────────────────── */
 
@@ -41,25 +43,115 @@ typedef enum {
     XCDN_VAL_OBJECT,
 } xcdn_value_type_t;
 
+/* ── Value/node flags ─────────────────────────────────────────────────── */
+
+enum {
+    XCDN_FLAG_FROZEN = 1u << 0,   /* immutable; mutators are no-ops */
+    XCDN_FLAG_ASCII  = 1u << 1,   /* string payload known to be pure ASCII */
+    /*
+     * String metadata of string values and object keys, exact only
+     * together with XCDN_FLAG_SCANNED. Code that rewrites a string in
+     * place must clear XCDN_FLAG_SCANNED.
+     */
+    XCDN_FLAG_PLAIN   = 1u << 2,  /* can be quoted as-is, no escaping needed */
+    XCDN_FLAG_IDENT   = 1u << 3,  /* simple identifier, usable as a bare key */
+    XCDN_FLAG_SCANNED = 1u << 4,  /* flags above and the length are exact */
+    /* Numbers that keep their source text (see xcdn_value_number_text). */
+    XCDN_FLAG_RAW_NUMBER = 1u << 5,  /* serialized as the original lexeme */
+    XCDN_FLAG_PENDING    = 1u << 6,  /* integer/floating not converted yet */
+    XCDN_FLAG_POOLED     = 1u << 7,  /* string shared through an xcdn_strpool */
+    XCDN_FLAG_COMPACT    = 1u << 8,  /* stored in a compacted document's block */
+};
+
+/*
+ * Strings shorter than XCDN_SSO_CAP bytes (NUL included) are stored inline
+ * in their value or object entry instead of in a separate allocation.
+ */
+#define XCDN_SSO_CAP 16
+
 /* ── Object entry (key-value pair in ordered map) ─────────────────────── */
 
+/*
+ * Short keys are stored inline as well. This changed the entry layout:
+ * there is no `key` field (read keys with xcdn_entry_key()), and an inline
+ * key moves whenever the entry array does. Building with XCDN_HEAP_KEYS
+ * defined (CMake option of the same name) keeps every key on the heap,
+ * which restores `entry.key` and key pointers that stay valid until their
+ * entry is removed.
+ */
+#ifdef XCDN_HEAP_KEYS
+#define XCDN_KEY_INLINE(len) ((void)(len), 0)
+#else
+#define XCDN_KEY_INLINE(len) ((len) < XCDN_SSO_CAP)
+#endif
+
 typedef struct xcdn_object_entry {
-    char        *key;
+#ifdef XCDN_HEAP_KEYS
+    union {
+        char    *key;                       /* every key, on the heap */
+        char    *key_heap;
+        char     key_sso[sizeof(char *)];   /* unused */
+    };
+#else
+    union {
+        char    *key_heap;               /* key_len >= XCDN_SSO_CAP */
+        char     key_sso[XCDN_SSO_CAP];  /* key_len <  XCDN_SSO_CAP */
+    };
+#endif
     xcdn_node_t *node;
+    size_t       key_len;
+    uint32_t     key_flags;   /* XCDN_FLAG_* string metadata of the key */
 } xcdn_object_entry_t;
 
+/* The NUL-terminated key of an entry, wherever it is stored. */
+static inline const char *xcdn_entry_key(const xcdn_object_entry_t *e) {
+    return XCDN_KEY_INLINE(e->key_len) ? e->key_sso : e->key_heap;
+}
+
+/* ── Shape: key sequence shared by objects with the same keys ─────────── */
+
+/*
+ * Shaped objects (see xcdn_object_intern_shape) keep their keys here, once
+ * for all objects with the same keys in the same order, and store only
+ * their nodes. Shapes are immutable and reference counted.
+ */
+typedef struct xcdn_shape {
+    size_t               refs;
+    size_t               len;
+    uint64_t             hash;       /* of the key sequence */
+    uint32_t            *index;      /* slot + 1 per bucket; NULL for short shapes */
+    size_t               index_cap;
+    xcdn_object_entry_t  keys[];     /* `node` is unused */
+} xcdn_shape_t;
+
 /* ── The core value union ─────────────────────────────────────────────── */
 
 struct xcdn_value {
     xcdn_value_type_t type;
+    uint32_t          flags;   /* XCDN_FLAG_* bits */
     union {
         bool            boolean;
-        int64_t         integer;
-        double          floating;
-        char           *string;      /* for STRING, DECIMAL, DATETIME, DURATION, UUID */
         struct {
-            uint8_t    *data;
+            union {
+                int64_t integer;
+                double  floating;
+            };
+            size_t      number_len;  /* lexeme length if XCDN_FLAG_RAW_NUMBER */
+            union {
+                char   *number_heap;               /* number_len >= XCDN_SSO_CAP */
+                char    number_sso[XCDN_SSO_CAP];  /* number_len <  XCDN_SSO_CAP */
+            };
+        };
+        struct {
+            char       *string;      /* for STRING, DECIMAL, DATETIME, DURATION, UUID */
+            size_t      string_len;  /* exact when flags has XCDN_FLAG_SCANNED */
+            char        string_sso[XCDN_SSO_CAP];  /* `string` points here if short */
+        };
+        struct {
+            uint8_t    *data;         /* NULL until a lazy value is decoded */
             size_t      len;
+            char       *encoded;      /* original base64 text of a lazy value */
+            size_t      encoded_len;
         } bytes;
         struct {
             xcdn_node_t **items;
@@ -67,13 +159,30 @@ struct xcdn_value {
             size_t        cap;
         } array;
         struct {
-            xcdn_object_entry_t *entries;
+            union {
+                xcdn_object_entry_t *entries;  /* when shape is NULL */
+                xcdn_node_t        **slots;    /* one node per shape key */
+            };
             size_t               len;
             size_t               cap;
+            xcdn_shape_t        *shape;
         } object;
     } data;
 };
 
+/* Key entry i of an object; shaped objects keep their keys in the shape. */
+static inline const xcdn_object_entry_t *xcdn_object_key_entry(const xcdn_value_t *obj,
+                                                               size_t i) {
+    return obj->data.object.shape ? &obj->data.object.shape->keys[i]
+                                  : &obj->data.object.entries[i];
+}
+
+/* Where the node of entry i of an object is stored. */
+static inline xcdn_node_t **xcdn_object_slot(const xcdn_value_t *obj, size_t i) {
+    return obj->data.object.shape ? &obj->data.object.slots[i]
+                                  : &obj->data.object.entries[i].node;
+}
+
 /* ── Tag ──────────────────────────────────────────────────────────────── */
 
 struct xcdn_tag {
@@ -87,6 +196,7 @@ struct xcdn_annotation {
     xcdn_value_t **args;      /* Array of value pointers */
     size_t         args_len;
     size_t         args_cap;
+    uint32_t       flags;     /* XCDN_FLAG_FROZEN once its node is frozen */
 };
 
 /* ── Node: a value enriched with optional #tags and @annotations ──────── */
@@ -99,6 +209,8 @@ struct xcdn_node {
     size_t              annotations_len;
     size_t              annotations_cap;
     xcdn_value_t       *value;
+    uint32_t            flags;   /* XCDN_FLAG_* bits */
+    uint32_t            refs;    /* owners beyond the first (shared subtrees) */
 };
 
 /* ── Directive: a prolog directive, e.g. $schema: "..." ───────────────── */
@@ -117,6 +229,9 @@ struct xcdn_document {
     xcdn_node_t     **values;
     size_t            values_len;
     size_t            values_cap;
+    bool              frozen;
+    struct xcdn_span_table *spans;   /* node source spans, if recorded */
+    void             *block;   /* storage of a compacted document */
 };
 
 /* ═══════════════════════════════════════════════════════════════════════
@@ -134,17 +249,41 @@ xcdn_value_t *xcdn_value_null(void);
 xcdn_value_t *xcdn_value_bool(bool v);
 xcdn_value_t *xcdn_value_int(int64_t v);
 xcdn_value_t *xcdn_value_float(double v);
+/*
+ * INT or FLOAT value kept as numeric text (copied), converted on first
+ * access and serialized byte-for-byte. `text` must be a number lexeme.
+ */
+xcdn_value_t *xcdn_value_number_raw(const char *text, size_t len, bool is_float);
 xcdn_value_t *xcdn_value_decimal(const char *s);
 xcdn_value_t *xcdn_value_string(const char *s);
 xcdn_value_t *xcdn_value_string_owned(char *s);   /* takes ownership */
+/* Takes ownership of `s` whose length and metadata flags are already known. */
+xcdn_value_t *xcdn_value_string_scanned(char *s, size_t len, uint32_t flags);
+/*
+ * STRING, UUID or DATETIME value adopting one reference to a buffer from
+ * xcdn_strpool_intern(), with its length and metadata flags.
+ */
+xcdn_value_t *xcdn_value_string_pooled(xcdn_value_type_t type, char *text,
+                                       size_t len, uint32_t flags);
 xcdn_value_t *xcdn_value_bytes(const uint8_t *data, size_t len);
 xcdn_value_t *xcdn_value_bytes_owned(uint8_t *data, size_t len);
+/*
+ * Bytes kept as base64 text (takes ownership), decoded on first access.
+ * The text must be valid; `len` is its decoded size (xcdn_base64_measure).
+ */
+xcdn_value_t *xcdn_value_bytes_base64(char *text, size_t text_len, size_t len);
 xcdn_value_t *xcdn_value_datetime(const char *s);
 xcdn_value_t *xcdn_value_duration(const char *s);
 xcdn_value_t *xcdn_value_uuid(const char *s);
 xcdn_value_t *xcdn_value_array(void);
 xcdn_value_t *xcdn_value_object(void);
 
+/*
+ * Compute the XCDN_FLAG_* string metadata of `len` bytes at `s`
+ * (always includes XCDN_FLAG_SCANNED).
+ */
+uint32_t xcdn_string_flags(const char *s, size_t len);
+
 /* ═══════════════════════════════════════════════════════════════════════
  * Mutators
  * ═══════════════════════════════════════════════════════════════════════ */
@@ -159,18 +298,187 @@ void xcdn_document_push_directive(xcdn_document_t *doc, const char *name,
 /* Append a node to an array value. */
 void xcdn_array_push(xcdn_value_t *arr, xcdn_node_t *node);
 
+/*
+ * Make room for at least `cap` elements or entries, so that filling the
+ * container up to that size does not reallocate. Reserving room for more
+ * keys turns a shaped object back into a plain one. Returns false if the
+ * container is frozen or memory runs out.
+ */
+bool xcdn_array_reserve(xcdn_value_t *arr, size_t cap);
+bool xcdn_object_reserve(xcdn_value_t *obj, size_t cap);
+
+/* Append `count` nodes in one call; see xcdn_array_splice. */
+bool xcdn_array_append(xcdn_value_t *arr, xcdn_node_t *const *nodes, size_t count);
+
+/*
+ * Append an entry without looking for an existing one: the caller
+ * guarantees that the object does not have the key yet. `key_flags` is
+ * the key's string metadata (see xcdn_string_flags), or 0 if unknown.
+ * xcdn_object_append copies the key; xcdn_object_append_owned takes
+ * ownership of a heap-allocated key. Both take ownership of the node.
+ * Returns false, taking nothing, if the object is frozen, an argument is
+ * NULL or memory runs out.
+ */
+bool xcdn_object_append(xcdn_value_t *obj, const char *key, size_t key_len,
+                        uint32_t key_flags, xcdn_node_t *node);
+bool xcdn_object_append_owned(xcdn_value_t *obj, char *key, size_t key_len,
+                              uint32_t key_flags, xcdn_node_t *node);
+
+/*
+ * Replace `remove_count` nodes of an array starting at `index` (freeing
+ * them) with the `count` nodes at `nodes` (taking ownership), shifting
+ * the tail once. Returns false, changing nothing and taking nothing, if
+ * the array is frozen, the range is out of bounds, a node is NULL or
+ * memory runs out.
+ */
+bool xcdn_array_splice(xcdn_value_t *arr, size_t index, size_t remove_count,
+                       xcdn_node_t *const *nodes, size_t count);
+
+/* Insert a node before position `index` (0..len); see xcdn_array_splice. */
+bool xcdn_array_insert(xcdn_value_t *arr, size_t index, xcdn_node_t *node);
+
+/* Remove and free the node at `index`; see xcdn_array_splice. */
+bool xcdn_array_remove(xcdn_value_t *arr, size_t index);
+
 /* Insert/update a key-value pair in an object value. */
 void xcdn_object_set(xcdn_value_t *obj, const char *key, xcdn_node_t *node);
 
+/*
+ * Like xcdn_object_set, but takes ownership of `key`, whose length and
+ * metadata flags are already known (e.g. from the lexer).
+ */
+void xcdn_object_set_scanned(xcdn_value_t *obj, char *key, size_t key_len,
+                             uint32_t key_flags, xcdn_node_t *node);
+
+/*
+ * Remove a key from an object and free its node, keeping the order of the
+ * other entries. A shaped object becomes a plain one. Returns false if
+ * the key is missing, the object is frozen, or memory runs out.
+ */
+bool xcdn_object_remove(xcdn_value_t *obj, const char *key);
+
+/*
+ * Move an object's keys into the shape interned in `shapes` for its key
+ * sequence, keeping only a slot array of nodes. Lookups then go through
+ * the shape's index; adding a key later turns the object back into a
+ * plain one. Returns false if the object was left as it was (empty,
+ * frozen, already shaped, or allocation failure).
+ */
+bool xcdn_object_intern_shape(xcdn_value_t *obj, struct xcdn_shape_table *shapes);
+
 /* Add a tag to a node. */
 void xcdn_node_add_tag(xcdn_node_t *node, const char *name);
 
 /* Add an annotation to a node. */
 void xcdn_node_add_annotation(xcdn_node_t *node, const char *name);
 
-/* Add an argument value to the last annotation on a node. */
+/*
+ * Add an argument value to the last annotation on a node. A no-op on a
+ * frozen annotation; the caller then keeps ownership of `val`.
+ */
 void xcdn_annotation_push_arg(xcdn_annotation_t *ann, xcdn_value_t *val);
 
+/* ═══════════════════════════════════════════════════════════════════════
+ * Freezing
+ * ═══════════════════════════════════════════════════════════════════════ */
+
+/*
+ * Mark a document and every node/value reachable from it as immutable.
+ * Afterwards the document, node and value mutators above are no-ops on it,
+ * and the document may be read from any number of threads concurrently
+ * without locking. Numbers still held as text are converted here, so
+ * reading them later never writes.
+ * Freezing is idempotent and cannot be undone.
+ */
+void xcdn_document_freeze(xcdn_document_t *doc);
+
+/*
+ * Check whether a document has been frozen.
+ */
+bool xcdn_document_is_frozen(const xcdn_document_t *doc);
+
+/* ═══════════════════════════════════════════════════════════════════════
+ * Subtree sharing
+ * ═══════════════════════════════════════════════════════════════════════ */
+
+/*
+ * Hash-cons a document: every node whose subtree is identical to one seen
+ * earlier (see xcdn_node_equal) is replaced by that node, which is then
+ * reference counted and frozen, so repeated subtrees are stored once.
+ * Nodes that occur only once stay mutable. Spans of the dropped copies
+ * are forgotten. Returns the number of nodes replaced; frozen documents
+ * are left alone.
+ */
+size_t xcdn_document_share_subtrees(xcdn_document_t *doc);
+
+/*
+ * Check whether two nodes are identical: same tags and annotations in the
+ * same order, and equal values of the same type, with object keys in the
+ * same order. Numbers and bytes kept as source text compare by that text,
+ * so identical nodes always serialize identically. O(1) for nodes shared
+ * by xcdn_document_share_subtrees().
+ */
+bool xcdn_node_equal(const xcdn_node_t *a, const xcdn_node_t *b);
+
+/* ═══════════════════════════════════════════════════════════════════════
+ * Compaction
+ * ═══════════════════════════════════════════════════════════════════════ */
+
+/*
+ * Freeze a document, then move its whole tree (prolog, nodes, values,
+ * strings, keys, tags, annotations and shapes) into one allocation of
+ * exactly the needed size, laid out depth-first in document order, and
+ * free the scattered originals. Containers lose their spare capacity,
+ * shared subtrees stay shared, pooled strings stay deduplicated, and
+ * recorded spans follow their nodes. Bytes kept as text are decoded again
+ * on first access.
+ *
+ * Node and value pointers taken before the call are invalidated; the
+ * nodes of a compacted document live as long as the document. Returns
+ * false on allocation failure, leaving the document as it was (frozen).
+ */
+bool xcdn_document_compact(xcdn_document_t *doc);
+
+/* ═══════════════════════════════════════════════════════════════════════
+ * Memory usage
+ * ═══════════════════════════════════════════════════════════════════════ */
+
+typedef struct {
+    size_t used;       /* bytes holding data */
+    size_t reserved;   /* bytes allocated, spare capacity included */
+} xcdn_memory_use_t;
+
+/*
+ * Memory held by a document, by what it stores. Sizes are those requested
+ * from the allocator (its own overhead is not included), and storage
+ * reachable more than once (shared subtrees, shapes, pooled strings) is
+ * counted once.
+ */
+typedef struct {
+    xcdn_memory_use_t values;       /* value structs */
+    xcdn_memory_use_t nodes;        /* node structs */
+    xcdn_memory_use_t strings;      /* out-of-line string and number text */
+    xcdn_memory_use_t keys;         /* out-of-line object keys and shapes */
+    xcdn_memory_use_t bytes;        /* byte payloads, decoded and base64 */
+    xcdn_memory_use_t tags;         /* tag arrays and names */
+    xcdn_memory_use_t annotations;  /* annotation arrays, names and argument arrays */
+    xcdn_memory_use_t containers;   /* array items, object entries and slots */
+    xcdn_memory_use_t other;        /* document, prolog and span table */
+    xcdn_memory_use_t total;
+    size_t            slack;        /* total.reserved - total.used */
+    size_t            counts[XCDN_VAL_OBJECT + 1];  /* values per type */
+} xcdn_memory_stats_t;
+
+/*
+ * Measure the memory held by a document in one traversal. For a compacted
+ * document the figures recorded by xcdn_document_compact() are returned in
+ * O(1); its total also covers alignment padding, but not bytes decoded
+ * after compaction. Returns false if an argument is NULL, or if a
+ * temporary allocation failed (shared storage may then count twice).
+ */
+bool xcdn_document_memory_usage(const xcdn_document_t *doc,
+                                xcdn_memory_stats_t *stats);
+
 /* ═══════════════════════════════════════════════════════════════════════
  * Ergonomic Accessors — easy field/tag/annotation access
  * ═══════════════════════════════════════════════════════════════════════ */
@@ -199,6 +507,15 @@ bool xcdn_document_has_key(const xcdn_document_t *doc, const char *key);
  */
 xcdn_node_t *xcdn_object_get(const xcdn_value_t *obj, const char *key);
 
+/*
+ * Like xcdn_object_get, remembering in *hint the index the key was found
+ * at. A later call with the same hint on an object holding that key at the
+ * same index (e.g. another record of the same shape) costs one key compare.
+ * Start with *hint = 0.
+ */
+xcdn_node_t *xcdn_object_get_cached(const xcdn_value_t *obj, const char *key,
+                                    size_t *hint);
+
 /*
  * Check if a key exists in an object value.
  */
@@ -211,7 +528,9 @@ size_t xcdn_object_len(const xcdn_value_t *obj);
 
 /*
  * Get the key at index i in an object.
- * Returns NULL if out of bounds.
+ * Returns NULL if out of bounds. Short keys live inside the entry, so the
+ * pointer is only valid until the object is next modified (until the
+ * entry is removed when built with XCDN_HEAP_KEYS).
  */
 const char *xcdn_object_key_at(const xcdn_value_t *obj, size_t i);
 
@@ -238,16 +557,37 @@ size_t xcdn_array_len(const xcdn_value_t *arr);
  */
 const char *xcdn_value_as_string(const xcdn_value_t *val);
 
+/*
+ * True if a string-typed value holds only ASCII. Answered from the flag
+ * set by the lexer when available, otherwise by scanning.
+ */
+bool xcdn_value_is_ascii(const xcdn_value_t *val);
+
 /*
  * Shorthand: get the integer from a value. Returns 0 if not INT type.
+ * A number held as text is converted on the first call (strtoll rules,
+ * saturating when out of range).
  */
 int64_t xcdn_value_as_int(const xcdn_value_t *val);
 
 /*
  * Shorthand: get the float from a value. Returns 0.0 if not FLOAT type.
+ * A number held as text is converted on the first call (strtod rules).
  */
 double xcdn_value_as_float(const xcdn_value_t *val);
 
+/*
+ * True if two string-typed values have the same type and content. Values
+ * pooled by the same parse compare by pointer.
+ */
+bool xcdn_value_string_equal(const xcdn_value_t *a, const xcdn_value_t *b);
+
+/*
+ * Source text of an INT/FLOAT value that keeps it (XCDN_FLAG_RAW_NUMBER),
+ * or NULL. *len (if non-NULL) receives its length.
+ */
+const char *xcdn_value_number_text(const xcdn_value_t *val, size_t *len);
+
 /*
  * Shorthand: get the boolean from a value. Returns false if not BOOL type.
  */
@@ -255,6 +595,8 @@ bool xcdn_value_as_bool(const xcdn_value_t *val);
 
 /*
  * Shorthand: get bytes data and length. Returns NULL if not BYTES type.
+ * Lazy values are decoded on the first call; the result is kept, and
+ * concurrent first calls on a shared (e.g. frozen) document are safe.
  */
 const uint8_t *xcdn_value_as_bytes(const xcdn_value_t *val, size_t *out_len);
 
@@ -312,6 +654,7 @@ size_t xcdn_annotation_arg_count(const xcdn_annotation_t *ann);
  * ═══════════════════════════════════════════════════════════════════════ */
 
 void xcdn_document_free(xcdn_document_t *doc);
+/* A shared node only drops one reference until its last owner frees it. */
 void xcdn_node_free(xcdn_node_t *node);
 void xcdn_value_free(xcdn_value_t *val);
 
@@ -0,0 +1,83 @@
+/*
+ * xCDN - eXtensible Cognitive Data Notation (C implementation)
+ * Base64 decoding for b"..." literals.
+ *
+ * MIT License
+ */
+
+#include "base64.h"
+#include <stdlib.h>
+#include <ctype.h>
+
+static const unsigned char b64_table[256] = {
+    ['A']=0,['B']=1,['C']=2,['D']=3,['E']=4,['F']=5,['G']=6,['H']=7,
+    ['I']=8,['J']=9,['K']=10,['L']=11,['M']=12,['N']=13,['O']=14,['P']=15,
+    ['Q']=16,['R']=17,['S']=18,['T']=19,['U']=20,['V']=21,['W']=22,['X']=23,
+    ['Y']=24,['Z']=25,
+    ['a']=26,['b']=27,['c']=28,['d']=29,['e']=30,['f']=31,['g']=32,['h']=33,
+    ['i']=34,['j']=35,['k']=36,['l']=37,['m']=38,['n']=39,['o']=40,['p']=41,
+    ['q']=42,['r']=43,['s']=44,['t']=45,['u']=46,['v']=47,['w']=48,['x']=49,
+    ['y']=50,['z']=51,
+    ['0']=52,['1']=53,['2']=54,['3']=55,['4']=56,['5']=57,['6']=58,['7']=59,
+    ['8']=60,['9']=61,
+    ['+']=62,['/']=63,
+    ['-']=62,['_']=63, /* URL-safe variants */
+};
+
+static int is_b64_char(unsigned char c) {
+    return isalnum(c) || c == '+' || c == '/' || c == '-' || c == '_' || c == '=';
+}
+
+static int is_skipped(unsigned char c) {
+    return c == '=' || c == ' ' || c == '\n' || c == '\r';
+}
+
+/* Length without trailing padding. */
+static size_t strip_padding(const char *in, size_t len) {
+    while (len > 0 && in[len - 1] == '=') len--;
+    return len;
+}
+
+bool xcdn_base64_measure(const char *in, size_t len, size_t *out_len) {
+    len = strip_padding(in, len);
+    size_t digits = 0;
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)in[i];
+        if (is_skipped(c)) continue;
+        if (!is_b64_char(c)) return false;
+        digits++;
+    }
+    /* Every four digits make three bytes; leftover bits are dropped */
+    if (out_len) *out_len = digits / 4 * 3 + (digits % 4 * 6) / 8;
+    return true;
+}
+
+uint8_t *xcdn_base64_decode(const char *in, size_t len, size_t *out_len) {
+    len = strip_padding(in, len);
+
+    size_t max_out = (len * 3) / 4 + 3;
+    uint8_t *out = (uint8_t *)malloc(max_out);
+    if (!out) return NULL;
+
+    size_t o = 0;
+    uint32_t accum = 0;
+    int bits = 0;
+
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)in[i];
+        if (is_skipped(c)) continue;
+        if (!is_b64_char(c)) {
+            free(out);
+            return NULL;
+        }
+        accum = (accum << 6) | b64_table[c];
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out[o++] = (uint8_t)((accum >> bits) & 0xFF);
+        }
+    }
+
+    *out_len = o;
+    return out;
+}
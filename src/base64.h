@@ -0,0 +1,31 @@
+/*
+ * xCDN - eXtensible Cognitive Data Notation (C implementation)
+ * Base64 decoding for b"..." literals.
+ *
+ * Both the standard and the URL-safe alphabet are accepted; padding,
+ * spaces and line breaks are ignored.
+ *
+ * MIT License
+ */
+
+#ifndef XCDN_BASE64_H
+#define XCDN_BASE64_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Check `len` bytes of base64 text without decoding it. On success,
+ * *out_len receives the decoded size. Accepts exactly the inputs that
+ * xcdn_base64_decode() accepts.
+ */
+bool xcdn_base64_measure(const char *in, size_t len, size_t *out_len);
+
+/*
+ * Decode `len` bytes of base64 text into a new heap buffer.
+ * Returns NULL on invalid input or allocation failure.
+ */
+uint8_t *xcdn_base64_decode(const char *in, size_t len, size_t *out_len);
+
+#endif /* XCDN_BASE64_H */
@@ -8,6 +8,7 @@
 #include "error.h"
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdlib.h>
 #include <string.h>
 
 xcdn_span_t xcdn_span_start(void) {
@@ -46,6 +47,103 @@ int xcdn_error_is_set(const xcdn_error_t *err) {
     return err && err->kind != XCDN_ERR_NONE;
 }
 
+/* ── Compact error state ──────────────────────────────────────────────── */
+
+xcdn_error_state_t xcdn_error_state_none(void) {
+    xcdn_error_state_t e;
+    memset(&e, 0, sizeof(e));
+    return e;
+}
+
+void xcdn_error_state_set(xcdn_error_state_t *err, xcdn_error_kind_t kind,
+                          xcdn_message_t msg, xcdn_span_t span) {
+    if (!err) return;
+    free(err->detail);
+    err->kind = kind;
+    err->msg = msg;
+    err->span = span;
+    err->ch = 0;
+    err->arg = NULL;
+    err->arg2 = NULL;
+    err->detail = NULL;
+}
+
+void xcdn_error_state_detail(xcdn_error_state_t *err, const char *text,
+                             size_t len) {
+    if (!err) return;
+    free(err->detail);
+    err->detail = (char *)malloc(len + 1);
+    if (err->detail) {
+        memcpy(err->detail, text, len);
+        err->detail[len] = '\0';
+    }
+}
+
+void xcdn_error_state_clear(xcdn_error_state_t *err) {
+    if (!err) return;
+    free(err->detail);
+    *err = xcdn_error_state_none();
+}
+
+int xcdn_error_format(const xcdn_error_state_t *err, char *buf, size_t len) {
+    if (!err) return snprintf(buf, len, "%s", "");
+    const char *detail = err->detail ? err->detail : "";
+    switch (err->msg) {
+        case XCDN_MSG_NONE:
+            return snprintf(buf, len, "%s", "");
+        case XCDN_MSG_UNTERMINATED_TRIPLE:
+            return snprintf(buf, len, "unterminated triple-quoted string");
+        case XCDN_MSG_EXPECTED_QUOTE:
+            return snprintf(buf, len, "expected '\"', found '%c'", (char)err->ch);
+        case XCDN_MSG_UNTERMINATED_STRING:
+            return snprintf(buf, len, "unterminated string");
+        case XCDN_MSG_INCOMPLETE_ESCAPE:
+            return snprintf(buf, len, "incomplete escape at end of input");
+        case XCDN_MSG_INVALID_U_ESCAPE:
+            return snprintf(buf, len, "invalid \\uXXXX escape");
+        case XCDN_MSG_UNKNOWN_ESCAPE:
+            return snprintf(buf, len, "unknown escape '\\%c'", (char)err->ch);
+        case XCDN_MSG_NO_DIGITS:
+            return snprintf(buf, len, "no digits in number");
+        case XCDN_MSG_INVALID_FLOAT:
+            return snprintf(buf, len, "invalid float: %s", detail);
+        case XCDN_MSG_INVALID_INTEGER:
+            return snprintf(buf, len, "invalid integer: %s", detail);
+        case XCDN_MSG_UNEXPECTED_CHAR:
+            return snprintf(buf, len, "unexpected character '%c' (0x%02x)",
+                            (char)err->ch, err->ch);
+        case XCDN_MSG_EXPECTED:
+            return snprintf(buf, len, "expected %s, found %s",
+                            err->arg ? err->arg : "", err->arg2 ? err->arg2 : "");
+        case XCDN_MSG_INVALID_BASE64:
+            return snprintf(buf, len, "invalid base64: %s", detail);
+        case XCDN_MSG_INVALID_UUID:
+            return snprintf(buf, len, "invalid UUID: %s", detail);
+        case XCDN_MSG_TOP_LEVEL_COLON:
+            return snprintf(buf, len, "expected ':' after top-level key '%s'",
+                            err->detail ? err->detail : "?");
+        case XCDN_MSG_OUT_OF_MEMORY:
+            return snprintf(buf, len, "out of memory");
+        case XCDN_MSG_INVALID_UTF8:
+            return snprintf(buf, len,
+                            "invalid UTF-8 sequence starting with byte 0x%02x",
+                            err->ch);
+        default:
+            return snprintf(buf, len, "%s", xcdn_error_kind_str(err->kind));
+    }
+}
+
+void xcdn_error_state_export(xcdn_error_state_t *err, xcdn_error_t *out) {
+    if (out) {
+        out->kind = err->kind;
+        out->span = err->span;
+        out->message[0] = '\0';
+        if (err->kind != XCDN_ERR_NONE)
+            xcdn_error_format(err, out->message, sizeof(out->message));
+    }
+    xcdn_error_state_clear(err);
+}
+
 const char *xcdn_error_kind_str(xcdn_error_kind_t kind) {
     switch (kind) {
         case XCDN_ERR_NONE:             return "no error";
@@ -61,6 +159,7 @@ const char *xcdn_error_kind_str(xcdn_error_kind_t kind) {
         case XCDN_ERR_INVALID_BASE64:   return "invalid base64 encoding";
         case XCDN_ERR_MESSAGE:          return "error";
         case XCDN_ERR_OUT_OF_MEMORY:    return "out of memory";
+        case XCDN_ERR_INVALID_UTF8:     return "invalid UTF-8";
         default:                        return "unknown error";
     }
 }
@@ -32,6 +32,7 @@ typedef enum {
     XCDN_ERR_INVALID_BASE64,
     XCDN_ERR_MESSAGE,
     XCDN_ERR_OUT_OF_MEMORY,
+    XCDN_ERR_INVALID_UTF8,
 } xcdn_error_kind_t;
 
 /* Full error with position. */
@@ -41,6 +42,42 @@ typedef struct {
     char              message[256];
 } xcdn_error_t;
 
+/* Message templates for the compact error state. */
+typedef enum {
+    XCDN_MSG_NONE = 0,
+    XCDN_MSG_UNTERMINATED_TRIPLE,   /* unterminated triple-quoted string */
+    XCDN_MSG_EXPECTED_QUOTE,        /* expected '"', found '<ch>' */
+    XCDN_MSG_UNTERMINATED_STRING,   /* unterminated string */
+    XCDN_MSG_INCOMPLETE_ESCAPE,     /* incomplete escape at end of input */
+    XCDN_MSG_INVALID_U_ESCAPE,      /* invalid \uXXXX escape */
+    XCDN_MSG_UNKNOWN_ESCAPE,        /* unknown escape '\<ch>' */
+    XCDN_MSG_NO_DIGITS,             /* no digits in number */
+    XCDN_MSG_INVALID_FLOAT,         /* invalid float: <detail> */
+    XCDN_MSG_INVALID_INTEGER,       /* invalid integer: <detail> */
+    XCDN_MSG_UNEXPECTED_CHAR,       /* unexpected character '<ch>' (0x..) */
+    XCDN_MSG_EXPECTED,              /* expected <arg>, found <arg2> */
+    XCDN_MSG_INVALID_BASE64,        /* invalid base64: <detail> */
+    XCDN_MSG_INVALID_UUID,          /* invalid UUID: <detail> */
+    XCDN_MSG_TOP_LEVEL_COLON,       /* expected ':' after top-level key '<detail>' */
+    XCDN_MSG_OUT_OF_MEMORY,         /* out of memory */
+    XCDN_MSG_INVALID_UTF8,          /* invalid UTF-8 sequence starting with byte 0x.. */
+} xcdn_message_t;
+
+/*
+ * Compact error state used while lexing and parsing: a kind, a span and
+ * the arguments of a message template. Nothing is formatted until
+ * xcdn_error_format() is called, so the success path never touches text.
+ */
+typedef struct {
+    xcdn_error_kind_t kind;
+    xcdn_message_t    msg;
+    xcdn_span_t       span;
+    int               ch;       /* character argument */
+    const char       *arg;      /* string arguments with static lifetime */
+    const char       *arg2;
+    char             *detail;   /* owned copy of a source-derived argument */
+} xcdn_error_state_t;
+
 /* Construct a starting span (line 1, col 1). */
 xcdn_span_t xcdn_span_start(void);
 
@@ -57,6 +94,32 @@ xcdn_error_t xcdn_error_new(xcdn_error_kind_t kind, xcdn_span_t span,
 /* Check if an error is set. */
 int xcdn_error_is_set(const xcdn_error_t *err);
 
+/* Construct an empty error state. */
+xcdn_error_state_t xcdn_error_state_none(void);
+
+/*
+ * Record an error in `err`, replacing any earlier one. Arguments start out
+ * empty; callers fill in `ch`, `arg`, `arg2` or xcdn_error_state_detail().
+ */
+void xcdn_error_state_set(xcdn_error_state_t *err, xcdn_error_kind_t kind,
+                          xcdn_message_t msg, xcdn_span_t span);
+
+/* Attach a copy of the first `len` bytes of `text` as the detail argument. */
+void xcdn_error_state_detail(xcdn_error_state_t *err, const char *text,
+                             size_t len);
+
+/* Release the detail argument and reset to "no error". */
+void xcdn_error_state_clear(xcdn_error_state_t *err);
+
+/*
+ * Format the message of an error state into `buf` (always NUL-terminated
+ * when len > 0). Returns the length of the full message, like snprintf.
+ */
+int xcdn_error_format(const xcdn_error_state_t *err, char *buf, size_t len);
+
+/* Fill a full error from an error state, then clear the state. */
+void xcdn_error_state_export(xcdn_error_state_t *err, xcdn_error_t *out);
+
 /* Get a human-readable string for an error kind. */
 const char *xcdn_error_kind_str(xcdn_error_kind_t kind);
 
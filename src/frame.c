@@ -0,0 +1,363 @@
+/*
+ * xCDN - eXtensible Cognitive Data Notation (C implementation)
+ * Length-prefixed message framing.
+ *
+ * MIT License
+ */
+
+#include "frame.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define FRAME_DEFAULT_WINDOW (64 * 1024)
+#define FRAME_DEFAULT_BATCH  (64 * 1024)
+#define FRAME_DEFAULT_MAX    ((size_t)64 * 1024 * 1024)
+
+/* ── Checksum ─────────────────────────────────────────────────────────── */
+
+/* CRC-32C, reflected polynomial 0x82F63B78. */
+static const uint32_t crc32c_table[256] = {
+    0x00000000u, 0xf26b8303u, 0xe13b70f7u, 0x1350f3f4u, 0xc79a971fu, 0x35f1141cu,
+    0x26a1e7e8u, 0xd4ca64ebu, 0x8ad958cfu, 0x78b2dbccu, 0x6be22838u, 0x9989ab3bu,
+    0x4d43cfd0u, 0xbf284cd3u, 0xac78bf27u, 0x5e133c24u, 0x105ec76fu, 0xe235446cu,
+    0xf165b798u, 0x030e349bu, 0xd7c45070u, 0x25afd373u, 0x36ff2087u, 0xc494a384u,
+    0x9a879fa0u, 0x68ec1ca3u, 0x7bbcef57u, 0x89d76c54u, 0x5d1d08bfu, 0xaf768bbcu,
+    0xbc267848u, 0x4e4dfb4bu, 0x20bd8edeu, 0xd2d60dddu, 0xc186fe29u, 0x33ed7d2au,
+    0xe72719c1u, 0x154c9ac2u, 0x061c6936u, 0xf477ea35u, 0xaa64d611u, 0x580f5512u,
+    0x4b5fa6e6u, 0xb93425e5u, 0x6dfe410eu, 0x9f95c20du, 0x8cc531f9u, 0x7eaeb2fau,
+    0x30e349b1u, 0xc288cab2u, 0xd1d83946u, 0x23b3ba45u, 0xf779deaeu, 0x05125dadu,
+    0x1642ae59u, 0xe4292d5au, 0xba3a117eu, 0x4851927du, 0x5b016189u, 0xa96ae28au,
+    0x7da08661u, 0x8fcb0562u, 0x9c9bf696u, 0x6ef07595u, 0x417b1dbcu, 0xb3109ebfu,
+    0xa0406d4bu, 0x522bee48u, 0x86e18aa3u, 0x748a09a0u, 0x67dafa54u, 0x95b17957u,
+    0xcba24573u, 0x39c9c670u, 0x2a993584u, 0xd8f2b687u, 0x0c38d26cu, 0xfe53516fu,
+    0xed03a29bu, 0x1f682198u, 0x5125dad3u, 0xa34e59d0u, 0xb01eaa24u, 0x42752927u,
+    0x96bf4dccu, 0x64d4cecfu, 0x77843d3bu, 0x85efbe38u, 0xdbfc821cu, 0x2997011fu,
+    0x3ac7f2ebu, 0xc8ac71e8u, 0x1c661503u, 0xee0d9600u, 0xfd5d65f4u, 0x0f36e6f7u,
+    0x61c69362u, 0x93ad1061u, 0x80fde395u, 0x72966096u, 0xa65c047du, 0x5437877eu,
+    0x4767748au, 0xb50cf789u, 0xeb1fcbadu, 0x197448aeu, 0x0a24bb5au, 0xf84f3859u,
+    0x2c855cb2u, 0xdeeedfb1u, 0xcdbe2c45u, 0x3fd5af46u, 0x7198540du, 0x83f3d70eu,
+    0x90a324fau, 0x62c8a7f9u, 0xb602c312u, 0x44694011u, 0x5739b3e5u, 0xa55230e6u,
+    0xfb410cc2u, 0x092a8fc1u, 0x1a7a7c35u, 0xe811ff36u, 0x3cdb9bddu, 0xceb018deu,
+    0xdde0eb2au, 0x2f8b6829u, 0x82f63b78u, 0x709db87bu, 0x63cd4b8fu, 0x91a6c88cu,
+    0x456cac67u, 0xb7072f64u, 0xa457dc90u, 0x563c5f93u, 0x082f63b7u, 0xfa44e0b4u,
+    0xe9141340u, 0x1b7f9043u, 0xcfb5f4a8u, 0x3dde77abu, 0x2e8e845fu, 0xdce5075cu,
+    0x92a8fc17u, 0x60c37f14u, 0x73938ce0u, 0x81f80fe3u, 0x55326b08u, 0xa759e80bu,
+    0xb4091bffu, 0x466298fcu, 0x1871a4d8u, 0xea1a27dbu, 0xf94ad42fu, 0x0b21572cu,
+    0xdfeb33c7u, 0x2d80b0c4u, 0x3ed04330u, 0xccbbc033u, 0xa24bb5a6u, 0x502036a5u,
+    0x4370c551u, 0xb11b4652u, 0x65d122b9u, 0x97baa1bau, 0x84ea524eu, 0x7681d14du,
+    0x2892ed69u, 0xdaf96e6au, 0xc9a99d9eu, 0x3bc21e9du, 0xef087a76u, 0x1d63f975u,
+    0x0e330a81u, 0xfc588982u, 0xb21572c9u, 0x407ef1cau, 0x532e023eu, 0xa145813du,
+    0x758fe5d6u, 0x87e466d5u, 0x94b49521u, 0x66df1622u, 0x38cc2a06u, 0xcaa7a905u,
+    0xd9f75af1u, 0x2b9cd9f2u, 0xff56bd19u, 0x0d3d3e1au, 0x1e6dcdeeu, 0xec064eedu,
+    0xc38d26c4u, 0x31e6a5c7u, 0x22b65633u, 0xd0ddd530u, 0x0417b1dbu, 0xf67c32d8u,
+    0xe52cc12cu, 0x1747422fu, 0x49547e0bu, 0xbb3ffd08u, 0xa86f0efcu, 0x5a048dffu,
+    0x8ecee914u, 0x7ca56a17u, 0x6ff599e3u, 0x9d9e1ae0u, 0xd3d3e1abu, 0x21b862a8u,
+    0x32e8915cu, 0xc083125fu, 0x144976b4u, 0xe622f5b7u, 0xf5720643u, 0x07198540u,
+    0x590ab964u, 0xab613a67u, 0xb831c993u, 0x4a5a4a90u, 0x9e902e7bu, 0x6cfbad78u,
+    0x7fab5e8cu, 0x8dc0dd8fu, 0xe330a81au, 0x115b2b19u, 0x020bd8edu, 0xf0605beeu,
+    0x24aa3f05u, 0xd6c1bc06u, 0xc5914ff2u, 0x37faccf1u, 0x69e9f0d5u, 0x9b8273d6u,
+    0x88d28022u, 0x7ab90321u, 0xae7367cau, 0x5c18e4c9u, 0x4f48173du, 0xbd23943eu,
+    0xf36e6f75u, 0x0105ec76u, 0x12551f82u, 0xe03e9c81u, 0x34f4f86au, 0xc69f7b69u,
+    0xd5cf889du, 0x27a40b9eu, 0x79b737bau, 0x8bdcb4b9u, 0x988c474du, 0x6ae7c44eu,
+    0xbe2da0a5u, 0x4c4623a6u, 0x5f16d052u, 0xad7d5351u,
+};
+
+uint32_t xcdn_crc32c(uint32_t crc, const void *data, size_t len) {
+    const uint8_t *p = (const uint8_t *)data;
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++)
+        crc = crc32c_table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void put_le32(uint8_t *out, uint32_t v) {
+    out[0] = (uint8_t)v;
+    out[1] = (uint8_t)(v >> 8);
+    out[2] = (uint8_t)(v >> 16);
+    out[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t get_le32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* ── Prefix ───────────────────────────────────────────────────────────── */
+
+size_t xcdn_frame_prefix(uint8_t *out, size_t len, bool checked) {
+    uint64_t v = ((uint64_t)len << 1) | (checked ? 1u : 0u);
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (uint8_t)v;
+    return n;
+}
+
+/*
+ * Decode a prefix from the `avail` bytes at `p`. Returns its length,
+ * 0 if more bytes are needed, or -1 if it is malformed.
+ */
+static int decode_prefix(const uint8_t *p, size_t avail, uint64_t *out) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < avail && i < XCDN_FRAME_MAX_PREFIX; i++) {
+        if (i == XCDN_FRAME_MAX_PREFIX - 1 && p[i] > 1) return -1;
+        v |= (uint64_t)(p[i] & 0x7F) << (7 * i);
+        if (!(p[i] & 0x80)) {
+            *out = v;
+            return (int)i + 1;
+        }
+    }
+    return avail >= XCDN_FRAME_MAX_PREFIX ? -1 : 0;
+}
+
+/* ── Reader ───────────────────────────────────────────────────────────── */
+
+/*
+ * Unconsumed bytes are [head, tail) of the window. Frames are handed out
+ * in place; when the frame at head does not fit before the end of the
+ * window, its bytes are moved to the front (and the window grown if the
+ * frame is larger than it).
+ */
+struct xcdn_frame_reader {
+    xcdn_source_fn              source;
+    void                       *ctx;
+    xcdn_frame_reader_options_t opts;
+    char                       *buf;
+    size_t                      cap;
+    size_t                      head;
+    size_t                      tail;
+    bool                        eof;
+    xcdn_frame_status_t         status;   /* sticky stream error */
+};
+
+xcdn_frame_reader_options_t xcdn_frame_reader_options_default(void) {
+    xcdn_frame_reader_options_t o;
+    o.window = FRAME_DEFAULT_WINDOW;
+    o.max_frame = FRAME_DEFAULT_MAX;
+    o.require_checksum = false;
+    o.parse = xcdn_parse_options_default();
+    return o;
+}
+
+xcdn_frame_reader_t *xcdn_frame_reader_new(xcdn_source_fn source, void *ctx,
+                                           xcdn_frame_reader_options_t opts) {
+    if (!source) return NULL;
+    xcdn_frame_reader_t *r = (xcdn_frame_reader_t *)calloc(1, sizeof(*r));
+    if (!r) return NULL;
+    if (opts.window < XCDN_FRAME_MAX_PREFIX + 4)
+        opts.window = FRAME_DEFAULT_WINDOW;
+    r->buf = (char *)malloc(opts.window);
+    if (!r->buf) {
+        free(r);
+        return NULL;
+    }
+    r->source = source;
+    r->ctx = ctx;
+    r->opts = opts;
+    r->cap = opts.window;
+    return r;
+}
+
+static xcdn_frame_status_t reader_fail(xcdn_frame_reader_t *r,
+                                       xcdn_frame_status_t st) {
+    r->status = st;
+    return st;
+}
+
+/* Make room for a frame of `need` bytes at head, then read once. */
+static xcdn_frame_status_t reader_fill(xcdn_frame_reader_t *r, size_t need) {
+    size_t avail = r->tail - r->head;
+    if (avail == 0) {
+        r->head = r->tail = 0;
+    } else if (r->cap - r->head < need) {
+        memmove(r->buf, r->buf + r->head, avail);
+        r->head = 0;
+        r->tail = avail;
+    }
+    if (r->cap < need) {
+        size_t cap = r->cap * 2 > need ? r->cap * 2 : need;
+        char *buf = (char *)realloc(r->buf, cap);
+        if (!buf) return XCDN_FRAME_ERR_NOMEM;
+        r->buf = buf;
+        r->cap = cap;
+    }
+    ptrdiff_t got = r->source(r->ctx, r->buf + r->tail, r->cap - r->tail);
+    if (got < 0) return XCDN_FRAME_ERR_IO;
+    if (got == 0)
+        r->eof = true;
+    else
+        r->tail += (size_t)got;
+    return XCDN_FRAME_OK;
+}
+
+xcdn_frame_status_t xcdn_frame_next(xcdn_frame_reader_t *r,
+                                    const char **payload, size_t *len) {
+    if (!r || !payload || !len) return XCDN_FRAME_ERR_IO;
+    if (r->status != XCDN_FRAME_OK) return r->status;
+
+    for (;;) {
+        size_t avail = r->tail - r->head;
+        const uint8_t *p = (const uint8_t *)r->buf + r->head;
+        size_t need = XCDN_FRAME_MAX_PREFIX;
+        uint64_t word = 0;
+        int n = decode_prefix(p, avail, &word);
+        if (n < 0) return reader_fail(r, XCDN_FRAME_ERR_PREFIX);
+        if (n > 0) {
+            uint64_t size = word >> 1;
+            bool checked = (word & 1) != 0;
+            if (size > r->opts.max_frame)
+                return reader_fail(r, XCDN_FRAME_ERR_TOO_LARGE);
+            if (!checked && r->opts.require_checksum)
+                return reader_fail(r, XCDN_FRAME_ERR_CHECKSUM);
+            need = (size_t)n + (size_t)size + (checked ? 4 : 0);
+            if (avail >= need) {
+                const char *data = r->buf + r->head + n;
+                if (checked && xcdn_crc32c(0, data, (size_t)size) !=
+                                   get_le32(p + n + size))
+                    return reader_fail(r, XCDN_FRAME_ERR_CHECKSUM);
+                r->head += need;
+                *payload = data;
+                *len = (size_t)size;
+                return XCDN_FRAME_OK;
+            }
+        }
+        if (r->eof)
+            return reader_fail(r, avail == 0 ? XCDN_FRAME_EOF
+                                             : XCDN_FRAME_ERR_TRUNCATED);
+        xcdn_frame_status_t st = reader_fill(r, need);
+        if (st != XCDN_FRAME_OK) return reader_fail(r, st);
+    }
+}
+
+xcdn_frame_status_t xcdn_frame_read(xcdn_frame_reader_t *r,
+                                    xcdn_document_t **doc, xcdn_error_t *err) {
+    if (!doc) return XCDN_FRAME_ERR_IO;
+    *doc = NULL;
+    const char *payload;
+    size_t len;
+    xcdn_frame_status_t st = xcdn_frame_next(r, &payload, &len);
+    if (st != XCDN_FRAME_OK) return st;
+
+    xcdn_error_t local;
+    if (!err) err = &local;
+    *doc = xcdn_parse_str_with_options(payload, len, r->opts.parse, err);
+    if (*doc) return XCDN_FRAME_OK;
+    return err->kind == XCDN_ERR_OUT_OF_MEMORY ? XCDN_FRAME_ERR_NOMEM
+                                               : XCDN_FRAME_ERR_PARSE;
+}
+
+void xcdn_frame_reader_free(xcdn_frame_reader_t *r) {
+    if (!r) return;
+    free(r->buf);
+    free(r);
+}
+
+/* ── Writer ───────────────────────────────────────────────────────────── */
+
+struct xcdn_frame_writer {
+    xcdn_sink_fn sink;
+    void        *ctx;
+    char        *buf;
+    size_t       len;
+    size_t       cap;
+    bool         checksum;
+    int          error;
+};
+
+xcdn_frame_writer_t *xcdn_frame_writer_new(xcdn_sink_fn sink, void *ctx,
+                                           size_t batch, bool checksum) {
+    if (!sink) return NULL;
+    xcdn_frame_writer_t *w = (xcdn_frame_writer_t *)calloc(1, sizeof(*w));
+    if (!w) return NULL;
+    w->cap = batch ? batch : FRAME_DEFAULT_BATCH;
+    w->buf = (char *)malloc(w->cap);
+    if (!w->buf) {
+        free(w);
+        return NULL;
+    }
+    w->sink = sink;
+    w->ctx = ctx;
+    w->checksum = checksum;
+    return w;
+}
+
+int xcdn_frame_flush(xcdn_frame_writer_t *w) {
+    if (!w) return -1;
+    if (w->error) return w->error;
+    if (w->len > 0) {
+        int rc = w->sink(w->ctx, w->buf, w->len);
+        w->len = 0;
+        if (rc) w->error = rc;
+    }
+    return w->error;
+}
+
+/* Queue bytes; runs that do not fit in a batch go to the sink directly. */
+static void writer_put(xcdn_frame_writer_t *w, const void *data, size_t n) {
+    if (w->error || n == 0) return;
+    if (n <= w->cap - w->len) {
+        memcpy(w->buf + w->len, data, n);
+        w->len += n;
+        return;
+    }
+    if (xcdn_frame_flush(w)) return;
+    if (n < w->cap) {
+        memcpy(w->buf, data, n);
+        w->len = n;
+        return;
+    }
+    int rc = w->sink(w->ctx, (const char *)data, n);
+    if (rc) w->error = rc;
+}
+
+static void writer_put_prefix(xcdn_frame_writer_t *w, size_t len) {
+    uint8_t prefix[XCDN_FRAME_MAX_PREFIX];
+    writer_put(w, prefix, xcdn_frame_prefix(prefix, len, w->checksum));
+}
+
+static void writer_put_checksum(xcdn_frame_writer_t *w, uint32_t crc) {
+    if (!w->checksum) return;
+    uint8_t ck[4];
+    put_le32(ck, crc);
+    writer_put(w, ck, sizeof(ck));
+}
+
+int xcdn_frame_write(xcdn_frame_writer_t *w, const void *payload, size_t len) {
+    if (!w || (!payload && len > 0)) return -1;
+    if (w->error) return w->error;
+    writer_put_prefix(w, len);
+    writer_put(w, payload, len);
+    writer_put_checksum(w, w->checksum ? xcdn_crc32c(0, payload, len) : 0);
+    return w->error;
+}
+
+int xcdn_frame_write_document(xcdn_frame_writer_t *w,
+                              const xcdn_document_t *doc, xcdn_format_t fmt) {
+    if (!w || !doc) return -1;
+    if (w->error) return w->error;
+
+    /* Runs at least a batch long would bypass the batch anyway */
+    xcdn_iovec_list_t list;
+    if (xcdn_to_iovec(doc, fmt, w->cap, &list) != 0) return -1;
+    uint32_t crc = 0;
+    if (w->checksum) {
+        for (size_t i = 0; i < list.len; i++)
+            crc = xcdn_crc32c(crc, list.iov[i].base, list.iov[i].len);
+    }
+    writer_put_prefix(w, list.bytes);
+    for (size_t i = 0; i < list.len; i++)
+        writer_put(w, list.iov[i].base, list.iov[i].len);
+    writer_put_checksum(w, crc);
+    xcdn_iovec_list_free(&list);
+    return w->error;
+}
+
+int xcdn_frame_writer_finish(xcdn_frame_writer_t *w) {
+    if (!w) return -1;
+    int rc = xcdn_frame_flush(w);
+    free(w->buf);
+    free(w);
+    return rc;
+}
@@ -0,0 +1,139 @@
+/*
+ * xCDN - eXtensible Cognitive Data Notation (C implementation)
+ * Length-prefixed message framing.
+ *
+ * Carries a stream of xCDN messages over a byte transport (socket, pipe,
+ * file). Each frame is
+ *
+ *   varint(len << 1 | checked)  payload[len]  [crc32c(payload), 4 bytes LE]
+ *
+ * where the varint is unsigned LEB128 and the checksum is present when
+ * the low bit of the prefix is set.
+ *
+ * The reader pulls bytes through a callback into a receive window and
+ * hands out payloads (or parses documents) straight from the window: only
+ * the unfinished tail of a frame is ever moved, when the window wraps.
+ * The writer batches frames into large sink calls and passes payloads
+ * larger than the batch to the sink without copying them.
+ *
+ *   xcdn_frame_writer_t *w = xcdn_frame_writer_new(sink, &fd, 0, true);
+ *   xcdn_frame_write_document(w, doc, xcdn_format_compact());
+ *   xcdn_frame_writer_finish(w);
+ *
+ *   xcdn_frame_reader_t *r = xcdn_frame_reader_new(
+ *       source, &fd, xcdn_frame_reader_options_default());
+ *   while (xcdn_frame_read(r, &doc, &err) == XCDN_FRAME_OK) { ... }
+ *   xcdn_frame_reader_free(r);
+ *
+ * MIT License
+ */
+
+#ifndef XCDN_FRAME_H
+#define XCDN_FRAME_H
+
+#include "ast.h"
+#include "parser.h"
+#include "ser.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Longest frame prefix (a 64-bit LEB128 varint). */
+#define XCDN_FRAME_MAX_PREFIX 10
+
+typedef enum {
+    XCDN_FRAME_OK = 0,
+    XCDN_FRAME_EOF,             /* clean end of stream between frames */
+    XCDN_FRAME_ERR_IO,          /* the source reported an error */
+    XCDN_FRAME_ERR_TRUNCATED,   /* stream ended inside a frame */
+    XCDN_FRAME_ERR_PREFIX,      /* malformed length prefix */
+    XCDN_FRAME_ERR_TOO_LARGE,   /* frame above max_frame */
+    XCDN_FRAME_ERR_CHECKSUM,    /* checksum mismatch (or missing, if required) */
+    XCDN_FRAME_ERR_PARSE,       /* payload is not valid xCDN (stream still usable) */
+    XCDN_FRAME_ERR_NOMEM,
+} xcdn_frame_status_t;
+
+/* CRC-32C (Castagnoli) of `data`, continuing from `crc` (0 to start). */
+uint32_t xcdn_crc32c(uint32_t crc, const void *data, size_t len);
+
+/*
+ * Encode a frame prefix for a payload of `len` bytes into `out` (at least
+ * XCDN_FRAME_MAX_PREFIX bytes). Returns the prefix length.
+ */
+size_t xcdn_frame_prefix(uint8_t *out, size_t len, bool checked);
+
+/* ── Reader ───────────────────────────────────────────────────────────── */
+
+/*
+ * Input callback: read up to `cap` bytes into `buf`.
+ * Returns the number of bytes read, 0 at end of stream, negative on error.
+ */
+typedef ptrdiff_t (*xcdn_source_fn)(void *ctx, char *buf, size_t cap);
+
+typedef struct {
+    size_t               window;            /* initial window size (default 64 KiB) */
+    size_t               max_frame;         /* largest accepted payload (default 64 MiB) */
+    bool                 require_checksum;  /* reject frames without one */
+    xcdn_parse_options_t parse;             /* used by xcdn_frame_read() */
+} xcdn_frame_reader_options_t;
+
+/* Returns the default reader options. */
+xcdn_frame_reader_options_t xcdn_frame_reader_options_default(void);
+
+typedef struct xcdn_frame_reader xcdn_frame_reader_t;
+
+/* Create a reader. Returns NULL on allocation failure. */
+xcdn_frame_reader_t *xcdn_frame_reader_new(xcdn_source_fn source, void *ctx,
+                                           xcdn_frame_reader_options_t opts);
+
+/*
+ * Next frame's payload, checksum verified. *payload points into the
+ * window and stays valid until the next call on the reader.
+ * Stream errors are sticky: every later call returns the same status.
+ */
+xcdn_frame_status_t xcdn_frame_next(xcdn_frame_reader_t *r,
+                                    const char **payload, size_t *len);
+
+/*
+ * Next frame parsed as a document (parsed in place from the window).
+ * On XCDN_FRAME_ERR_PARSE, *err holds the parser's error and the next
+ * frame can still be read.
+ */
+xcdn_frame_status_t xcdn_frame_read(xcdn_frame_reader_t *r,
+                                    xcdn_document_t **doc, xcdn_error_t *err);
+
+void xcdn_frame_reader_free(xcdn_frame_reader_t *r);
+
+/* ── Writer ───────────────────────────────────────────────────────────── */
+
+typedef struct xcdn_frame_writer xcdn_frame_writer_t;
+
+/*
+ * Create a writer that hands batches of about `batch` bytes (0 selects
+ * 64 KiB) to `sink`, checksumming every frame if `checksum` is set.
+ * Returns NULL on allocation failure.
+ */
+xcdn_frame_writer_t *xcdn_frame_writer_new(xcdn_sink_fn sink, void *ctx,
+                                           size_t batch, bool checksum);
+
+/*
+ * Queue one frame. Frames reach the sink when the batch fills, or on
+ * xcdn_frame_flush(); flush after a burst when latency matters.
+ * Returns 0 or the first error (-1 on allocation failure, or the sink's).
+ */
+int xcdn_frame_write(xcdn_frame_writer_t *w, const void *payload, size_t len);
+
+/*
+ * Queue a document serialized with `fmt` as one frame. Large strings
+ * and bytes go to the sink in place (see xcdn_to_iovec()).
+ */
+int xcdn_frame_write_document(xcdn_frame_writer_t *w,
+                              const xcdn_document_t *doc, xcdn_format_t fmt);
+
+/* Hand queued frames to the sink. Returns 0 or the first error. */
+int xcdn_frame_flush(xcdn_frame_writer_t *w);
+
+/* Flush and free the writer. Returns 0 or the first error. */
+int xcdn_frame_writer_finish(xcdn_frame_writer_t *w);
+
+#endif /* XCDN_FRAME_H */
@@ -6,6 +6,7 @@
  */
 
 #include "lexer.h"
+#include "utf8.h"
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
@@ -46,6 +47,36 @@ static int lex_bump(xcdn_lexer_t *lex) {
     return b;
 }
 
+/*
+ * Move to `pos` in one step. Newlines in the skipped run are found with
+ * memchr (vectorized in common libcs) to keep line/column exact.
+ */
+static void lex_advance_to(xcdn_lexer_t *lex, size_t pos) {
+    const char *at = lex->src + lex->idx;
+    const char *stop = lex->src + pos;
+    const char *last_nl = NULL;
+    while (at < stop && (at = (const char *)memchr(at, '\n', (size_t)(stop - at)))) {
+        lex->line++;
+        last_nl = at++;
+    }
+    if (last_nl) lex->col = (size_t)(stop - last_nl);
+    else lex->col += pos - lex->idx;
+    lex->idx = pos;
+}
+
+/* Offset of the first occurrence of `pat` at or after `from`, or src_len. */
+static size_t lex_find(const xcdn_lexer_t *lex, size_t from, const char *pat,
+                       size_t pat_len) {
+    const char *at = lex->src + from;
+    const char *stop = lex->src + lex->src_len;
+    while ((size_t)(stop - at) >= pat_len &&
+           (at = (const char *)memchr(at, pat[0], (size_t)(stop - at - (ptrdiff_t)pat_len + 1)))) {
+        if (memcmp(at, pat, pat_len) == 0) return (size_t)(at - lex->src);
+        at++;
+    }
+    return lex->src_len;
+}
+
 static xcdn_span_t lex_span(const xcdn_lexer_t *lex) {
     return xcdn_span_new(lex->idx, lex->line, lex->col);
 }
@@ -68,25 +99,14 @@ static void skip_ws_and_comments(xcdn_lexer_t *lex) {
         if (b == '/' && lex->idx + 1 < lex->src_len) {
             unsigned char b2 = (unsigned char)lex->src[lex->idx + 1];
             if (b2 == '/') {
-                /* Line comment */
-                lex_bump(lex);
-                lex_bump(lex);
-                while (lex->idx < lex->src_len) {
-                    int c = lex_bump(lex);
-                    if (c == '\n') break;
-                }
+                /* Line comment: up to and including the newline */
+                size_t nl = lex_find(lex, lex->idx + 2, "\n", 1);
+                lex_advance_to(lex, nl < lex->src_len ? nl + 1 : nl);
                 continue;
             } else if (b2 == '*') {
-                /* Block comment */
-                lex_bump(lex);
-                lex_bump(lex);
-                while (lex->idx < lex->src_len) {
-                    int c = lex_bump(lex);
-                    if (c == '*' && lex_peek(lex) == '/') {
-                        lex_bump(lex);
-                        break;
-                    }
-                }
+                /* Block comment; an unterminated one runs to the end */
+                size_t close = lex_find(lex, lex->idx + 2, "*/", 2);
+                lex_advance_to(lex, close < lex->src_len ? close + 2 : close);
                 continue;
             }
         }
@@ -119,6 +139,20 @@ static void strbuf_push(strbuf_t *sb, char c) {
     sb->buf[sb->len++] = c;
 }
 
+static void strbuf_append(strbuf_t *sb, const char *data, size_t n) {
+    if (n == 0) return;   /* buf may still be NULL */
+    if (sb->len + n > sb->cap) {
+        size_t new_cap = (sb->cap == 0) ? 32 : sb->cap;
+        while (new_cap < sb->len + n) new_cap *= 2;
+        char *new_buf = (char *)realloc(sb->buf, new_cap);
+        if (!new_buf) return;
+        sb->buf = new_buf;
+        sb->cap = new_cap;
+    }
+    memcpy(sb->buf + sb->len, data, n);
+    sb->len += n;
+}
+
 static char *strbuf_finish(strbuf_t *sb, size_t *out_len) {
     strbuf_push(sb, '\0');
     if (out_len) *out_len = sb->len - 1; /* exclude NUL */
@@ -135,48 +169,39 @@ static void strbuf_free(strbuf_t *sb) {
 /* ── Read string (normal or triple-quoted) ────────────────────────────── */
 
 static char *read_string(xcdn_lexer_t *lex, int triple, size_t *out_len,
-                         xcdn_error_t *err) {
+                         xcdn_error_state_t *err) {
     strbuf_t sb;
     strbuf_init(&sb);
     xcdn_span_t start_span = lex_span(lex);
 
     if (triple) {
-        /* Consume the three opening quotes """ */
-        lex_bump(lex);
-        lex_bump(lex);
-        lex_bump(lex);
-        for (;;) {
-            if (lex_peek(lex) == '"' && lex_peek_at(lex, 1) == '"' &&
-                lex_peek_at(lex, 2) == '"') {
-                lex_bump(lex);
-                lex_bump(lex);
-                lex_bump(lex);
-                break;
-            }
-            int b = lex_bump(lex);
-            if (b < 0) {
-                strbuf_free(&sb);
-                *err = xcdn_error_new(XCDN_ERR_EOF, start_span,
-                                      "unterminated triple-quoted string");
-                return NULL;
-            }
-            strbuf_push(&sb, (char)b);
+        /* Triple-quoted content is raw: copy the whole run at once */
+        size_t from = lex->idx + 3;
+        size_t close = lex_find(lex, from, "\"\"\"", 3);
+        if (close >= lex->src_len) {
+            lex_advance_to(lex, lex->src_len);
+            xcdn_error_state_set(err, XCDN_ERR_EOF,
+                                 XCDN_MSG_UNTERMINATED_TRIPLE, start_span);
+            return NULL;
         }
+        strbuf_append(&sb, lex->src + from, close - from);
+        lex_advance_to(lex, close + 3);
     } else {
         /* Consume opening quote */
         int q = lex_bump(lex);
         if (q != '"') {
             strbuf_free(&sb);
-            *err = xcdn_error_new(XCDN_ERR_EXPECTED, start_span,
-                                  "expected '\"', found '%c'", (char)q);
+            xcdn_error_state_set(err, XCDN_ERR_EXPECTED,
+                                 XCDN_MSG_EXPECTED_QUOTE, start_span);
+            err->ch = q;
             return NULL;
         }
         for (;;) {
             int b = lex_bump(lex);
             if (b < 0) {
                 strbuf_free(&sb);
-                *err = xcdn_error_new(XCDN_ERR_EOF, start_span,
-                                      "unterminated string");
+                xcdn_error_state_set(err, XCDN_ERR_EOF,
+                                     XCDN_MSG_UNTERMINATED_STRING, start_span);
                 return NULL;
             }
             if (b == '"') break;
@@ -184,8 +209,8 @@ static char *read_string(xcdn_lexer_t *lex, int triple, size_t *out_len,
                 int e = lex_bump(lex);
                 if (e < 0) {
                     strbuf_free(&sb);
-                    *err = xcdn_error_new(XCDN_ERR_INVALID_ESCAPE, start_span,
-                                          "incomplete escape at end of input");
+                    xcdn_error_state_set(err, XCDN_ERR_INVALID_ESCAPE,
+                                         XCDN_MSG_INCOMPLETE_ESCAPE, start_span);
                     return NULL;
                 }
                 switch (e) {
@@ -204,8 +229,8 @@ static char *read_string(xcdn_lexer_t *lex, int triple, size_t *out_len,
                             int h = lex_bump(lex);
                             if (h < 0 || !isxdigit((unsigned char)h)) {
                                 strbuf_free(&sb);
-                                *err = xcdn_error_new(XCDN_ERR_INVALID_ESCAPE,
-                                    start_span, "invalid \\uXXXX escape");
+                                xcdn_error_state_set(err, XCDN_ERR_INVALID_ESCAPE,
+                                    XCDN_MSG_INVALID_U_ESCAPE, start_span);
                                 return NULL;
                             }
                             strbuf_push(&sb, (char)h);
@@ -214,8 +239,9 @@ static char *read_string(xcdn_lexer_t *lex, int triple, size_t *out_len,
                     }
                     default:
                         strbuf_free(&sb);
-                        *err = xcdn_error_new(XCDN_ERR_INVALID_ESCAPE,
-                            start_span, "unknown escape '\\%c'", (char)e);
+                        xcdn_error_state_set(err, XCDN_ERR_INVALID_ESCAPE,
+                            XCDN_MSG_UNKNOWN_ESCAPE, start_span);
+                        err->ch = e;
                         return NULL;
                 }
             } else {
@@ -227,6 +253,58 @@ static char *read_string(xcdn_lexer_t *lex, int triple, size_t *out_len,
     return strbuf_finish(&sb, out_len);
 }
 
+/* ── Check string content ─────────────────────────────────────────────── */
+
+/* Position of `offset`, counting lines onward from an earlier span. */
+static xcdn_span_t lex_position(const xcdn_lexer_t *lex, xcdn_span_t from,
+                                size_t offset) {
+    const char *at = lex->src + from.offset, *stop = lex->src + offset;
+    const char *last_nl = NULL;
+    size_t line = from.line;
+    while (at < stop && (at = (const char *)memchr(at, '\n', (size_t)(stop - at)))) {
+        line++;
+        last_nl = at++;
+    }
+    size_t col = last_nl ? (size_t)(stop - last_nl) : from.column + (offset - from.offset);
+    return xcdn_span_new(offset, line, col);
+}
+
+/*
+ * Flag string content that is ASCII-only, needs no escaping, or is a
+ * simple identifier and, in strict mode, reject invalid UTF-8. The
+ * literal's source bytes [from, to) are checked: escapes are ASCII, so
+ * every other byte reached the token unchanged and the error can point
+ * at its exact position. An escape leaves a '\\' or '"' in the content
+ * too, so the source bytes also decide the PLAIN and IDENT flags.
+ */
+static int check_string(const xcdn_lexer_t *lex, xcdn_token_t *tok,
+                        size_t from, size_t to, xcdn_error_state_t *err) {
+    const char *s = lex->src + from;
+    size_t len = to - from;
+    unsigned char seen = 0;
+    int plain = 1;
+    int ident = len > 0 && is_ident_start((unsigned char)s[0]);
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)s[i];
+        seen |= c;
+        if (c < 32 || c == '"' || c == '\\') plain = 0;
+        if (!is_ident_part(c)) ident = 0;
+    }
+    if (plain) tok->flags |= XCDN_TOKF_PLAIN;
+    if (ident) tok->flags |= XCDN_TOKF_IDENT;
+    if (seen < 0x80) {
+        tok->flags |= XCDN_TOKF_ASCII;
+        return 1;
+    }
+    size_t bad = 0;
+    if (!lex->strict_utf8 || xcdn_utf8_validate(s, len, &bad) != XCDN_UTF8_INVALID)
+        return 1;
+    xcdn_error_state_set(err, XCDN_ERR_INVALID_UTF8, XCDN_MSG_INVALID_UTF8,
+                         lex_position(lex, tok->span, from + bad));
+    err->ch = (unsigned char)s[bad];
+    return 0;
+}
+
 /* ── Read identifier ──────────────────────────────────────────────────── */
 
 static char *read_ident(xcdn_lexer_t *lex, size_t *out_len) {
@@ -247,8 +325,22 @@ static char *read_ident(xcdn_lexer_t *lex, size_t *out_len) {
 
 /* ── Read number ──────────────────────────────────────────────────────── */
 
+/* True if strtod() would consume at least one character of a lexeme. */
+static int float_has_mantissa(const char *s, size_t len) {
+    size_t i = 0;
+    if (i < len && (s[i] == '+' || s[i] == '-')) i++;
+    if (i < len && s[i] == '.') i++;
+    return i < len && s[i] >= '0' && s[i] <= '9';
+}
+
+/*
+ * In raw mode nothing is converted and *raw_len receives the lexeme
+ * length. Lexemes no conversion could read still fail; out-of-range
+ * values are accepted and keep their text.
+ */
 static void read_number(xcdn_lexer_t *lex, int64_t *out_int, double *out_float,
-                        int *is_float_out, xcdn_error_t *err) {
+                        int *is_float_out, size_t *raw_len,
+                        xcdn_error_state_t *err) {
     size_t start = lex->idx;
     int has_dot = 0, has_exp = 0, has_digit = 0;
 
@@ -276,34 +368,42 @@ static void read_number(xcdn_lexer_t *lex, int64_t *out_int, double *out_float,
     }
 
     if (!has_digit) {
-        *err = xcdn_error_new(XCDN_ERR_INVALID_NUMBER, lex_span(lex),
-                              "no digits in number");
+        xcdn_error_state_set(err, XCDN_ERR_INVALID_NUMBER, XCDN_MSG_NO_DIGITS,
+                             lex_span(lex));
         return;
     }
 
-    /* Extract the substring */
     size_t len = lex->idx - start;
+    *is_float_out = has_dot || has_exp;
+    if (lex->raw_numbers &&
+        (!*is_float_out || float_has_mantissa(lex->src + start, len))) {
+        *raw_len = len;
+        return;
+    }
+
+    /* Extract the substring */
     char tmp[128];
     if (len >= sizeof(tmp)) len = sizeof(tmp) - 1;
     memcpy(tmp, lex->src + start, len);
     tmp[len] = '\0';
 
-    *is_float_out = has_dot || has_exp;
     if (*is_float_out) {
         char *endp = NULL;
         errno = 0;
         *out_float = strtod(tmp, &endp);
         if (errno == ERANGE || endp == tmp) {
-            *err = xcdn_error_new(XCDN_ERR_INVALID_NUMBER, lex_span(lex),
-                                  "invalid float: %s", tmp);
+            xcdn_error_state_set(err, XCDN_ERR_INVALID_NUMBER,
+                                 XCDN_MSG_INVALID_FLOAT, lex_span(lex));
+            xcdn_error_state_detail(err, tmp, len);
         }
     } else {
         char *endp = NULL;
         errno = 0;
         long long v = strtoll(tmp, &endp, 10);
         if (errno == ERANGE || endp == tmp) {
-            *err = xcdn_error_new(XCDN_ERR_INVALID_NUMBER, lex_span(lex),
-                                  "invalid integer: %s", tmp);
+            xcdn_error_state_set(err, XCDN_ERR_INVALID_NUMBER,
+                                 XCDN_MSG_INVALID_INTEGER, lex_span(lex));
+            xcdn_error_state_detail(err, tmp, len);
         }
         *out_int = (int64_t)v;
     }
@@ -317,12 +417,20 @@ void xcdn_lexer_init(xcdn_lexer_t *lex, const char *src, size_t src_len) {
     lex->idx = 0;
     lex->line = 1;
     lex->col = 1;
+    lex->strict_utf8 = 0;
+    lex->raw_numbers = 0;
 }
 
 xcdn_token_t xcdn_lexer_next(xcdn_lexer_t *lex, xcdn_error_t *err) {
+    xcdn_error_state_t st = xcdn_error_state_none();
+    xcdn_token_t tok = xcdn_lexer_scan(lex, &st);
+    xcdn_error_state_export(&st, err);
+    return tok;
+}
+
+xcdn_token_t xcdn_lexer_scan(xcdn_lexer_t *lex, xcdn_error_state_t *err) {
     xcdn_token_t tok;
     memset(&tok, 0, sizeof(tok));
-    *err = xcdn_error_none();
 
     skip_ws_and_comments(lex);
     xcdn_span_t start = lex_span(lex);
@@ -338,7 +446,7 @@ xcdn_token_t xcdn_lexer_next(xcdn_lexer_t *lex, xcdn_error_t *err) {
     if (b == '"' && lex_peek_at(lex, 1) == '"' && lex_peek_at(lex, 2) == '"') {
         size_t slen = 0;
         char *s = read_string(lex, 1, &slen, err);
-        if (xcdn_error_is_set(err)) {
+        if (err->kind != XCDN_ERR_NONE) {
             tok.type = XCDN_TOK_EOF;
             return tok;
         }
@@ -346,6 +454,10 @@ xcdn_token_t xcdn_lexer_next(xcdn_lexer_t *lex, xcdn_error_t *err) {
         tok.span = start;
         tok.data.string_val.str = s;
         tok.data.string_val.len = slen;
+        if (!check_string(lex, &tok, start.offset + 3, lex->idx - 3, err)) {
+            xcdn_token_free(&tok);
+            tok.type = XCDN_TOK_EOF;
+        }
         return tok;
     }
 
@@ -369,7 +481,7 @@ xcdn_token_t xcdn_lexer_next(xcdn_lexer_t *lex, xcdn_error_t *err) {
     if (b == '"') {
         size_t slen = 0;
         char *s = read_string(lex, 0, &slen, err);
-        if (xcdn_error_is_set(err)) {
+        if (err->kind != XCDN_ERR_NONE) {
             tok.type = XCDN_TOK_EOF;
             return tok;
         }
@@ -377,6 +489,10 @@ xcdn_token_t xcdn_lexer_next(xcdn_lexer_t *lex, xcdn_error_t *err) {
         tok.span = start;
         tok.data.string_val.str = s;
         tok.data.string_val.len = slen;
+        if (!check_string(lex, &tok, start.offset + 1, lex->idx - 1, err)) {
+            xcdn_token_free(&tok);
+            tok.type = XCDN_TOK_EOF;
+        }
         return tok;
     }
 
@@ -385,13 +501,19 @@ xcdn_token_t xcdn_lexer_next(xcdn_lexer_t *lex, xcdn_error_t *err) {
         int64_t iv = 0;
         double fv = 0.0;
         int is_float = 0;
-        read_number(lex, &iv, &fv, &is_float, err);
-        if (xcdn_error_is_set(err)) {
+        size_t raw_len = 0;
+        read_number(lex, &iv, &fv, &is_float, &raw_len, err);
+        if (err->kind != XCDN_ERR_NONE) {
             tok.type = XCDN_TOK_EOF;
             return tok;
         }
         tok.span = start;
-        if (is_float) {
+        if (raw_len > 0) {
+            tok.type = is_float ? XCDN_TOK_FLOAT : XCDN_TOK_INT;
+            tok.flags = XCDN_TOKF_RAW;
+            tok.data.string_val.str = NULL;
+            tok.data.string_val.len = raw_len;
+        } else if (is_float) {
             tok.type = XCDN_TOK_FLOAT;
             tok.data.float_val = fv;
         } else {
@@ -408,7 +530,7 @@ xcdn_token_t xcdn_lexer_next(xcdn_lexer_t *lex, xcdn_error_t *err) {
         lex_bump(lex); /* consume type char */
         size_t slen = 0;
         char *s = read_string(lex, 0, &slen, err);
-        if (xcdn_error_is_set(err)) {
+        if (err->kind != XCDN_ERR_NONE) {
             tok.type = XCDN_TOK_EOF;
             return tok;
         }
@@ -423,6 +545,10 @@ xcdn_token_t xcdn_lexer_next(xcdn_lexer_t *lex, xcdn_error_t *err) {
             case 'r': tok.type = XCDN_TOK_R_QUOTED; break;
             default: break;
         }
+        if (!check_string(lex, &tok, start.offset + 2, lex->idx - 1, err)) {
+            xcdn_token_free(&tok);
+            tok.type = XCDN_TOK_EOF;
+        }
         return tok;
     }
 
@@ -442,6 +568,7 @@ xcdn_token_t xcdn_lexer_next(xcdn_lexer_t *lex, xcdn_error_t *err) {
             free(s);
         } else {
             tok.type = XCDN_TOK_IDENT;
+            tok.flags = XCDN_TOKF_ASCII | XCDN_TOKF_PLAIN | XCDN_TOKF_IDENT;
             tok.data.string_val.str = s;
             tok.data.string_val.len = slen;
         }
@@ -449,8 +576,9 @@ xcdn_token_t xcdn_lexer_next(xcdn_lexer_t *lex, xcdn_error_t *err) {
     }
 
     /* Unknown token */
-    *err = xcdn_error_new(XCDN_ERR_INVALID_TOKEN, start,
-                          "unexpected character '%c' (0x%02x)", (char)b, b);
+    xcdn_error_state_set(err, XCDN_ERR_INVALID_TOKEN, XCDN_MSG_UNEXPECTED_CHAR,
+                         start);
+    err->ch = b;
     tok.type = XCDN_TOK_EOF;
     return tok;
 }
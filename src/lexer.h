@@ -7,6 +7,8 @@
  * - Tracks line/column per token
  * - Recognizes typed string literals: d"...", b"...", u"...", t"...", r"..."
  * - Supports double-quoted strings and triple-quoted multi-line strings
+ * - Flags string content that is ASCII-only, needs no escaping, or is a
+ *   simple identifier; optionally rejects invalid UTF-8 in strings
  *
  * MIT License
  */
@@ -47,9 +49,20 @@ typedef enum {
     XCDN_TOK_EOF,
 } xcdn_token_type_t;
 
+/* Token flags. */
+enum {
+    XCDN_TOKF_ASCII = 1u << 0,   /* string content is pure ASCII */
+    XCDN_TOKF_PLAIN = 1u << 1,   /* no byte of the content needs escaping */
+    XCDN_TOKF_IDENT = 1u << 2,   /* content is a simple identifier */
+    XCDN_TOKF_RAW   = 1u << 3,   /* number left unconverted: its lexeme is the
+                                    data.string_val.len source bytes at
+                                    span.offset (string_val.str is NULL) */
+};
+
 /* A token with its type, value, and source position. */
 typedef struct {
     xcdn_token_type_t type;
+    uint32_t          flags;   /* XCDN_TOKF_* bits */
     xcdn_span_t       span;
     /* Value data: depends on token type */
     union {
@@ -69,6 +82,8 @@ typedef struct {
     size_t      idx;
     size_t      line;
     size_t      col;
+    int         strict_utf8;   /* reject string content that is not UTF-8 */
+    int         raw_numbers;   /* check numbers but leave them unconverted */
 } xcdn_lexer_t;
 
 /* Initialize a lexer for the given source string. */
@@ -77,6 +92,13 @@ void xcdn_lexer_init(xcdn_lexer_t *lex, const char *src, size_t src_len);
 /* Read and return the next token. Returns an error if invalid. */
 xcdn_token_t xcdn_lexer_next(xcdn_lexer_t *lex, xcdn_error_t *err);
 
+/*
+ * Like xcdn_lexer_next, but records failures in a compact error state that
+ * must start out empty and is only written on error. Returns an EOF token
+ * on error.
+ */
+xcdn_token_t xcdn_lexer_scan(xcdn_lexer_t *lex, xcdn_error_state_t *err);
+
 /* Free any heap data owned by a token (string values). */
 void xcdn_token_free(xcdn_token_t *tok);
 
@@ -0,0 +1,445 @@
+/*
+ * xCDN - eXtensible Cognitive Data Notation (C implementation)
+ * Append-only record log.
+ *
+ * MIT License
+ */
+
+#if defined(__unix__) || defined(__APPLE__)
+#define _POSIX_C_SOURCE 200809L
+#define XCDN_LOG_POSIX 1
+#endif
+
+#include "log.h"
+#include "ser.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef XCDN_LOG_POSIX
+#include <sys/types.h>
+#include <unistd.h>
+#define log_seek(f, off) fseeko((f), (off_t)(off), SEEK_SET)
+#else
+#define log_seek(f, off) fseek((f), (long)(off), SEEK_SET)
+#endif
+
+#define LOG_DEFAULT_BUFFER (64 * 1024)
+#define LOG_READ_WINDOW    (64 * 1024)
+
+/* ── Sparse index ─────────────────────────────────────────────────────── */
+
+void xcdn_log_index_init(xcdn_log_index_t *index, uint64_t every) {
+    if (!index) return;
+    memset(index, 0, sizeof(*index));
+    index->every = every ? every : 1;
+}
+
+void xcdn_log_index_free(xcdn_log_index_t *index) {
+    if (!index) return;
+    free(index->offsets);
+    index->offsets = NULL;
+    index->len = 0;
+    index->cap = 0;
+}
+
+/*
+ * Record the offset of `record` if it is the next entry the index needs.
+ * Entries are only ever appended in order, so a reader that seeks ahead
+ * simply stops extending the index.
+ */
+static void index_note(xcdn_log_index_t *index, uint64_t record,
+                       uint64_t offset) {
+    if (!index || index->every == 0 || record % index->every != 0 ||
+        record / index->every != index->len)
+        return;
+    if (index->len == index->cap) {
+        size_t cap = index->cap ? index->cap * 2 : 64;
+        uint64_t *offsets =
+            (uint64_t *)realloc(index->offsets, cap * sizeof(uint64_t));
+        if (!offsets) return;
+        index->offsets = offsets;
+        index->cap = cap;
+    }
+    index->offsets[index->len++] = offset;
+}
+
+/* Forget the entry of `record` (dropped from the end of the log). */
+static void index_drop(xcdn_log_index_t *index, uint64_t record) {
+    if (index && index->every && index->len > 0 &&
+        (uint64_t)(index->len - 1) * index->every == record)
+        index->len--;
+}
+
+/* ── Reader ───────────────────────────────────────────────────────────── */
+
+/*
+ * Bytes [head, tail) of the window are unread; [head, scan) is known to
+ * hold no newline. buf[0] is at file offset `base`.
+ */
+struct xcdn_log_reader {
+    FILE                 *f;
+    xcdn_parse_options_t  opts;
+    xcdn_log_index_t     *index;
+    char                 *buf;
+    size_t                cap;
+    size_t                head;
+    size_t                scan;
+    size_t                tail;
+    uint64_t              base;
+    uint64_t              record;   /* number of the next record */
+    uint64_t              valid;    /* offset past the last record read */
+    bool                  eof;
+    xcdn_log_status_t     status;   /* sticky end or error */
+};
+
+static void reader_reset(xcdn_log_reader_t *r, uint64_t offset,
+                         uint64_t record) {
+    r->head = r->scan = r->tail = 0;
+    r->base = r->valid = offset;
+    r->record = record;
+    r->eof = false;
+    r->status = XCDN_LOG_OK;
+}
+
+xcdn_log_reader_t *xcdn_log_reader_open(const char *path,
+                                        xcdn_parse_options_t opts,
+                                        xcdn_log_index_t *index) {
+    if (!path) return NULL;
+    xcdn_log_reader_t *r = (xcdn_log_reader_t *)calloc(1, sizeof(*r));
+    if (!r) return NULL;
+    r->f = fopen(path, "rb");
+    r->buf = (char *)malloc(LOG_READ_WINDOW);
+    if (!r->f || !r->buf) {
+        xcdn_log_reader_close(r);
+        return NULL;
+    }
+    r->cap = LOG_READ_WINDOW;
+    r->opts = opts;
+    r->index = index;
+    reader_reset(r, 0, 0);
+    return r;
+}
+
+/*
+ * Next line (without its newline), valid until the next call. Returns
+ * XCDN_LOG_END at the end of the file, or XCDN_LOG_TORN if it ends
+ * inside a line.
+ */
+static xcdn_log_status_t reader_line(xcdn_log_reader_t *r, const char **line,
+                                     size_t *len) {
+    for (;;) {
+        char *nl = (char *)memchr(r->buf + r->scan, '\n', r->tail - r->scan);
+        if (nl) {
+            *line = r->buf + r->head;
+            *len = (size_t)(nl - *line);
+            r->head = r->scan = (size_t)(nl - r->buf) + 1;
+            return XCDN_LOG_OK;
+        }
+        r->scan = r->tail;
+        if (r->eof)
+            return r->head == r->tail ? XCDN_LOG_END : XCDN_LOG_TORN;
+
+        if (r->tail == r->cap) {
+            if (r->head > 0) {
+                size_t avail = r->tail - r->head;
+                memmove(r->buf, r->buf + r->head, avail);
+                r->base += r->head;
+                r->scan -= r->head;
+                r->tail = avail;
+                r->head = 0;
+            } else {
+                char *buf = (char *)realloc(r->buf, r->cap * 2);
+                if (!buf) return XCDN_LOG_ERR_NOMEM;
+                r->buf = buf;
+                r->cap *= 2;
+            }
+        }
+        size_t got = fread(r->buf + r->tail, 1, r->cap - r->tail, r->f);
+        if (got == 0) {
+            if (ferror(r->f)) return XCDN_LOG_ERR_IO;
+            r->eof = true;
+        }
+        r->tail += got;
+    }
+}
+
+static xcdn_log_status_t reader_fail(xcdn_log_reader_t *r,
+                                     xcdn_log_status_t st) {
+    r->status = st;
+    return st;
+}
+
+xcdn_log_status_t xcdn_log_next(xcdn_log_reader_t *r, xcdn_document_t **doc,
+                                xcdn_error_t *err) {
+    if (!r || !doc) return XCDN_LOG_ERR_IO;
+    *doc = NULL;
+    if (r->status != XCDN_LOG_OK) return r->status;
+
+    const char *line;
+    size_t len;
+    do {
+        xcdn_log_status_t st = reader_line(r, &line, &len);
+        if (st != XCDN_LOG_OK) return reader_fail(r, st);
+    } while (len == 0);
+
+    uint64_t at = r->base + (uint64_t)(line - r->buf);
+    xcdn_error_t local;
+    if (!err) err = &local;
+    xcdn_document_t *d = xcdn_parse_str_with_options(line, len, r->opts, err);
+    if (!d) {
+        if (err->kind == XCDN_ERR_OUT_OF_MEMORY)
+            return reader_fail(r, XCDN_LOG_ERR_NOMEM);
+        /* Garbage at the very end is what a crash leaves behind */
+        const char *next;
+        size_t next_len;
+        xcdn_log_status_t st;
+        do {
+            st = reader_line(r, &next, &next_len);
+        } while (st == XCDN_LOG_OK && next_len == 0);
+        return reader_fail(r, st == XCDN_LOG_END ? XCDN_LOG_TORN
+                                                 : XCDN_LOG_CORRUPT);
+    }
+    index_note(r->index, r->record, at);
+    r->record++;
+    r->valid = r->base + r->head;
+    *doc = d;
+    return XCDN_LOG_OK;
+}
+
+uint64_t xcdn_log_reader_record(const xcdn_log_reader_t *r) {
+    return r ? r->record : 0;
+}
+
+uint64_t xcdn_log_reader_offset(const xcdn_log_reader_t *r) {
+    return r ? r->valid : 0;
+}
+
+int xcdn_log_reader_seek(xcdn_log_reader_t *r, const xcdn_log_index_t *index,
+                         uint64_t record) {
+    if (!r) return -1;
+    uint64_t from = 0, offset = 0;
+    if (index && index->every && index->len > 0) {
+        uint64_t i = record / index->every;
+        if (i >= index->len) i = index->len - 1;
+        from = i * index->every;
+        offset = index->offsets[i];
+    }
+    clearerr(r->f);
+    if (log_seek(r->f, offset) != 0) return -1;
+    reader_reset(r, offset, from);
+
+    while (r->record < record) {
+        const char *line;
+        size_t len;
+        xcdn_log_status_t st = reader_line(r, &line, &len);
+        if (st != XCDN_LOG_OK) {
+            reader_fail(r, st);
+            return -1;
+        }
+        if (len > 0) r->record++;
+        r->valid = r->base + r->head;
+    }
+    return 0;
+}
+
+void xcdn_log_reader_close(xcdn_log_reader_t *r) {
+    if (!r) return;
+    if (r->f) fclose(r->f);
+    free(r->buf);
+    free(r);
+}
+
+/* ── Recovery ─────────────────────────────────────────────────────────── */
+
+/*
+ * Count the complete records of an existing log and find where they end.
+ * Only the last one is parsed: a crash can only tear the tail. Sets
+ * *size to the file size (0 if the file does not exist).
+ */
+static int scan_existing(const char *path, xcdn_log_index_t *index,
+                         uint64_t *records, uint64_t *valid, uint64_t *size) {
+    *records = *valid = *size = 0;
+    xcdn_log_reader_t *r =
+        xcdn_log_reader_open(path, xcdn_parse_options_default(), NULL);
+    if (!r) return 0;
+
+    uint64_t last = 0;
+    const char *line;
+    size_t len;
+    xcdn_log_status_t st;
+    while ((st = reader_line(r, &line, &len)) == XCDN_LOG_OK) {
+        if (len == 0) continue;
+        last = r->base + (uint64_t)(line - r->buf);
+        index_note(index, r->record++, last);
+        r->valid = r->base + r->head;
+    }
+    *records = r->record;
+    *valid = r->valid;
+    *size = r->base + r->tail;
+    if (st != XCDN_LOG_END && st != XCDN_LOG_TORN) {
+        xcdn_log_reader_close(r);
+        return -1;
+    }
+
+    if (*records > 0) {
+        size_t n = (size_t)(*valid - last);
+        char *text = (char *)malloc(n);
+        xcdn_document_t *doc = NULL;
+        xcdn_error_t err;
+        clearerr(r->f);
+        if (text && log_seek(r->f, last) == 0 && fread(text, 1, n, r->f) == n)
+            doc = xcdn_parse_str(text, n - 1, &err);
+        free(text);
+        if (doc) {
+            xcdn_document_free(doc);
+        } else {
+            (*records)--;
+            *valid = last;
+            index_drop(index, *records);
+        }
+    }
+    xcdn_log_reader_close(r);
+    return 0;
+}
+
+/* ── Writer ───────────────────────────────────────────────────────────── */
+
+struct xcdn_log {
+    FILE              *f;
+    xcdn_log_options_t opts;
+    char              *buf;        /* pending text, not yet written */
+    size_t             len;
+    size_t             cap;
+    uint64_t           end;        /* file offset where buf goes */
+    uint64_t           records;
+    uint64_t           synced;
+    int64_t            since;      /* ms timestamp of the oldest unsynced record */
+    int                error;
+};
+
+static int64_t now_ms(void) {
+    struct timespec ts;
+    if (!timespec_get(&ts, TIME_UTC)) return 0;
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+xcdn_log_options_t xcdn_log_options_default(void) {
+    xcdn_log_options_t o;
+    o.sync_every = 1024;
+    o.sync_ms = 10;
+    o.buffer = LOG_DEFAULT_BUFFER;
+    o.index = NULL;
+    return o;
+}
+
+xcdn_log_t *xcdn_log_open(const char *path, xcdn_log_options_t opts) {
+    if (!path) return NULL;
+    uint64_t records, valid, size;
+    if (scan_existing(path, opts.index, &records, &valid, &size) != 0)
+        return NULL;
+    if (valid < size) {
+#ifdef XCDN_LOG_POSIX
+        if (truncate(path, (off_t)valid) != 0) return NULL;
+#else
+        return NULL;   /* a torn tail must go before anything is appended */
+#endif
+    }
+
+    xcdn_log_t *log = (xcdn_log_t *)calloc(1, sizeof(*log));
+    if (!log) return NULL;
+    if (opts.buffer == 0) opts.buffer = LOG_DEFAULT_BUFFER;
+    log->f = fopen(path, "ab");
+    if (!log->f) {
+        free(log);
+        return NULL;
+    }
+    setvbuf(log->f, NULL, _IONBF, 0);   /* buffered here instead */
+    log->opts = opts;
+    log->end = valid;
+    log->records = log->synced = records;
+    return log;
+}
+
+static void log_write_out(xcdn_log_t *log) {
+    if (log->error || log->len == 0) return;
+    if (fwrite(log->buf, 1, log->len, log->f) != log->len) {
+        log->error = -1;
+        return;
+    }
+    log->end += log->len;
+    log->len = 0;
+}
+
+int xcdn_log_sync(xcdn_log_t *log) {
+    if (!log) return -1;
+    if (log->synced == log->records || log->error) return log->error;
+    log_write_out(log);
+    if (!log->error && fflush(log->f) != 0) log->error = -1;
+#ifdef XCDN_LOG_POSIX
+    if (!log->error && fsync(fileno(log->f)) != 0) log->error = -1;
+#endif
+    if (!log->error) log->synced = log->records;
+    return log->error;
+}
+
+int xcdn_log_append(xcdn_log_t *log, const xcdn_node_t *node) {
+    if (!log || !node || log->error) return -1;
+    size_t n;
+    char *text = xcdn_node_to_string(node, xcdn_format_compact(), &n);
+    if (!text) return -1;
+    /*
+     * Compact text escapes newlines everywhere except in the echoed
+     * source of lazily decoded bytes, where base64 ignores whitespace.
+     */
+    for (char *p = text; (p = (char *)memchr(p, '\n', n - (size_t)(p - text)));)
+        *p = ' ';
+
+    if (log->len + n + 1 > log->cap) {
+        size_t cap = log->cap ? log->cap : log->opts.buffer;
+        while (cap < log->len + n + 1) cap *= 2;
+        char *buf = (char *)realloc(log->buf, cap);
+        if (!buf) {
+            free(text);
+            return -1;
+        }
+        log->buf = buf;
+        log->cap = cap;
+    }
+    uint64_t at = log->end + log->len;
+    memcpy(log->buf + log->len, text, n);
+    log->buf[log->len + n] = '\n';
+    log->len += n + 1;
+    free(text);
+    index_note(log->opts.index, log->records, at);
+
+    uint64_t pending = ++log->records - log->synced;
+    int64_t now = 0;
+    if (log->opts.sync_ms) {
+        now = now_ms();
+        if (pending == 1) log->since = now;
+    }
+    if (log->len >= log->opts.buffer) log_write_out(log);
+    if ((log->opts.sync_every && pending >= log->opts.sync_every) ||
+        (log->opts.sync_ms && now - log->since >= (int64_t)log->opts.sync_ms))
+        xcdn_log_sync(log);
+    return log->error;
+}
+
+uint64_t xcdn_log_records(const xcdn_log_t *log) {
+    return log ? log->records : 0;
+}
+
+uint64_t xcdn_log_synced(const xcdn_log_t *log) {
+    return log ? log->synced : 0;
+}
+
+int xcdn_log_close(xcdn_log_t *log) {
+    if (!log) return -1;
+    int rc = xcdn_log_sync(log);
+    if (fclose(log->f) != 0 && rc == 0) rc = -1;
+    free(log->buf);
+    free(log);
+    return rc;
+}
@@ -0,0 +1,133 @@
+/*
+ * xCDN - eXtensible Cognitive Data Notation (C implementation)
+ * Append-only record log.
+ *
+ * A log file is an xCDN stream document holding one top-level value per
+ * line in compact form (compact text has no raw newlines), so the whole
+ * file also parses with xcdn_parse().
+ *
+ * The writer buffers appended records and commits them in groups: the
+ * buffer is written and synced to disk once `sync_every` records are
+ * pending, or when the oldest pending record is `sync_ms` old (checked on
+ * each append; call xcdn_log_sync() when a burst ends). Opening an
+ * existing log drops a torn final record left by a crash.
+ *
+ *   xcdn_log_t *log = xcdn_log_open("events.xcdn", xcdn_log_options_default());
+ *   xcdn_log_append(log, node);
+ *   xcdn_log_close(log);
+ *
+ *   xcdn_log_reader_t *r = xcdn_log_reader_open("events.xcdn", opts, NULL);
+ *   while (xcdn_log_next(r, &doc, &err) == XCDN_LOG_OK) { ... }
+ *   xcdn_log_reader_close(r);
+ *
+ * A sparse index (the offset of every n-th record) can be filled by the
+ * writer or the reader and used to seek to a record without parsing
+ * what comes before it.
+ *
+ * MIT License
+ */
+
+#ifndef XCDN_LOG_H
+#define XCDN_LOG_H
+
+#include "ast.h"
+#include "parser.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ── Sparse index ─────────────────────────────────────────────────────── */
+
+typedef struct {
+    uint64_t  every;     /* records between entries */
+    uint64_t *offsets;   /* offsets[i]: byte offset of record i * every */
+    size_t    len;
+    size_t    cap;
+} xcdn_log_index_t;
+
+/* Start an empty index with one entry every `every` records (0 = 1). */
+void xcdn_log_index_init(xcdn_log_index_t *index, uint64_t every);
+
+void xcdn_log_index_free(xcdn_log_index_t *index);
+
+/* ── Writer ───────────────────────────────────────────────────────────── */
+
+typedef struct {
+    size_t            sync_every;  /* commit after this many records (0 = no limit) */
+    unsigned          sync_ms;     /* commit when the oldest pending record is this old (0 = no limit) */
+    size_t            buffer;      /* pending bytes written out early, unsynced (default 64 KiB) */
+    xcdn_log_index_t *index;       /* filled with existing and appended records */
+} xcdn_log_options_t;
+
+/* Returns the default options (1024 records, 10 ms, 64 KiB, no index). */
+xcdn_log_options_t xcdn_log_options_default(void);
+
+typedef struct xcdn_log xcdn_log_t;
+
+/*
+ * Open a log for appending, creating it if needed. A torn final record
+ * is truncated away first (where the platform can truncate files).
+ * Returns NULL on error.
+ */
+xcdn_log_t *xcdn_log_open(const char *path, xcdn_log_options_t opts);
+
+/* Append a node (decorations and value) as the next record. Returns 0 or -1. */
+int xcdn_log_append(xcdn_log_t *log, const xcdn_node_t *node);
+
+/* Write and sync every pending record now. Returns 0 or -1. */
+int xcdn_log_sync(xcdn_log_t *log);
+
+/* Records in the log, and how many of them have been synced. */
+uint64_t xcdn_log_records(const xcdn_log_t *log);
+uint64_t xcdn_log_synced(const xcdn_log_t *log);
+
+/* Sync, close and free the log. Returns 0 or the first error (-1). */
+int xcdn_log_close(xcdn_log_t *log);
+
+/* ── Reader ───────────────────────────────────────────────────────────── */
+
+typedef enum {
+    XCDN_LOG_OK = 0,
+    XCDN_LOG_END,          /* no more records */
+    XCDN_LOG_TORN,         /* final record incomplete or unreadable; ignored */
+    XCDN_LOG_CORRUPT,      /* unreadable record followed by more data */
+    XCDN_LOG_ERR_IO,
+    XCDN_LOG_ERR_NOMEM,
+} xcdn_log_status_t;
+
+typedef struct xcdn_log_reader xcdn_log_reader_t;
+
+/*
+ * Open a log for reading. If `index` is non-NULL, entries for the
+ * records read are added to it as they are reached.
+ * Returns NULL on error.
+ */
+xcdn_log_reader_t *xcdn_log_reader_open(const char *path,
+                                        xcdn_parse_options_t opts,
+                                        xcdn_log_index_t *index);
+
+/*
+ * Next record as a document (usually one value; caller frees it).
+ * Statuses other than XCDN_LOG_OK are sticky. On XCDN_LOG_CORRUPT, *err
+ * holds the parser's error.
+ */
+xcdn_log_status_t xcdn_log_next(xcdn_log_reader_t *r, xcdn_document_t **doc,
+                                xcdn_error_t *err);
+
+/* Number of the next record to be read. */
+uint64_t xcdn_log_reader_record(const xcdn_log_reader_t *r);
+
+/* Offset just past the last record read (the valid length so far). */
+uint64_t xcdn_log_reader_offset(const xcdn_log_reader_t *r);
+
+/*
+ * Position the reader at `record`, starting from the closest index entry
+ * (or the start of the log) and skipping the records after it unparsed.
+ * Returns 0, or -1 if the log has fewer records.
+ */
+int xcdn_log_reader_seek(xcdn_log_reader_t *r, const xcdn_log_index_t *index,
+                         uint64_t record);
+
+void xcdn_log_reader_close(xcdn_log_reader_t *r);
+
+#endif /* XCDN_LOG_H */
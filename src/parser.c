@@ -7,62 +7,14 @@
 
 #include "parser.h"
 #include "lexer.h"
+#include "spans.h"
+#include "base64.h"
+#include "strpool.h"
+#include "shape.h"
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 
-/* ── Base64 decoder ───────────────────────────────────────────────────── */
-
-static const unsigned char b64_table[256] = {
-    ['A']=0,['B']=1,['C']=2,['D']=3,['E']=4,['F']=5,['G']=6,['H']=7,
-    ['I']=8,['J']=9,['K']=10,['L']=11,['M']=12,['N']=13,['O']=14,['P']=15,
-    ['Q']=16,['R']=17,['S']=18,['T']=19,['U']=20,['V']=21,['W']=22,['X']=23,
-    ['Y']=24,['Z']=25,
-    ['a']=26,['b']=27,['c']=28,['d']=29,['e']=30,['f']=31,['g']=32,['h']=33,
-    ['i']=34,['j']=35,['k']=36,['l']=37,['m']=38,['n']=39,['o']=40,['p']=41,
-    ['q']=42,['r']=43,['s']=44,['t']=45,['u']=46,['v']=47,['w']=48,['x']=49,
-    ['y']=50,['z']=51,
-    ['0']=52,['1']=53,['2']=54,['3']=55,['4']=56,['5']=57,['6']=58,['7']=59,
-    ['8']=60,['9']=61,
-    ['+']=62,['/']=63,
-    ['-']=62,['_']=63, /* URL-safe variants */
-};
-
-static int is_b64_char(unsigned char c) {
-    return isalnum(c) || c == '+' || c == '/' || c == '-' || c == '_' || c == '=';
-}
-
-static uint8_t *decode_base64(const char *input, size_t in_len, size_t *out_len) {
-    /* Strip padding */
-    while (in_len > 0 && input[in_len - 1] == '=') in_len--;
-
-    size_t max_out = (in_len * 3) / 4 + 3;
-    uint8_t *out = (uint8_t *)malloc(max_out);
-    if (!out) return NULL;
-
-    size_t o = 0;
-    uint32_t accum = 0;
-    int bits = 0;
-
-    for (size_t i = 0; i < in_len; i++) {
-        unsigned char c = (unsigned char)input[i];
-        if (c == '=' || c == ' ' || c == '\n' || c == '\r') continue;
-        if (!is_b64_char(c)) {
-            free(out);
-            return NULL;
-        }
-        accum = (accum << 6) | b64_table[c];
-        bits += 6;
-        if (bits >= 8) {
-            bits -= 8;
-            out[o++] = (uint8_t)((accum >> bits) & 0xFF);
-        }
-    }
-
-    *out_len = o;
-    return out;
-}
-
 /* ── UUID validation ──────────────────────────────────────────────────── */
 
 static int validate_uuid(const char *s) {
@@ -80,11 +32,124 @@ static int validate_uuid(const char *s) {
     return 1;
 }
 
-/* ── Helper to get current span from lexer ────────────────────────────── */
+/* ── Pipelined token source ───────────────────────────────────────────── */
+
+/*
+ * In pipelined mode a helper thread runs the lexer ahead of the parser and
+ * hands tokens over through a bounded single-producer/single-consumer ring.
+ * Token strings are heap-owned, so ownership simply moves with the token.
+ * A lexer error travels as a final EOF token plus the error itself.
+ */
+
+#if !defined(__STDC_NO_THREADS__) && !defined(__STDC_NO_ATOMICS__)
+#define XCDN_PARSE_THREADS 1
+#include <threads.h>
+#include <stdatomic.h>
+#include <stdalign.h>
+
+#define RING_CAP 1024   /* power of two */
+
+typedef struct {
+    alignas(64) atomic_size_t head;   /* next slot to pop (consumer) */
+    alignas(64) atomic_size_t tail;   /* next slot to fill (producer) */
+    alignas(64) atomic_int    stop;   /* consumer gave up; producer exits */
+    xcdn_lexer_t  lex;
+    xcdn_error_state_t err;           /* set before the final EOF token */
+    int           failed;             /* final token carries err */
+    size_t        cached_head;        /* producer's view of head */
+    size_t        cached_tail;        /* consumer's view of tail */
+    int           done;               /* consumer saw the final token */
+    thrd_t        thread;
+    xcdn_token_t  slots[RING_CAP];
+    size_t        ends[RING_CAP];     /* source offset after each token */
+} token_ring_t;
+
+static int ring_lexer_main(void *arg) {
+    token_ring_t *r = (token_ring_t *)arg;
+    size_t tail = 0;
+    for (;;) {
+        xcdn_token_t t = xcdn_lexer_scan(&r->lex, &r->err);
+        if (r->err.kind != XCDN_ERR_NONE) {
+            r->failed = 1;
+            t.type = XCDN_TOK_EOF;
+        }
+        while (tail - r->cached_head >= RING_CAP) {
+            if (atomic_load_explicit(&r->stop, memory_order_relaxed)) {
+                xcdn_token_free(&t);
+                return 0;
+            }
+            r->cached_head = atomic_load_explicit(&r->head,
+                                                  memory_order_acquire);
+            if (tail - r->cached_head >= RING_CAP) thrd_yield();
+        }
+        r->slots[tail & (RING_CAP - 1)] = t;
+        r->ends[tail & (RING_CAP - 1)] = r->lex.idx;
+        atomic_store_explicit(&r->tail, ++tail, memory_order_release);
+        if (t.type == XCDN_TOK_EOF) return 0;
+    }
+}
+
+static token_ring_t *ring_start(const char *src, size_t src_len,
+                                const xcdn_parse_options_t *opts) {
+    token_ring_t *r = (token_ring_t *)aligned_alloc(alignof(token_ring_t),
+                                                    sizeof(token_ring_t));
+    if (!r) return NULL;
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+    atomic_init(&r->stop, 0);
+    xcdn_lexer_init(&r->lex, src, src_len);
+    r->lex.strict_utf8 = opts->validate_utf8;
+    r->lex.raw_numbers = opts->raw_numbers;
+    r->err = xcdn_error_state_none();
+    r->failed = 0;
+    r->cached_head = 0;
+    r->cached_tail = 0;
+    r->done = 0;
+    if (thrd_create(&r->thread, ring_lexer_main, r) != thrd_success) {
+        free(r);
+        return NULL;
+    }
+    return r;
+}
+
+static xcdn_token_t ring_pop(token_ring_t *r, size_t *end,
+                             xcdn_error_state_t *err) {
+    xcdn_token_t t;
+    if (r->done) {
+        memset(&t, 0, sizeof(t));
+        t.type = XCDN_TOK_EOF;
+        *end = r->lex.src_len;
+        return t;
+    }
+    size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    while (head == r->cached_tail) {
+        r->cached_tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+        if (head == r->cached_tail) thrd_yield();
+    }
+    t = r->slots[head & (RING_CAP - 1)];
+    *end = r->ends[head & (RING_CAP - 1)];
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+    if (t.type == XCDN_TOK_EOF) {
+        r->done = 1;
+        if (r->failed) {
+            *err = r->err;   /* the parser takes over the detail string */
+            r->err = xcdn_error_state_none();
+        }
+    }
+    return t;
+}
 
-static xcdn_span_t parser_span(const xcdn_lexer_t *lex) {
-    return xcdn_span_new(lex->idx, lex->line, lex->col);
+static void ring_finish(token_ring_t *r) {
+    atomic_store(&r->stop, 1);
+    thrd_join(r->thread, NULL);
+    size_t head = atomic_load(&r->head);
+    size_t tail = atomic_load(&r->tail);
+    for (; head != tail; head++)
+        xcdn_token_free(&r->slots[head & (RING_CAP - 1)]);
+    xcdn_error_state_clear(&r->err);
+    free(r);
 }
+#endif
 
 /* ── Parser state ─────────────────────────────────────────────────────── */
 
@@ -92,41 +157,111 @@ typedef struct {
     xcdn_lexer_t  lex;
     xcdn_token_t  look;
     int           has_look;
-    xcdn_error_t  err;
+    size_t        look_end;   /* source offset after the lookahead */
+    size_t        last_end;   /* source offset after the last bumped token */
+    xcdn_error_state_t err;
+    xcdn_span_table_t *spans; /* node spans are recorded when non-NULL */
+    bool          lazy_bytes;
+    xcdn_strpool_t *pool;     /* string values are deduplicated when non-NULL */
+    size_t        pool_max;   /* longest string that is pooled */
+    xcdn_shape_table_t *shapes; /* braced objects are shaped when non-NULL */
+    bool          dup_keys;   /* a duplicate key replaced an earlier entry */
+#ifdef XCDN_PARSE_THREADS
+    token_ring_t *ring;   /* non-NULL in pipelined mode */
+#endif
 } parser_t;
 
-static void parser_init(parser_t *p, const char *src, size_t src_len) {
+static void parser_init(parser_t *p, const char *src, size_t src_len,
+                        const xcdn_parse_options_t *opts) {
     xcdn_lexer_init(&p->lex, src, src_len);
+    p->lex.strict_utf8 = opts->validate_utf8;
+    p->lex.raw_numbers = opts->raw_numbers;
     memset(&p->look, 0, sizeof(p->look));
     p->has_look = 0;
-    p->err = xcdn_error_none();
+    p->look_end = 0;
+    p->last_end = 0;
+    p->err = xcdn_error_state_none();
+    p->spans = NULL;
+    p->lazy_bytes = opts->lazy_bytes;
+    p->pool = opts->dedup_strings ? xcdn_strpool_new() : NULL;
+    p->pool_max = opts->dedup_strings;
+    p->shapes = opts->shape_objects ? xcdn_shape_table_new() : NULL;
+    p->dup_keys = false;
+#ifdef XCDN_PARSE_THREADS
+    p->ring = opts->pipelined ? ring_start(src, src_len, opts)
+                              : NULL;
+#else
+    (void)opts;
+#endif
+}
+
+static void parser_finish(parser_t *p) {
+    if (p->has_look) xcdn_token_free(&p->look);
+    p->has_look = 0;
+    xcdn_strpool_free(p->pool);   /* values keep their own references */
+    p->pool = NULL;
+    xcdn_shape_table_free(p->shapes);   /* objects keep their own references */
+    p->shapes = NULL;
+#ifdef XCDN_PARSE_THREADS
+    if (p->ring) ring_finish(p->ring);
+    p->ring = NULL;
+#endif
+}
+
+static xcdn_token_t parser_next_token(parser_t *p, size_t *end) {
+#ifdef XCDN_PARSE_THREADS
+    if (p->ring) return ring_pop(p->ring, end, &p->err);
+#endif
+    xcdn_token_t t = xcdn_lexer_scan(&p->lex, &p->err);
+    *end = p->lex.idx;
+    return t;
+}
+
+static int parser_failed(const parser_t *p) {
+    return p->err.kind != XCDN_ERR_NONE;
+}
+
+/* ── Helper to get current span ───────────────────────────────────────── */
+
+static xcdn_span_t parser_span(const parser_t *p) {
+#ifdef XCDN_PARSE_THREADS
+    /* The lexer runs ahead on its own thread; report the lookahead. */
+    if (p->ring) return p->look.span;
+#endif
+    return xcdn_span_new(p->lex.idx, p->lex.line, p->lex.col);
 }
 
 static xcdn_token_t parser_bump(parser_t *p) {
     if (p->has_look) {
         xcdn_token_t t = p->look;
         p->has_look = 0;
+        p->last_end = p->look_end;
         memset(&p->look, 0, sizeof(p->look));
         return t;
     }
-    return xcdn_lexer_next(&p->lex, &p->err);
+    return parser_next_token(p, &p->last_end);
 }
 
 static xcdn_token_type_t parser_peek_type(parser_t *p) {
     if (!p->has_look) {
-        p->look = xcdn_lexer_next(&p->lex, &p->err);
+        p->look = parser_next_token(p, &p->look_end);
         p->has_look = 1;
     }
     return p->look.type;
 }
 
+static void parser_fail_expected(parser_t *p, xcdn_span_t span,
+                                 const char *expected, xcdn_token_type_t found) {
+    xcdn_error_state_set(&p->err, XCDN_ERR_EXPECTED, XCDN_MSG_EXPECTED, span);
+    p->err.arg = expected;
+    p->err.arg2 = xcdn_token_type_str(found);
+}
+
 static xcdn_token_t parser_expect(parser_t *p, xcdn_token_type_t kind,
                                   const char *expected) {
     xcdn_token_t t = parser_bump(p);
     if (t.type != kind) {
-        p->err = xcdn_error_new(XCDN_ERR_EXPECTED, t.span,
-                                "expected %s, found %s", expected,
-                                xcdn_token_type_str(t.type));
+        parser_fail_expected(p, t.span, expected, t.type);
         xcdn_token_free(&t);
         xcdn_token_t empty;
         memset(&empty, 0, sizeof(empty));
@@ -149,30 +284,68 @@ static char *parse_ident_string(parser_t *p) {
     if (t.type == XCDN_TOK_IDENT) {
         return t.data.string_val.str; /* Caller owns the string */
     }
-    p->err = xcdn_error_new(XCDN_ERR_EXPECTED, t.span,
-                            "expected identifier, found %s",
-                            xcdn_token_type_str(t.type));
+    parser_fail_expected(p, t.span, "identifier", t.type);
     xcdn_token_free(&t);
     return NULL;
 }
 
-static char *parse_key(parser_t *p) {
+/* XCDN_FLAG_* string metadata of an identifier or string token. */
+static uint32_t token_string_flags(const xcdn_token_t *t) {
+    return XCDN_FLAG_SCANNED |
+           ((t->flags & XCDN_TOKF_ASCII) ? XCDN_FLAG_ASCII : 0) |
+           ((t->flags & XCDN_TOKF_PLAIN) ? XCDN_FLAG_PLAIN : 0) |
+           ((t->flags & XCDN_TOKF_IDENT) ? XCDN_FLAG_IDENT : 0);
+}
+
+static char *parse_key(parser_t *p, size_t *len, uint32_t *flags) {
     xcdn_token_t t = parser_bump(p);
     if (t.type == XCDN_TOK_IDENT || t.type == XCDN_TOK_STRING) {
+        *len = t.data.string_val.len;
+        *flags = token_string_flags(&t);
         return t.data.string_val.str; /* Caller owns the string */
     }
-    p->err = xcdn_error_new(XCDN_ERR_EXPECTED, t.span,
-                            "expected object key, found %s",
-                            xcdn_token_type_str(t.type));
+    parser_fail_expected(p, t.span, "object key", t.type);
     xcdn_token_free(&t);
     return NULL;
 }
 
+/*
+ * Insert into an object being parsed, taking ownership of the key from
+ * parse_key(). A duplicate key replaces (and frees) the earlier node in
+ * its slot, so its recorded spans must go first, and the entries are no
+ * longer in source order.
+ */
+static void parser_object_set(parser_t *p, xcdn_value_t *obj, char *key,
+                              size_t key_len, uint32_t key_flags,
+                              xcdn_node_t *node) {
+    if (p->spans) {
+        xcdn_node_t *old = xcdn_object_get(obj, key);
+        if (old) {
+            p->dup_keys = true;
+            xcdn_span_table_remove_tree(p->spans, old);
+        }
+    }
+    xcdn_object_set_scanned(obj, key, key_len, key_flags, node);
+}
+
+/*
+ * Value sharing the pooled copy of a string-typed token, or NULL if the
+ * string is not pooled (deduplication off, or outside the size range).
+ */
+static xcdn_value_t *parser_pooled_value(parser_t *p, xcdn_value_type_t type,
+                                         const xcdn_token_t *t) {
+    size_t len = t->data.string_val.len;
+    if (!p->pool || len < XCDN_SSO_CAP || len > p->pool_max) return NULL;
+    char *text = xcdn_strpool_intern(p->pool, t->data.string_val.str, len);
+    if (!text) return NULL;
+    return xcdn_value_string_pooled(type, text, len, token_string_flags(t));
+}
+
 /* ── Parse value ──────────────────────────────────────────────────────── */
 
 static xcdn_value_t *parse_value(parser_t *p) {
     xcdn_token_t t = parser_bump(p);
-    if (xcdn_error_is_set(&p->err)) {
+    if (parser_failed(p)) {
         xcdn_token_free(&t);
         return NULL;
     }
@@ -190,7 +363,14 @@ static xcdn_value_t *parse_value(parser_t *p) {
 
         case XCDN_TOK_STRING:
         case XCDN_TOK_TRIPLE_STRING:
-            val = xcdn_value_string_owned(t.data.string_val.str);
+            val = parser_pooled_value(p, XCDN_VAL_STRING, &t);
+            if (val) {
+                xcdn_token_free(&t);
+                break;
+            }
+            val = xcdn_value_string_scanned(t.data.string_val.str,
+                                            t.data.string_val.len,
+                                            token_string_flags(&t));
             t.data.string_val.str = NULL; /* ownership transferred */
             break;
 
@@ -207,11 +387,15 @@ static xcdn_value_t *parse_value(parser_t *p) {
             break;
 
         case XCDN_TOK_INT:
-            val = xcdn_value_int(t.data.int_val);
-            break;
-
         case XCDN_TOK_FLOAT:
-            val = xcdn_value_float(t.data.float_val);
+            if (t.flags & XCDN_TOKF_RAW)
+                val = xcdn_value_number_raw(p->lex.src + t.span.offset,
+                                            t.data.string_val.len,
+                                            t.type == XCDN_TOK_FLOAT);
+            else if (t.type == XCDN_TOK_INT)
+                val = xcdn_value_int(t.data.int_val);
+            else
+                val = xcdn_value_float(t.data.float_val);
             break;
 
         case XCDN_TOK_D_QUOTED:
@@ -222,36 +406,53 @@ static xcdn_value_t *parse_value(parser_t *p) {
 
         case XCDN_TOK_B_QUOTED: {
             size_t decoded_len = 0;
-            uint8_t *decoded = decode_base64(t.data.string_val.str,
-                                             t.data.string_val.len,
-                                             &decoded_len);
-            if (!decoded) {
-                p->err = xcdn_error_new(XCDN_ERR_INVALID_BASE64, t.span,
-                                        "invalid base64: %s",
-                                        t.data.string_val.str);
+            uint8_t *decoded = NULL;
+            bool valid;
+            if (p->lazy_bytes) {
+                valid = xcdn_base64_measure(t.data.string_val.str,
+                                            t.data.string_val.len, &decoded_len);
+            } else {
+                decoded = xcdn_base64_decode(t.data.string_val.str,
+                                             t.data.string_val.len, &decoded_len);
+                valid = decoded != NULL;
+            }
+            if (!valid) {
+                xcdn_error_state_set(&p->err, XCDN_ERR_INVALID_BASE64,
+                                     XCDN_MSG_INVALID_BASE64, t.span);
+                xcdn_error_state_detail(&p->err, t.data.string_val.str,
+                                        t.data.string_val.len);
                 xcdn_token_free(&t);
                 return NULL;
             }
-            val = xcdn_value_bytes_owned(decoded, decoded_len);
+            if (p->lazy_bytes) {
+                val = xcdn_value_bytes_base64(t.data.string_val.str,
+                                              t.data.string_val.len, decoded_len);
+                t.data.string_val.str = NULL; /* ownership transferred */
+            } else {
+                val = xcdn_value_bytes_owned(decoded, decoded_len);
+            }
             xcdn_token_free(&t);
             break;
         }
 
         case XCDN_TOK_U_QUOTED:
             if (!validate_uuid(t.data.string_val.str)) {
-                p->err = xcdn_error_new(XCDN_ERR_INVALID_UUID, t.span,
-                                        "invalid UUID: %s",
-                                        t.data.string_val.str);
+                xcdn_error_state_set(&p->err, XCDN_ERR_INVALID_UUID,
+                                     XCDN_MSG_INVALID_UUID, t.span);
+                xcdn_error_state_detail(&p->err, t.data.string_val.str,
+                                        t.data.string_val.len);
                 xcdn_token_free(&t);
                 return NULL;
             }
-            val = xcdn_value_uuid(t.data.string_val.str);
+            val = parser_pooled_value(p, XCDN_VAL_UUID, &t);
+            if (!val) val = xcdn_value_uuid(t.data.string_val.str);
             xcdn_token_free(&t);
             break;
 
         case XCDN_TOK_T_QUOTED:
             /* Store datetime as string; validation is lenient */
-            val = xcdn_value_datetime(t.data.string_val.str);
+            val = parser_pooled_value(p, XCDN_VAL_DATETIME, &t);
+            if (!val) val = xcdn_value_datetime(t.data.string_val.str);
             xcdn_token_free(&t);
             break;
 
@@ -262,9 +463,7 @@ static xcdn_value_t *parse_value(parser_t *p) {
             break;
 
         default:
-            p->err = xcdn_error_new(XCDN_ERR_EXPECTED, t.span,
-                                    "expected value, found %s",
-                                    xcdn_token_type_str(t.type));
+            parser_fail_expected(p, t.span, "value", t.type);
             xcdn_token_free(&t);
             return NULL;
     }
@@ -278,7 +477,7 @@ static xcdn_value_t *parse_object(parser_t *p) {
     xcdn_value_t *obj = xcdn_value_object();
 
     for (;;) {
-        if (xcdn_error_is_set(&p->err)) {
+        if (parser_failed(p)) {
             xcdn_value_free(obj);
             return NULL;
         }
@@ -288,30 +487,31 @@ static xcdn_value_t *parse_object(parser_t *p) {
             break;
         }
 
-        char *key = parse_key(p);
-        if (!key || xcdn_error_is_set(&p->err)) {
+        size_t key_len = 0;
+        uint32_t key_flags = 0;
+        char *key = parse_key(p, &key_len, &key_flags);
+        if (!key || parser_failed(p)) {
             free(key);
             xcdn_value_free(obj);
             return NULL;
         }
 
         parser_expect(p, XCDN_TOK_COLON, ":");
-        if (xcdn_error_is_set(&p->err)) {
+        if (parser_failed(p)) {
             free(key);
             xcdn_value_free(obj);
             return NULL;
         }
 
         xcdn_node_t *node = parse_node(p);
-        if (!node || xcdn_error_is_set(&p->err)) {
+        if (!node || parser_failed(p)) {
             free(key);
             xcdn_node_free(node);
             xcdn_value_free(obj);
             return NULL;
         }
 
-        xcdn_object_set(obj, key, node);
-        free(key);
+        parser_object_set(p, obj, key, key_len, key_flags, node);
 
         /* Optional comma */
         if (parser_peek_type(p) == XCDN_TOK_COMMA) {
@@ -320,6 +520,7 @@ static xcdn_value_t *parse_object(parser_t *p) {
         }
     }
 
+    if (p->shapes) xcdn_object_intern_shape(obj, p->shapes);
     return obj;
 }
 
@@ -329,7 +530,7 @@ static xcdn_value_t *parse_array(parser_t *p) {
     xcdn_value_t *arr = xcdn_value_array();
 
     for (;;) {
-        if (xcdn_error_is_set(&p->err)) {
+        if (parser_failed(p)) {
             xcdn_value_free(arr);
             return NULL;
         }
@@ -340,7 +541,7 @@ static xcdn_value_t *parse_array(parser_t *p) {
         }
 
         xcdn_node_t *node = parse_node(p);
-        if (!node || xcdn_error_is_set(&p->err)) {
+        if (!node || parser_failed(p)) {
             xcdn_node_free(node);
             xcdn_value_free(arr);
             return NULL;
@@ -363,14 +564,14 @@ static xcdn_value_t *parse_array(parser_t *p) {
 static xcdn_node_t *parse_node(parser_t *p) {
     xcdn_node_t *node = xcdn_node_new(NULL);
     if (!node) {
-        p->err = xcdn_error_new(XCDN_ERR_OUT_OF_MEMORY, parser_span(&p->lex),
-                                "out of memory");
+        xcdn_error_state_set(&p->err, XCDN_ERR_OUT_OF_MEMORY,
+                             XCDN_MSG_OUT_OF_MEMORY, parser_span(p));
         return NULL;
     }
 
     /* Gather decorations: @annotations and #tags */
     for (;;) {
-        if (xcdn_error_is_set(&p->err)) {
+        if (parser_failed(p)) {
             xcdn_node_free(node);
             return NULL;
         }
@@ -380,7 +581,7 @@ static xcdn_node_t *parse_node(parser_t *p) {
         if (pk == XCDN_TOK_AT) {
             parser_bump(p); /* consume @ */
             char *name = parse_ident_string(p);
-            if (!name || xcdn_error_is_set(&p->err)) {
+            if (!name || parser_failed(p)) {
                 free(name);
                 xcdn_node_free(node);
                 return NULL;
@@ -399,7 +600,7 @@ static xcdn_node_t *parse_node(parser_t *p) {
                 } else {
                     for (;;) {
                         xcdn_value_t *v = parse_value(p);
-                        if (!v || xcdn_error_is_set(&p->err)) {
+                        if (!v || parser_failed(p)) {
                             xcdn_value_free(v);
                             xcdn_node_free(node);
                             return NULL;
@@ -415,9 +616,8 @@ static xcdn_node_t *parse_node(parser_t *p) {
                             break;
                         } else {
                             xcdn_token_t bad = parser_bump(p);
-                            p->err = xcdn_error_new(XCDN_ERR_EXPECTED, bad.span,
-                                "expected \",\" or \")\", found %s",
-                                xcdn_token_type_str(bad.type));
+                            parser_fail_expected(p, bad.span,
+                                                 "\",\" or \")\"", bad.type);
                             xcdn_token_free(&bad);
                             xcdn_node_free(node);
                             return NULL;
@@ -428,7 +628,7 @@ static xcdn_node_t *parse_node(parser_t *p) {
         } else if (pk == XCDN_TOK_HASH) {
             parser_bump(p); /* consume # */
             char *name = parse_ident_string(p);
-            if (!name || xcdn_error_is_set(&p->err)) {
+            if (!name || parser_failed(p)) {
                 free(name);
                 xcdn_node_free(node);
                 return NULL;
@@ -440,14 +640,21 @@ static xcdn_node_t *parse_node(parser_t *p) {
         }
     }
 
+    size_t start = p->look.span.offset;
     xcdn_value_t *val = parse_value(p);
-    if (!val || xcdn_error_is_set(&p->err)) {
+    if (!val || parser_failed(p)) {
         xcdn_value_free(val);
         xcdn_node_free(node);
         return NULL;
     }
 
     node->value = val;
+    if (p->spans && !xcdn_span_table_set(p->spans, node, start, p->last_end)) {
+        xcdn_error_state_set(&p->err, XCDN_ERR_OUT_OF_MEMORY,
+                             XCDN_MSG_OUT_OF_MEMORY, parser_span(p));
+        xcdn_node_free(node);
+        return NULL;
+    }
     return node;
 }
 
@@ -456,35 +663,35 @@ static xcdn_node_t *parse_node(parser_t *p) {
 static xcdn_document_t *parse_document(parser_t *p) {
     xcdn_document_t *doc = xcdn_document_new();
     if (!doc) {
-        p->err = xcdn_error_new(XCDN_ERR_OUT_OF_MEMORY, parser_span(&p->lex),
-                                "out of memory");
+        xcdn_error_state_set(&p->err, XCDN_ERR_OUT_OF_MEMORY,
+                             XCDN_MSG_OUT_OF_MEMORY, parser_span(p));
         return NULL;
     }
 
     /* Optional prolog: sequence of $ident : value separated by commas */
     while (parser_peek_type(p) == XCDN_TOK_DOLLAR) {
-        if (xcdn_error_is_set(&p->err)) {
+        if (parser_failed(p)) {
             xcdn_document_free(doc);
             return NULL;
         }
 
         parser_bump(p); /* consume $ */
         char *name = parse_ident_string(p);
-        if (!name || xcdn_error_is_set(&p->err)) {
+        if (!name || parser_failed(p)) {
             free(name);
             xcdn_document_free(doc);
             return NULL;
         }
 
         parser_expect(p, XCDN_TOK_COLON, ":");
-        if (xcdn_error_is_set(&p->err)) {
+        if (parser_failed(p)) {
             free(name);
             xcdn_document_free(doc);
             return NULL;
         }
 
         xcdn_node_t *value_node = parse_node(p);
-        if (!value_node || xcdn_error_is_set(&p->err)) {
+        if (!value_node || parser_failed(p)) {
             free(name);
             xcdn_node_free(value_node);
             xcdn_document_free(doc);
@@ -494,6 +701,7 @@ static xcdn_document_t *parse_document(parser_t *p) {
         xcdn_document_push_directive(doc, name, value_node->value);
         /* Transfer ownership: detach value from node before freeing node shell */
         value_node->value = NULL;
+        if (p->spans) xcdn_span_table_remove(p->spans, value_node);
         xcdn_node_free(value_node);
         free(name);
 
@@ -524,19 +732,19 @@ static xcdn_document_t *parse_document(parser_t *p) {
             key_tok.data.string_val.str = NULL;
 
             xcdn_node_t *first_node = parse_node(p);
-            if (!first_node || xcdn_error_is_set(&p->err)) {
+            if (!first_node || parser_failed(p)) {
                 free(first_key);
                 xcdn_node_free(first_node);
                 xcdn_value_free(obj);
                 xcdn_document_free(doc);
                 return NULL;
             }
-            xcdn_object_set(obj, first_key, first_node);
-            free(first_key);
+            parser_object_set(p, obj, first_key, key_tok.data.string_val.len,
+                              token_string_flags(&key_tok), first_node);
 
             /* Subsequent entries until EOF */
             for (;;) {
-                if (xcdn_error_is_set(&p->err)) {
+                if (parser_failed(p)) {
                     xcdn_value_free(obj);
                     xcdn_document_free(doc);
                     return NULL;
@@ -547,37 +755,36 @@ static xcdn_document_t *parse_document(parser_t *p) {
                     xcdn_token_t comma = parser_bump(p);
                     xcdn_token_free(&comma);
                 } else if (pk == XCDN_TOK_IDENT || pk == XCDN_TOK_STRING) {
-                    char *key = parse_key(p);
-                    if (!key || xcdn_error_is_set(&p->err)) {
+                    size_t key_len = 0;
+                    uint32_t key_flags = 0;
+                    char *key = parse_key(p, &key_len, &key_flags);
+                    if (!key || parser_failed(p)) {
                         free(key);
                         xcdn_value_free(obj);
                         xcdn_document_free(doc);
                         return NULL;
                     }
                     parser_expect(p, XCDN_TOK_COLON, ":");
-                    if (xcdn_error_is_set(&p->err)) {
+                    if (parser_failed(p)) {
                         free(key);
                         xcdn_value_free(obj);
                         xcdn_document_free(doc);
                         return NULL;
                     }
                     xcdn_node_t *n = parse_node(p);
-                    if (!n || xcdn_error_is_set(&p->err)) {
+                    if (!n || parser_failed(p)) {
                         free(key);
                         xcdn_node_free(n);
                         xcdn_value_free(obj);
                         xcdn_document_free(doc);
                         return NULL;
                     }
-                    xcdn_object_set(obj, key, n);
-                    free(key);
+                    parser_object_set(p, obj, key, key_len, key_flags, n);
                 } else if (pk == XCDN_TOK_EOF) {
                     break;
                 } else {
                     xcdn_token_t bad = parser_bump(p);
-                    p->err = xcdn_error_new(XCDN_ERR_EXPECTED, bad.span,
-                        "expected object key, found %s",
-                        xcdn_token_type_str(bad.type));
+                    parser_fail_expected(p, bad.span, "object key", bad.type);
                     xcdn_token_free(&bad);
                     xcdn_value_free(obj);
                     xcdn_document_free(doc);
@@ -585,7 +792,9 @@ static xcdn_document_t *parse_document(parser_t *p) {
                 }
             }
 
+            /* The implicit object has no braces and no span of its own. */
             xcdn_node_t *obj_node = xcdn_node_new(obj);
+            if (p->spans) xcdn_span_table_remove(p->spans, obj_node);
             xcdn_document_push_value(doc, obj_node);
         } else {
             /*
@@ -600,15 +809,22 @@ static xcdn_document_t *parse_document(parser_t *p) {
              * a STRING, wrap it. Otherwise error.
              */
             if (key_tok.type == XCDN_TOK_STRING) {
-                xcdn_value_t *sv = xcdn_value_string_owned(key_tok.data.string_val.str);
+                xcdn_value_t *sv = xcdn_value_string_scanned(
+                    key_tok.data.string_val.str, key_tok.data.string_val.len,
+                    token_string_flags(&key_tok));
                 key_tok.data.string_val.str = NULL;
                 xcdn_node_t *sn = xcdn_node_new(sv);
+                if (p->spans)
+                    xcdn_span_table_set(p->spans, sn, key_tok.span.offset,
+                                        p->last_end);
                 xcdn_document_push_value(doc, sn);
             } else {
                 /* An ident not followed by : in top-level is an error */
-                p->err = xcdn_error_new(XCDN_ERR_EXPECTED, key_tok.span,
-                    "expected ':' after top-level key '%s'",
-                    key_tok.data.string_val.str ? key_tok.data.string_val.str : "?");
+                xcdn_error_state_set(&p->err, XCDN_ERR_EXPECTED,
+                                     XCDN_MSG_TOP_LEVEL_COLON, key_tok.span);
+                if (key_tok.data.string_val.str)
+                    xcdn_error_state_detail(&p->err, key_tok.data.string_val.str,
+                                            key_tok.data.string_val.len);
                 xcdn_token_free(&key_tok);
                 xcdn_document_free(doc);
                 return NULL;
@@ -616,12 +832,12 @@ static xcdn_document_t *parse_document(parser_t *p) {
 
             /* Continue parsing more values */
             while (parser_peek_type(p) != XCDN_TOK_EOF) {
-                if (xcdn_error_is_set(&p->err)) {
+                if (parser_failed(p)) {
                     xcdn_document_free(doc);
                     return NULL;
                 }
                 xcdn_node_t *n = parse_node(p);
-                if (!n || xcdn_error_is_set(&p->err)) {
+                if (!n || parser_failed(p)) {
                     xcdn_node_free(n);
                     xcdn_document_free(doc);
                     return NULL;
@@ -635,7 +851,7 @@ static xcdn_document_t *parse_document(parser_t *p) {
     } else {
         /* Stream of values */
         xcdn_node_t *first = parse_node(p);
-        if (!first || xcdn_error_is_set(&p->err)) {
+        if (!first || parser_failed(p)) {
             xcdn_node_free(first);
             xcdn_document_free(doc);
             return NULL;
@@ -643,12 +859,12 @@ static xcdn_document_t *parse_document(parser_t *p) {
         xcdn_document_push_value(doc, first);
 
         while (parser_peek_type(p) != XCDN_TOK_EOF) {
-            if (xcdn_error_is_set(&p->err)) {
+            if (parser_failed(p)) {
                 xcdn_document_free(doc);
                 return NULL;
             }
             xcdn_node_t *n = parse_node(p);
-            if (!n || xcdn_error_is_set(&p->err)) {
+            if (!n || parser_failed(p)) {
                 xcdn_node_free(n);
                 xcdn_document_free(doc);
                 return NULL;
@@ -662,20 +878,475 @@ static xcdn_document_t *parse_document(parser_t *p) {
 
 /* ── Public API ───────────────────────────────────────────────────────── */
 
-xcdn_document_t *xcdn_parse_str(const char *src, size_t src_len,
-                                xcdn_error_t *err) {
+xcdn_parse_options_t xcdn_parse_options_default(void) {
+    xcdn_parse_options_t o;
+    memset(&o, 0, sizeof(o));
+    return o;
+}
+
+/*
+ * Parse a whole text. With spans recorded, *dup_keys (if non-NULL) tells
+ * whether a duplicate key replaced an entry, leaving an object whose
+ * entries are out of source order.
+ */
+static xcdn_document_t *parse_source(const char *src, size_t src_len,
+                                     const xcdn_parse_options_t *opts,
+                                     bool *dup_keys, xcdn_error_t *err) {
     parser_t p;
-    parser_init(&p, src, src_len);
-    xcdn_document_t *doc = parse_document(&p);
-    if (xcdn_error_is_set(&p.err)) {
-        if (err) *err = p.err;
+    parser_init(&p, src, src_len, opts);
+    if (opts->record_spans && !(p.spans = xcdn_span_table_new()))
+        xcdn_error_state_set(&p.err, XCDN_ERR_OUT_OF_MEMORY,
+                             XCDN_MSG_OUT_OF_MEMORY, xcdn_span_start());
+    xcdn_document_t *doc = parser_failed(&p) ? NULL
+                                             : parse_document(&p);
+    parser_finish(&p);
+    if (p.spans && !parser_failed(&p) &&
+        !xcdn_span_table_index_lines(p.spans, src, src_len))
+        xcdn_error_state_set(&p.err, XCDN_ERR_OUT_OF_MEMORY,
+                             XCDN_MSG_OUT_OF_MEMORY, xcdn_span_start());
+    /* The message text is only built here, once, for the caller. */
+    if (parser_failed(&p)) {
+        xcdn_error_state_export(&p.err, err);
         xcdn_document_free(doc);
+        xcdn_span_table_free(p.spans);
         return NULL;
     }
+    doc->spans = p.spans;
+    if (dup_keys) *dup_keys = p.dup_keys;
+    if (opts->share_subtrees) xcdn_document_share_subtrees(doc);
     if (err) *err = xcdn_error_none();
     return doc;
 }
 
+xcdn_document_t *xcdn_parse_str_with_options(const char *src, size_t src_len,
+                                             xcdn_parse_options_t opts,
+                                             xcdn_error_t *err) {
+    return parse_source(src, src_len, &opts, NULL, err);
+}
+
+xcdn_document_t *xcdn_parse_str(const char *src, size_t src_len,
+                                xcdn_error_t *err) {
+    return xcdn_parse_str_with_options(src, src_len,
+                                       xcdn_parse_options_default(), err);
+}
+
 xcdn_document_t *xcdn_parse(const char *src, xcdn_error_t *err) {
     return xcdn_parse_str(src, strlen(src), err);
 }
+
+/* ── Incremental reparsing ────────────────────────────────────────────── */
+
+/*
+ * The session keeps the text and a document parsed with node spans. An
+ * edit is first tried as a splice: find the deepest array/object whose
+ * brackets enclose the edit, re-parse only the entries the edit touches
+ * (each entry owns the text from the end of the previous entry up to its
+ * own end), and swap them in. Anything unusual falls back to a full parse.
+ *
+ * Finding entries by offset needs every container's children in source
+ * order. A duplicate key breaks that (the later value takes the earlier
+ * entry's slot), so such a document is only ever reparsed in full.
+ */
+
+struct xcdn_incr {
+    char                 *src;
+    size_t                len;
+    size_t                cap;
+    xcdn_parse_options_t  opts;
+    xcdn_document_t      *doc;      /* NULL while the text does not parse */
+    xcdn_node_t         **changed;
+    size_t                changed_len;
+    size_t                changed_cap;
+    xcdn_node_t          *changed_parent;
+    bool                  unordered; /* duplicate keys broke source order */
+};
+
+static size_t child_count(const xcdn_value_t *v) {
+    if (!v) return 0;
+    if (v->type == XCDN_VAL_ARRAY) return v->data.array.len;
+    if (v->type == XCDN_VAL_OBJECT) return v->data.object.len;
+    return 0;
+}
+
+static xcdn_node_t *child_at(const xcdn_value_t *v, size_t i) {
+    return v->type == XCDN_VAL_ARRAY ? v->data.array.items[i]
+                                     : *xcdn_object_slot(v, i);
+}
+
+/*
+ * Number of leading children of `v` whose span ends before `pos`
+ * (or at it, when `inclusive`). Returns SIZE_MAX if a child has no span.
+ */
+static size_t children_ending_before(const xcdn_span_table_t *t,
+                                     const xcdn_value_t *v, size_t pos,
+                                     int inclusive) {
+    size_t lo = 0, hi = child_count(v);
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2, e;
+        if (!xcdn_span_table_get(t, child_at(v, mid), NULL, &e)) return SIZE_MAX;
+        if (e < pos || (inclusive && e == pos)) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static int encloses(const xcdn_span_table_t *t, const xcdn_node_t *n,
+                    size_t a, size_t b) {
+    size_t s, e;
+    if (!n || !n->value) return 0;
+    if (n->value->type != XCDN_VAL_ARRAY && n->value->type != XCDN_VAL_OBJECT)
+        return 0;
+    if (!xcdn_span_table_get(t, n, &s, &e)) return 0;
+    return s < a && b < e;
+}
+
+/* Deepest container node whose brackets strictly enclose [a, b]. */
+static xcdn_node_t *incr_find_container(const xcdn_document_t *doc,
+                                        size_t a, size_t b) {
+    const xcdn_span_table_t *t = doc->spans;
+    xcdn_node_t *found = NULL;
+    const xcdn_value_t *level = NULL;
+
+    for (size_t i = 0; i < doc->values_len; i++) {
+        xcdn_node_t *n = doc->values[i];
+        if (encloses(t, n, a, b)) {
+            found = n;
+            level = n->value;
+            break;
+        }
+        /* The implicit top-level object has no span; look inside it. */
+        if (doc->values_len == 1 && n->value &&
+            n->value->type == XCDN_VAL_OBJECT &&
+            !xcdn_span_table_get(t, n, NULL, NULL))
+            level = n->value;
+    }
+
+    while (level) {
+        size_t i = children_ending_before(t, level, a, 0);
+        if (i >= child_count(level)) break;
+        xcdn_node_t *child = child_at(level, i);
+        if (!encloses(t, child, a, b)) break;
+        found = child;
+        level = child->value;
+    }
+    return found;
+}
+
+/* Start of the first token at or after `pos`, and its end. */
+static int next_token_at(const char *src, size_t len, size_t pos,
+                         size_t *start, size_t *end) {
+    xcdn_lexer_t lex;
+    xcdn_error_state_t e = xcdn_error_state_none();
+    xcdn_lexer_init(&lex, src, len);
+    lex.idx = pos;
+    xcdn_token_t t = xcdn_lexer_scan(&lex, &e);
+    xcdn_token_free(&t);
+    if (e.kind != XCDN_ERR_NONE) {
+        xcdn_error_state_clear(&e);
+        return 0;
+    }
+    *start = t.span.offset;
+    *end = lex.idx;
+    return 1;
+}
+
+/*
+ * Parse a run of object entries or array elements into `into`. Each entry
+ * may be followed by one comma; `after_entry` says whether the run starts
+ * right after an earlier entry.
+ */
+static int parse_entries(parser_t *p, xcdn_value_t *into, int after_entry) {
+    int is_object = into->type == XCDN_VAL_OBJECT;
+    for (;;) {
+        if (parser_failed(p)) return 0;
+        xcdn_token_type_t pk = parser_peek_type(p);
+        if (pk == XCDN_TOK_EOF) break;
+        if (pk == XCDN_TOK_COMMA) {
+            if (!after_entry) return 0;
+            xcdn_token_t comma = parser_bump(p);
+            xcdn_token_free(&comma);
+            after_entry = 0;
+            continue;
+        }
+        after_entry = 1;
+        char *key = NULL;
+        size_t key_len = 0;
+        uint32_t key_flags = 0;
+        if (is_object) {
+            key = parse_key(p, &key_len, &key_flags);
+            if (key && !parser_failed(p))
+                parser_expect(p, XCDN_TOK_COLON, ":");
+            if (!key || parser_failed(p)) {
+                free(key);
+                return 0;
+            }
+        }
+        xcdn_node_t *node = parse_node(p);
+        if (!node || parser_failed(p) ||
+            (key && xcdn_object_has(into, key))) {
+            free(key);
+            xcdn_node_free(node);
+            return 0;
+        }
+        if (is_object) xcdn_object_set_scanned(into, key, key_len, key_flags, node);
+        else xcdn_array_push(into, node);
+    }
+    return 1;
+}
+
+static int incr_note_changed(xcdn_incr_t *inc, xcdn_node_t *node) {
+    if (inc->changed_len >= inc->changed_cap) {
+        size_t new_cap = (inc->changed_cap == 0) ? 16 : inc->changed_cap * 2;
+        xcdn_node_t **nc = (xcdn_node_t **)realloc(inc->changed,
+                                                   new_cap * sizeof(*nc));
+        if (!nc) return 0;
+        inc->changed = nc;
+        inc->changed_cap = new_cap;
+    }
+    inc->changed[inc->changed_len++] = node;
+    return 1;
+}
+
+/*
+ * Re-parse only the entries of `cnode` touched by the edit of old range
+ * [a, b] (text already updated, shifting what follows by `delta`).
+ * Returns 1 on success; 0 leaves the document untouched.
+ */
+static int incr_splice(xcdn_incr_t *inc, xcdn_node_t *cnode, size_t a,
+                       size_t b, ptrdiff_t delta) {
+    xcdn_span_table_t *t = inc->doc->spans;
+    xcdn_value_t *v = cnode->value;
+    int is_object = v->type == XCDN_VAL_OBJECT;
+    size_t n = child_count(v);
+    size_t cs, ce;
+    if (!xcdn_span_table_get(t, cnode, &cs, &ce)) return 0;
+
+    /* Children f..k-1 are affected, plus child k or the closing gap. */
+    size_t f = children_ending_before(t, v, a, 0);
+    size_t k = children_ending_before(t, v, b, 1);
+    if (f == SIZE_MAX || k == SIZE_MAX) return 0;
+    /* The search above trusts source order; check it where it matters. */
+    for (size_t i = f > 0 ? f - 1 : 0, prev = cs; i < n && i <= k; i++) {
+        size_t s, e;
+        if (!xcdn_span_table_get(t, child_at(v, i), &s, &e) || s < prev)
+            return 0;
+        prev = e;
+    }
+    size_t r0 = cs + 1, r1 = ce - 1, m = 0;
+    if (f > 0) xcdn_span_table_get(t, child_at(v, f - 1), NULL, &r0);
+    if (k < n) {
+        xcdn_span_table_get(t, child_at(v, k), NULL, &r1);
+        m = k - f + 1;
+    } else {
+        m = n - f;
+    }
+    size_t region_end = (size_t)((ptrdiff_t)r1 + delta);
+
+    /* Parse the region on its own */
+    xcdn_parse_options_t seq = inc->opts;
+    seq.pipelined = false;
+    parser_t p;
+    parser_init(&p, inc->src, region_end, &seq);
+    p.lex.idx = r0;
+    p.last_end = r0;
+    p.spans = xcdn_span_table_new();
+    xcdn_value_t *fresh = is_object ? xcdn_value_object() : xcdn_value_array();
+    int ok = p.spans && fresh && parse_entries(&p, fresh, f > 0);
+    size_t last_end = p.last_end;
+    parser_finish(&p);
+    xcdn_error_state_clear(&p.err);   /* errors just mean "fall back" */
+
+    /*
+     * The region must lex the same way inside the full text: no token may
+     * run on past the region's last token, and whatever follows it
+     * (comments, whitespace) must lead to the same next token.
+     */
+    size_t tok_s, tok_e = r0, next_s, other_s;
+    while (ok && tok_e < last_end)
+        ok = next_token_at(inc->src, inc->len, tok_e, &tok_s, &tok_e) &&
+             tok_e <= last_end;
+    ok = ok && next_token_at(inc->src, inc->len, last_end, &next_s, &tok_e) &&
+         next_token_at(inc->src, inc->len, region_end, &other_s, &tok_e) &&
+         next_s == other_s;
+
+    /* Keys must stay unique across the splice */
+    for (size_t i = 0; ok && is_object && i < child_count(fresh); i++) {
+        const char *key = xcdn_entry_key(&fresh->data.object.entries[i]);
+        for (size_t j = 0; j < n; j++) {
+            if (j >= f && j < f + m) continue;
+            if (strcmp(xcdn_entry_key(&v->data.object.entries[j]), key) == 0) {
+                ok = 0;
+                break;
+            }
+        }
+    }
+
+    size_t q = child_count(fresh);
+    size_t new_len = n - m + q;
+    size_t *capp = is_object ? &v->data.object.cap : &v->data.array.cap;
+    size_t elem = is_object ? sizeof(xcdn_object_entry_t) : sizeof(xcdn_node_t *);
+    void **itemsp = is_object ? (void **)&v->data.object.entries
+                              : (void **)&v->data.array.items;
+    if (ok && new_len > *capp) {
+        void *grown = realloc(*itemsp, new_len * elem);
+        if (grown) {
+            *itemsp = grown;
+            *capp = new_len;
+        } else {
+            ok = 0;
+        }
+    }
+    if (!ok) {
+        xcdn_value_free(fresh);
+        xcdn_span_table_free(p.spans);
+        return 0;
+    }
+
+    /* Drop the old entries, open the gap, move the new ones in */
+    for (size_t i = f; i < f + m; i++) {
+        xcdn_node_t *old = child_at(v, i);
+        xcdn_span_table_remove_tree(t, old);
+        if (is_object && !XCDN_KEY_INLINE(v->data.object.entries[i].key_len))
+            free(v->data.object.entries[i].key_heap);
+        xcdn_node_free(old);
+    }
+    char *base = (char *)*itemsp;
+    if (n > f + m)
+        memmove(base + (f + q) * elem, base + (f + m) * elem,
+                (n - f - m) * elem);
+    void *fresh_items = is_object ? (void *)fresh->data.object.entries
+                                  : (void *)fresh->data.array.items;
+    if (q > 0) memcpy(base + f * elem, fresh_items, q * elem);
+    if (is_object) v->data.object.len = new_len;
+    else v->data.array.len = new_len;
+
+    xcdn_span_table_shift(t, r1, delta);
+    ok = xcdn_span_table_merge(t, p.spans);
+    xcdn_span_table_free(p.spans);
+
+    inc->changed_parent = cnode;
+    for (size_t i = f; i < f + q; i++)
+        ok = ok && incr_note_changed(inc, child_at(v, i));
+
+    /* The new nodes now belong to `v`; free only the shell. */
+    if (is_object) fresh->data.object.len = 0;
+    else fresh->data.array.len = 0;
+    xcdn_value_free(fresh);
+    return ok ? 1 : -1;
+}
+
+static int incr_full_parse(xcdn_incr_t *inc, xcdn_error_t *err) {
+    xcdn_document_free(inc->doc);
+    inc->doc = parse_source(inc->src, inc->len, &inc->opts, &inc->unordered,
+                            err);
+    inc->changed_parent = NULL;
+    if (!inc->doc) return 0;
+    for (size_t i = 0; i < inc->doc->values_len; i++) {
+        if (!incr_note_changed(inc, inc->doc->values[i])) {
+            if (err) *err = xcdn_error_new(XCDN_ERR_OUT_OF_MEMORY,
+                                           xcdn_span_start(), "out of memory");
+            return 0;
+        }
+    }
+    return 1;
+}
+
+xcdn_incr_t *xcdn_incr_new(const char *src, size_t src_len,
+                           xcdn_parse_options_t opts, xcdn_error_t *err) {
+    xcdn_incr_t *inc = (xcdn_incr_t *)calloc(1, sizeof(xcdn_incr_t));
+    if (!inc) return NULL;
+    inc->cap = src_len + 1;
+    inc->src = (char *)malloc(inc->cap);
+    if (!inc->src) {
+        free(inc);
+        return NULL;
+    }
+    memcpy(inc->src, src, src_len);
+    inc->src[src_len] = '\0';
+    inc->len = src_len;
+    inc->opts = opts;
+    inc->opts.record_spans = true;
+    inc->opts.share_subtrees = false;
+    inc->opts.shape_objects = false;
+    incr_full_parse(inc, err);
+    return inc;
+}
+
+const xcdn_document_t *xcdn_incr_edit(xcdn_incr_t *inc, size_t offset,
+                                      size_t removed, const char *text,
+                                      size_t text_len, xcdn_error_t *err) {
+    if (!inc) return NULL;
+    if (offset > inc->len || removed > inc->len - offset) {
+        if (err) *err = xcdn_error_new(XCDN_ERR_MESSAGE, xcdn_span_start(),
+                                       "edit range %zu+%zu outside text of %zu bytes",
+                                       offset, removed, inc->len);
+        return NULL;
+    }
+
+    /* Apply the edit to the text */
+    size_t new_len = inc->len - removed + text_len;
+    if (new_len + 1 > inc->cap) {
+        size_t new_cap = inc->cap * 2 > new_len + 1 ? inc->cap * 2 : new_len + 1;
+        char *grown = (char *)realloc(inc->src, new_cap);
+        if (!grown) {
+            if (err) *err = xcdn_error_new(XCDN_ERR_OUT_OF_MEMORY,
+                                           xcdn_span_start(), "out of memory");
+            return NULL;
+        }
+        inc->src = grown;
+        inc->cap = new_cap;
+    }
+    memmove(inc->src + offset + text_len, inc->src + offset + removed,
+            inc->len - offset - removed + 1);
+    if (text_len > 0) memcpy(inc->src + offset, text, text_len);
+    inc->len = new_len;
+    inc->changed_len = 0;
+    inc->changed_parent = NULL;
+
+    ptrdiff_t delta = (ptrdiff_t)text_len - (ptrdiff_t)removed;
+    if (inc->doc && !inc->unordered) {
+        xcdn_node_t *cnode = incr_find_container(inc->doc, offset,
+                                                 offset + removed);
+        int rc = cnode ? incr_splice(inc, cnode, offset, offset + removed, delta)
+                       : 0;
+        /* The text moved already, so re-indexing lines costs no more. */
+        if (rc == 1 && xcdn_span_table_index_lines(inc->doc->spans, inc->src,
+                                                   inc->len)) {
+            if (err) *err = xcdn_error_none();
+            return inc->doc;
+        }
+        inc->changed_len = 0;
+    }
+    return incr_full_parse(inc, err) ? inc->doc : NULL;
+}
+
+const xcdn_document_t *xcdn_incr_document(const xcdn_incr_t *inc) {
+    return inc ? inc->doc : NULL;
+}
+
+const char *xcdn_incr_text(const xcdn_incr_t *inc, size_t *len) {
+    if (!inc) return NULL;
+    if (len) *len = inc->len;
+    return inc->src;
+}
+
+size_t xcdn_incr_changed_count(const xcdn_incr_t *inc) {
+    return inc ? inc->changed_len : 0;
+}
+
+const xcdn_node_t *xcdn_incr_changed_at(const xcdn_incr_t *inc, size_t i) {
+    if (!inc || i >= inc->changed_len) return NULL;
+    return inc->changed[i];
+}
+
+const xcdn_node_t *xcdn_incr_changed_parent(const xcdn_incr_t *inc) {
+    return inc ? inc->changed_parent : NULL;
+}
+
+void xcdn_incr_free(xcdn_incr_t *inc) {
+    if (!inc) return;
+    xcdn_document_free(inc->doc);
+    free(inc->changed);
+    free(inc->src);
+    free(inc);
+}
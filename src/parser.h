@@ -17,6 +17,62 @@
 #include "ast.h"
 #include "error.h"
 #include <stddef.h>
+#include <stdbool.h>
+
+/* Parsing options. */
+typedef struct {
+    /*
+     * Run the lexer on a helper thread that tokenizes ahead into a bounded
+     * lock-free ring while this thread builds the tree. Worth it for large
+     * single documents; ignored when C11 threads are unavailable.
+     */
+    bool pipelined;
+    /*
+     * Record each node's start/end offsets in a side table on the document
+     * so xcdn_node_span() can report line and column after parsing.
+     */
+    bool record_spans;
+    /*
+     * Reject string content that is not valid UTF-8, reporting the exact
+     * position of the offending sequence (XCDN_ERR_INVALID_UTF8).
+     */
+    bool validate_utf8;
+    /*
+     * Keep b"..." payloads as their base64 text, checked but not decoded;
+     * xcdn_value_as_bytes() decodes on first access and serialization
+     * writes the original text back.
+     */
+    bool lazy_bytes;
+    /*
+     * Keep numbers as their source text instead of converting them:
+     * xcdn_value_as_int()/_as_float() convert on first access and
+     * serialization echoes the text byte-for-byte. Out-of-range numbers
+     * are accepted and round-trip unchanged.
+     */
+    bool raw_numbers;
+    /*
+     * Share one immutable buffer between equal string, UUID and datetime
+     * values of at most this many bytes (0 = off). Strings shorter than
+     * XCDN_SSO_CAP are already stored inline and are not pooled.
+     */
+    size_t dedup_strings;
+    /*
+     * Run xcdn_document_share_subtrees() on the result, so repeated
+     * subtrees are stored once and shared (frozen) between their parents.
+     * Ignored by incremental sessions, which edit nodes in place.
+     */
+    bool share_subtrees;
+    /*
+     * Store braced objects through shared shapes: objects with the same
+     * keys in the same order keep one copy of the keys and a slot array of
+     * nodes (see xcdn_object_intern_shape). Saves memory on arrays of
+     * records. Ignored by incremental sessions.
+     */
+    bool shape_objects;
+} xcdn_parse_options_t;
+
+/* Returns the default options (everything off). */
+xcdn_parse_options_t xcdn_parse_options_default(void);
 
 /*
  * Parse a full xCDN document from a string.
@@ -26,10 +82,67 @@
 xcdn_document_t *xcdn_parse_str(const char *src, size_t src_len,
                                 xcdn_error_t *err);
 
+/*
+ * Parse a full xCDN document with explicit options.
+ * Returns a heap-allocated Document, or NULL on error.
+ */
+xcdn_document_t *xcdn_parse_str_with_options(const char *src, size_t src_len,
+                                             xcdn_parse_options_t opts,
+                                             xcdn_error_t *err);
+
 /*
  * Parse a full xCDN document from a NUL-terminated string.
  * Convenience wrapper over xcdn_parse_str.
  */
 xcdn_document_t *xcdn_parse(const char *src, xcdn_error_t *err);
 
+/* ── Incremental reparsing ────────────────────────────────────────────── */
+
+/*
+ * An incremental session owns a copy of the source text and the document
+ * parsed from it. Text edits re-parse only the entries of the innermost
+ * array or object that the edit touches and splice them into the existing
+ * tree; nodes outside that range keep their addresses. Edits that change
+ * the structure around them fall back to a full reparse.
+ *
+ * The session owns the document: do not modify or free it.
+ */
+typedef struct xcdn_incr xcdn_incr_t;
+
+/*
+ * Start a session over `src`. Returns NULL only on allocation failure;
+ * if the text does not parse, *err is set and the document is NULL until
+ * an edit makes it valid again.
+ */
+xcdn_incr_t *xcdn_incr_new(const char *src, size_t src_len,
+                           xcdn_parse_options_t opts, xcdn_error_t *err);
+
+/*
+ * Replace `removed` bytes at `offset` with `text` and bring the document
+ * up to date. Returns the document, or NULL (with *err set) if the edited
+ * text does not parse or the range is out of bounds; in the latter case
+ * the text is left unchanged.
+ */
+const xcdn_document_t *xcdn_incr_edit(xcdn_incr_t *inc, size_t offset,
+                                      size_t removed, const char *text,
+                                      size_t text_len, xcdn_error_t *err);
+
+/* Current document, or NULL while the text does not parse. */
+const xcdn_document_t *xcdn_incr_document(const xcdn_incr_t *inc);
+
+/* Current text (NUL-terminated); its length is stored in *len if given. */
+const char *xcdn_incr_text(const xcdn_incr_t *inc, size_t *len);
+
+/*
+ * Nodes created by the last edit. After a splice these are the new
+ * children of xcdn_incr_changed_parent(); after a full reparse the parent
+ * is NULL and the nodes are the document's top-level values.
+ */
+size_t xcdn_incr_changed_count(const xcdn_incr_t *inc);
+const xcdn_node_t *xcdn_incr_changed_at(const xcdn_incr_t *inc, size_t i);
+const xcdn_node_t *xcdn_incr_changed_parent(const xcdn_incr_t *inc);
+
+/* Free the session and its document (NULL-safe). */
+void xcdn_incr_free(xcdn_incr_t *inc);
+
 #endif /* XCDN_PARSER_H */
@@ -15,16 +15,26 @@
 
 /* ── String buffer ────────────────────────────────────────────────────── */
 
+/* A literal run referenced in place, to be spliced in at offset `at`. */
+typedef struct {
+    size_t      at;
+    const char *data;
+    size_t      len;
+} sbuf_ref_t;
+
 typedef struct {
     char  *buf;
     size_t len;
     size_t cap;
+    /* Gather mode (xcdn_to_iovec): runs of at least ref_min bytes */
+    sbuf_ref_t *refs;
+    size_t      refs_len;
+    size_t      refs_cap;
+    size_t      ref_min;   /* 0: always copy */
 } sbuf_t;
 
 static void sbuf_init(sbuf_t *sb) {
-    sb->buf = NULL;
-    sb->len = 0;
-    sb->cap = 0;
+    memset(sb, 0, sizeof(*sb));
 }
 
 static void sbuf_ensure(sbuf_t *sb, size_t extra) {
@@ -43,11 +53,44 @@ static void sbuf_push_char(sbuf_t *sb, char c) {
     sb->buf[sb->len++] = c;
 }
 
+static void sbuf_push_mem(sbuf_t *sb, const char *s, size_t n) {
+    sbuf_ensure(sb, n);
+    memcpy(sb->buf + sb->len, s, n);
+    sb->len += n;
+}
+
 static void sbuf_push_str(sbuf_t *sb, const char *s) {
-    size_t slen = strlen(s);
-    sbuf_ensure(sb, slen);
-    memcpy(sb->buf + sb->len, s, slen);
-    sb->len += slen;
+    sbuf_push_mem(sb, s, strlen(s));
+}
+
+/*
+ * Literal text from the document: referenced instead of copied when
+ * gathering and the run is long enough (copied if the list cannot grow).
+ */
+static bool sbuf_copies(const sbuf_t *sb, size_t n) {
+    return sb->ref_min == 0 || n < sb->ref_min;
+}
+
+static void sbuf_push_ref(sbuf_t *sb, const char *s, size_t n) {
+    if (sbuf_copies(sb, n)) {
+        sbuf_push_mem(sb, s, n);
+        return;
+    }
+    if (sb->refs_len == sb->refs_cap) {
+        size_t new_cap = sb->refs_cap ? sb->refs_cap * 2 : 16;
+        sbuf_ref_t *refs =
+            (sbuf_ref_t *)realloc(sb->refs, new_cap * sizeof(sbuf_ref_t));
+        if (!refs) {
+            sbuf_push_mem(sb, s, n);
+            return;
+        }
+        sb->refs = refs;
+        sb->refs_cap = new_cap;
+    }
+    sbuf_ref_t *r = &sb->refs[sb->refs_len++];
+    r->at = sb->len;
+    r->data = s;
+    r->len = n;
 }
 
 static void sbuf_push_fmt(sbuf_t *sb, const char *fmt, ...) {
@@ -120,10 +163,18 @@ static void write_indent(sbuf_t *sb, int depth, int space) {
     for (int i = 0; i < n; i++) sbuf_push_char(sb, ' ');
 }
 
+static int needs_escape(unsigned char ch) {
+    return ch < 32 || ch == '"' || ch == '\\';
+}
+
 static void write_escaped_string(sbuf_t *sb, const char *s) {
     sbuf_push_char(sb, '"');
     if (s) {
         for (size_t i = 0; s[i]; i++) {
+            size_t run = i;
+            while (s[i] && !needs_escape((unsigned char)s[i])) i++;
+            if (i > run) sbuf_push_ref(sb, s + run, i - run);
+            if (!s[i]) break;
             unsigned char ch = (unsigned char)s[i];
             switch (ch) {
                 case '\\': sbuf_push_str(sb, "\\\\"); break;
@@ -132,11 +183,7 @@ static void write_escaped_string(sbuf_t *sb, const char *s) {
                 case '\r': sbuf_push_str(sb, "\\r"); break;
                 case '\t': sbuf_push_str(sb, "\\t"); break;
                 default:
-                    if (ch < 32) {
-                        sbuf_push_fmt(sb, "\\u%04X", ch);
-                    } else {
-                        sbuf_push_char(sb, (char)ch);
-                    }
+                    sbuf_push_fmt(sb, "\\u%04X", ch);
                     break;
             }
         }
@@ -144,20 +191,70 @@ static void write_escaped_string(sbuf_t *sb, const char *s) {
     sbuf_push_char(sb, '"');
 }
 
-static void write_key(sbuf_t *sb, const char *k) {
-    if (is_simple_ident(k)) {
+/*
+ * Strings and keys whose metadata was recorded when they were lexed or
+ * constructed (XCDN_FLAG_SCANNED) skip the per-byte checks: plain ones
+ * are copied straight into the buffer.
+ */
+#define SCANNED_PLAIN (XCDN_FLAG_SCANNED | XCDN_FLAG_PLAIN)
+
+static void write_string(sbuf_t *sb, const char *s, size_t len, uint32_t flags) {
+    if ((flags & SCANNED_PLAIN) == SCANNED_PLAIN) {
+        /* A referenced run takes no room in the buffer */
+        if (sbuf_copies(sb, len)) sbuf_ensure(sb, len + 2);
+        sbuf_push_char(sb, '"');
+        sbuf_push_ref(sb, s, len);
+        sbuf_push_char(sb, '"');
+    } else {
+        write_escaped_string(sb, s);
+    }
+}
+
+static void write_key_text(sbuf_t *sb, const char *k, size_t len, uint32_t flags) {
+    if (flags & XCDN_FLAG_SCANNED) {
+        if (flags & XCDN_FLAG_IDENT)
+            sbuf_push_mem(sb, k, len);
+        else
+            write_string(sb, k, len, flags);
+    } else if (is_simple_ident(k)) {
         sbuf_push_str(sb, k);
     } else {
         write_escaped_string(sb, k);
     }
 }
 
+static void write_key(sbuf_t *sb, const xcdn_object_entry_t *e) {
+    write_key_text(sb, xcdn_entry_key(e), e->key_len, e->key_flags);
+}
+
+/* Typed string literal such as d"..." (payload is written unescaped). */
+static void write_typed_text(sbuf_t *sb, char prefix, const char *s, size_t len) {
+    sbuf_push_char(sb, prefix);
+    sbuf_push_char(sb, '"');
+    sbuf_push_ref(sb, s, len);
+    sbuf_push_char(sb, '"');
+}
+
+static void write_typed(sbuf_t *sb, char prefix, const xcdn_value_t *val) {
+    const char *s = val->data.string ? val->data.string : "";
+    write_typed_text(sb, prefix, s, (val->flags & XCDN_FLAG_SCANNED)
+                                        ? val->data.string_len : strlen(s));
+}
+
+static void write_float(sbuf_t *sb, double d) {
+    char tmp[64];
+    snprintf(tmp, sizeof(tmp), "%g", d);
+    sbuf_push_str(sb, tmp);
+}
+
 /* ── Forward declarations ─────────────────────────────────────────────── */
 
 static void write_node(sbuf_t *sb, const xcdn_node_t *node,
                        xcdn_format_t fmt, int depth);
 static void write_value(sbuf_t *sb, const xcdn_value_t *val,
                         xcdn_format_t fmt, int depth);
+static void write_items(sbuf_t *sb, const xcdn_value_t *val,
+                        xcdn_format_t fmt, int depth, size_t from, size_t to);
 
 /* ── Write annotation ─────────────────────────────────────────────────── */
 
@@ -196,81 +293,58 @@ static void write_value(sbuf_t *sb, const xcdn_value_t *val,
             break;
 
         case XCDN_VAL_INT:
-            sbuf_push_fmt(sb, "%" PRId64, val->data.integer);
-            break;
-
         case XCDN_VAL_FLOAT: {
-            char tmp[64];
-            snprintf(tmp, sizeof(tmp), "%g", val->data.floating);
-            sbuf_push_str(sb, tmp);
+            /* Numbers parsed with `raw_numbers` echo their source text */
+            size_t len = 0;
+            const char *text = xcdn_value_number_text(val, &len);
+            if (text) {
+                sbuf_push_mem(sb, text, len);
+            } else if (val->type == XCDN_VAL_INT) {
+                sbuf_push_fmt(sb, "%" PRId64, val->data.integer);
+            } else {
+                write_float(sb, val->data.floating);
+            }
             break;
         }
 
         case XCDN_VAL_DECIMAL:
-            sbuf_push_str(sb, "d\"");
-            sbuf_push_str(sb, val->data.string ? val->data.string : "");
-            sbuf_push_char(sb, '"');
+            write_typed(sb, 'd', val);
             break;
 
         case XCDN_VAL_STRING:
-            write_escaped_string(sb, val->data.string);
+            write_string(sb, val->data.string, val->data.string_len, val->flags);
             break;
 
         case XCDN_VAL_BYTES:
             sbuf_push_str(sb, "b\"");
-            b64_encode(sb, val->data.bytes.data, val->data.bytes.len);
+            if (val->data.bytes.encoded)   /* lazy: echo the original text */
+                sbuf_push_ref(sb, val->data.bytes.encoded, val->data.bytes.encoded_len);
+            else
+                b64_encode(sb, val->data.bytes.data, val->data.bytes.len);
             sbuf_push_char(sb, '"');
             break;
 
         case XCDN_VAL_DATETIME:
-            sbuf_push_str(sb, "t\"");
-            sbuf_push_str(sb, val->data.string ? val->data.string : "");
-            sbuf_push_char(sb, '"');
+            write_typed(sb, 't', val);
             break;
 
         case XCDN_VAL_DURATION:
-            sbuf_push_str(sb, "r\"");
-            sbuf_push_str(sb, val->data.string ? val->data.string : "");
-            sbuf_push_char(sb, '"');
+            write_typed(sb, 'r', val);
             break;
 
         case XCDN_VAL_UUID:
-            sbuf_push_str(sb, "u\"");
-            sbuf_push_str(sb, val->data.string ? val->data.string : "");
-            sbuf_push_char(sb, '"');
+            write_typed(sb, 'u', val);
             break;
 
-        case XCDN_VAL_ARRAY: {
-            sbuf_push_char(sb, '[');
-            size_t len = val->data.array.len;
-            if (fmt.pretty && len > 0) sbuf_push_char(sb, '\n');
-            for (size_t i = 0; i < len; i++) {
-                if (fmt.pretty) write_indent(sb, depth + 1, fmt.indent);
-                write_node(sb, val->data.array.items[i], fmt, depth + 1);
-                if (i + 1 < len || fmt.trailing_commas)
-                    sbuf_push_char(sb, ',');
-                if (fmt.pretty) sbuf_push_char(sb, '\n');
-            }
-            if (fmt.pretty && len > 0) write_indent(sb, depth, fmt.indent);
-            sbuf_push_char(sb, ']');
-            break;
-        }
-
+        case XCDN_VAL_ARRAY:
         case XCDN_VAL_OBJECT: {
-            sbuf_push_char(sb, '{');
-            size_t len = val->data.object.len;
+            int is_array = val->type == XCDN_VAL_ARRAY;
+            size_t len = is_array ? val->data.array.len : val->data.object.len;
+            sbuf_push_char(sb, is_array ? '[' : '{');
             if (fmt.pretty && len > 0) sbuf_push_char(sb, '\n');
-            for (size_t i = 0; i < len; i++) {
-                if (fmt.pretty) write_indent(sb, depth + 1, fmt.indent);
-                write_key(sb, val->data.object.entries[i].key);
-                sbuf_push_str(sb, ": ");
-                write_node(sb, val->data.object.entries[i].node, fmt, depth + 1);
-                if (i + 1 < len || fmt.trailing_commas)
-                    sbuf_push_char(sb, ',');
-                if (fmt.pretty) sbuf_push_char(sb, '\n');
-            }
+            write_items(sb, val, fmt, depth, 0, len);
             if (fmt.pretty && len > 0) write_indent(sb, depth, fmt.indent);
-            sbuf_push_char(sb, '}');
+            sbuf_push_char(sb, is_array ? ']' : '}');
             break;
         }
     }
@@ -278,9 +352,7 @@ static void write_value(sbuf_t *sb, const xcdn_value_t *val,
 
 /* ── Write node ───────────────────────────────────────────────────────── */
 
-static void write_node(sbuf_t *sb, const xcdn_node_t *node,
-                       xcdn_format_t fmt, int depth) {
-    if (!node) return;
+static void write_decorations(sbuf_t *sb, const xcdn_node_t *node) {
     for (size_t i = 0; i < node->annotations_len; i++) {
         write_annotation(sb, &node->annotations[i]);
         sbuf_push_char(sb, ' ');
@@ -289,9 +361,90 @@ static void write_node(sbuf_t *sb, const xcdn_node_t *node,
         write_tag(sb, &node->tags[i]);
         sbuf_push_char(sb, ' ');
     }
+}
+
+static void write_node(sbuf_t *sb, const xcdn_node_t *node,
+                       xcdn_format_t fmt, int depth) {
+    if (!node) return;
+    write_decorations(sb, node);
     write_value(sb, node->value, fmt, depth);
 }
 
+/* ── Write container items ────────────────────────────────────────────── */
+
+/*
+ * Child i of an array/object, split around the child's value so callers
+ * can render the value itself separately (see the parallel serializer).
+ */
+static void write_item_prefix(sbuf_t *sb, const xcdn_value_t *val, size_t i,
+                              xcdn_format_t fmt, int depth) {
+    if (fmt.pretty) write_indent(sb, depth + 1, fmt.indent);
+    if (val->type == XCDN_VAL_OBJECT) {
+        write_key(sb, xcdn_object_key_entry(val, i));
+        sbuf_push_str(sb, ": ");
+    }
+}
+
+static void write_item_suffix(sbuf_t *sb, size_t i, size_t len,
+                              xcdn_format_t fmt) {
+    if (i + 1 < len || fmt.trailing_commas)
+        sbuf_push_char(sb, ',');
+    if (fmt.pretty) sbuf_push_char(sb, '\n');
+}
+
+static const xcdn_node_t *item_node(const xcdn_value_t *val, size_t i) {
+    return val->type == XCDN_VAL_ARRAY ? val->data.array.items[i]
+                                       : *xcdn_object_slot(val, i);
+}
+
+/* Write children [from, to) of an array/object value at `depth`. */
+static void write_items(sbuf_t *sb, const xcdn_value_t *val,
+                        xcdn_format_t fmt, int depth, size_t from, size_t to) {
+    size_t len = val->type == XCDN_VAL_ARRAY ? val->data.array.len
+                                             : val->data.object.len;
+    for (size_t i = from; i < to; i++) {
+        write_item_prefix(sb, val, i, fmt, depth);
+        write_node(sb, item_node(val, i), fmt, depth + 1);
+        write_item_suffix(sb, i, len, fmt);
+    }
+}
+
+/* ── Write document ───────────────────────────────────────────────────── */
+
+static void write_prolog(sbuf_t *sb, const xcdn_document_t *doc,
+                         xcdn_format_t fmt) {
+    int first_dir = 1;
+    for (size_t i = 0; i < doc->prolog_len; i++) {
+        if (!first_dir && fmt.pretty) sbuf_push_char(sb, '\n');
+        sbuf_push_char(sb, '$');
+        sbuf_push_str(sb, doc->prolog[i].name);
+        sbuf_push_str(sb, ": ");
+        write_value(sb, doc->prolog[i].value, fmt, 0);
+        if (fmt.trailing_commas) sbuf_push_char(sb, ',');
+        sbuf_push_char(sb, '\n');
+        first_dir = 0;
+    }
+}
+
+static void write_doc_value_prefix(sbuf_t *sb, size_t i, xcdn_format_t fmt) {
+    if (i > 0 && fmt.pretty) sbuf_push_char(sb, '\n');
+}
+
+static void write_doc_value_suffix(sbuf_t *sb, size_t i, size_t len,
+                                   xcdn_format_t fmt) {
+    if (i + 1 < len && fmt.pretty) sbuf_push_char(sb, '\n');
+}
+
+/* Write top-level values [from, to) of a document. */
+static void write_doc_values(sbuf_t *sb, const xcdn_document_t *doc,
+                             xcdn_format_t fmt, size_t from, size_t to) {
+    for (size_t i = from; i < to; i++) {
+        write_doc_value_prefix(sb, i, fmt);
+        write_node(sb, doc->values[i], fmt, 0);
+        write_doc_value_suffix(sb, i, doc->values_len, fmt);
+    }
+}
+
 /* ── Public API ───────────────────────────────────────────────────────── */
 
 xcdn_format_t xcdn_format_default(void) {
@@ -310,33 +463,823 @@ char *xcdn_to_string_with_format(const xcdn_document_t *doc,
 
     sbuf_t sb;
     sbuf_init(&sb);
+    write_prolog(&sb, doc, fmt);
+    write_doc_values(&sb, doc, fmt, 0, doc->values_len);
+    return sbuf_finish(&sb);
+}
 
-    int first_dir = 1;
-    for (size_t i = 0; i < doc->prolog_len; i++) {
-        if (!first_dir && fmt.pretty) sbuf_push_char(&sb, '\n');
+char *xcdn_node_to_string(const xcdn_node_t *node, xcdn_format_t fmt,
+                          size_t *len) {
+    if (!node) return NULL;
+
+    sbuf_t sb;
+    sbuf_init(&sb);
+    write_node(&sb, node, fmt, 0);
+    if (len) *len = sb.len;
+    return sbuf_finish(&sb);
+}
+
+char *xcdn_to_string_pretty(const xcdn_document_t *doc) {
+    return xcdn_to_string_with_format(doc, xcdn_format_default());
+}
+
+char *xcdn_to_string_compact(const xcdn_document_t *doc) {
+    return xcdn_to_string_with_format(doc, xcdn_format_compact());
+}
+
+/* ── Tape serialization ───────────────────────────────────────────────── */
+
+/*
+ * Same output as the tree serializer above, produced by one sequential
+ * pass over the tape. Each function returns the index just past what it
+ * wrote.
+ */
+
+static size_t tape_write_node(sbuf_t *sb, const xcdn_tape_t *t, size_t at,
+                              xcdn_format_t fmt, int depth);
+
+static const char *tape_str(const xcdn_tape_t *t, const xcdn_tape_entry_t *e) {
+    return t->strings + e->payload;
+}
+
+static size_t tape_write_value(sbuf_t *sb, const xcdn_tape_t *t, size_t at,
+                               xcdn_format_t fmt, int depth) {
+    const xcdn_tape_entry_t *e = &t->entries[at];
+    switch (e->type) {
+        case XCDN_VAL_BOOL:
+            sbuf_push_str(sb, e->payload ? "true" : "false");
+            return at + 1;
+        case XCDN_VAL_INT:
+        case XCDN_VAL_FLOAT:
+            if (e->flags & XCDN_FLAG_RAW_NUMBER) {
+                sbuf_push_mem(sb, tape_str(t, e + 1), e[1].count);
+                return at + 2;
+            }
+            if (e->type == XCDN_VAL_INT) {
+                int64_t i;
+                memcpy(&i, &e->payload, sizeof(i));
+                sbuf_push_fmt(sb, "%" PRId64, i);
+            } else {
+                double d;
+                memcpy(&d, &e->payload, sizeof(d));
+                write_float(sb, d);
+            }
+            return at + 1;
+        case XCDN_VAL_STRING:
+            write_string(sb, tape_str(t, e), e->count, e->flags);
+            return at + 1;
+        case XCDN_VAL_DECIMAL:
+            write_typed_text(sb, 'd', tape_str(t, e), e->count);
+            return at + 1;
+        case XCDN_VAL_DATETIME:
+            write_typed_text(sb, 't', tape_str(t, e), e->count);
+            return at + 1;
+        case XCDN_VAL_DURATION:
+            write_typed_text(sb, 'r', tape_str(t, e), e->count);
+            return at + 1;
+        case XCDN_VAL_UUID:
+            write_typed_text(sb, 'u', tape_str(t, e), e->count);
+            return at + 1;
+        case XCDN_VAL_BYTES:
+            sbuf_push_str(sb, "b\"");
+            b64_encode(sb, (const uint8_t *)tape_str(t, e), e->count);
+            sbuf_push_char(sb, '"');
+            return at + 1;
+        case XCDN_VAL_ARRAY:
+        case XCDN_VAL_OBJECT: {
+            int is_array = e->type == XCDN_VAL_ARRAY;
+            size_t len = e->count;
+            sbuf_push_char(sb, is_array ? '[' : '{');
+            if (fmt.pretty && len > 0) sbuf_push_char(sb, '\n');
+            at++;
+            for (size_t i = 0; i < len; i++) {
+                if (fmt.pretty) write_indent(sb, depth + 1, fmt.indent);
+                if (!is_array) {
+                    const xcdn_tape_entry_t *k = &t->entries[at++];
+                    write_key_text(sb, tape_str(t, k), k->count, k->flags);
+                    sbuf_push_str(sb, ": ");
+                }
+                at = tape_write_node(sb, t, at, fmt, depth + 1);
+                write_item_suffix(sb, i, len, fmt);
+            }
+            if (fmt.pretty && len > 0) write_indent(sb, depth, fmt.indent);
+            sbuf_push_char(sb, is_array ? ']' : '}');
+            return at + 1;   /* END */
+        }
+        default:
+            sbuf_push_str(sb, "null");
+            return at + 1;
+    }
+}
+
+static size_t tape_write_node(sbuf_t *sb, const xcdn_tape_t *t, size_t at,
+                              xcdn_format_t fmt, int depth) {
+    for (;;) {
+        const xcdn_tape_entry_t *e = &t->entries[at];
+        if (e->type == XCDN_TAPE_ANNOTATION) {
+            sbuf_push_char(sb, '@');
+            sbuf_push_str(sb, tape_str(t, e));
+            at++;
+            if (e->count > 0) {
+                sbuf_push_char(sb, '(');
+                for (uint32_t i = 0; i < e->count; i++) {
+                    if (i > 0) sbuf_push_str(sb, ", ");
+                    at = tape_write_value(sb, t, at, xcdn_format_compact(), 0);
+                }
+                sbuf_push_char(sb, ')');
+            }
+            sbuf_push_char(sb, ' ');
+        } else if (e->type == XCDN_TAPE_TAG) {
+            sbuf_push_char(sb, '#');
+            sbuf_push_mem(sb, tape_str(t, e), e->count);
+            sbuf_push_char(sb, ' ');
+            at++;
+        } else {
+            return tape_write_value(sb, t, at, fmt, depth);
+        }
+    }
+}
+
+char *xcdn_tape_to_string(const xcdn_tape_t *tape, xcdn_format_t fmt) {
+    if (!tape) return NULL;
+
+    sbuf_t sb;
+    sbuf_init(&sb);
+    size_t at = 0;
+    for (int first = 1; at < tape->body; first = 0) {
+        if (!first && fmt.pretty) sbuf_push_char(&sb, '\n');
         sbuf_push_char(&sb, '$');
-        sbuf_push_str(&sb, doc->prolog[i].name);
+        sbuf_push_str(&sb, tape_str(tape, &tape->entries[at]));
         sbuf_push_str(&sb, ": ");
-        write_value(&sb, doc->prolog[i].value, fmt, 0);
+        at = tape_write_value(&sb, tape, at + 1, fmt, 0);
         if (fmt.trailing_commas) sbuf_push_char(&sb, ',');
         sbuf_push_char(&sb, '\n');
-        first_dir = 0;
     }
+    for (size_t i = 0; i < tape->values_len; i++) {
+        write_doc_value_prefix(&sb, i, fmt);
+        at = tape_write_node(&sb, tape, at, fmt, 0);
+        write_doc_value_suffix(&sb, i, tape->values_len, fmt);
+    }
+    return sbuf_finish(&sb);
+}
+
+/* ── Scatter-gather serialization ─────────────────────────────────────── */
+
+int xcdn_to_iovec(const xcdn_document_t *doc, xcdn_format_t fmt,
+                  size_t min_ref, xcdn_iovec_list_t *out) {
+    if (!out) return -1;
+    memset(out, 0, sizeof(*out));
+    if (!doc) return -1;
+
+    sbuf_t sb;
+    sbuf_init(&sb);
+    sb.ref_min = min_ref ? min_ref : XCDN_IOVEC_MIN_REF;
+    write_prolog(&sb, doc, fmt);
+    write_doc_values(&sb, doc, fmt, 0, doc->values_len);
+
+    /* Scratch text between references, then the reference itself */
+    xcdn_iovec_t *iov =
+        (xcdn_iovec_t *)malloc((2 * sb.refs_len + 1) * sizeof(xcdn_iovec_t));
+    if (!iov || (sb.len > 0 && !sb.buf)) {
+        free(iov);
+        free(sb.buf);
+        free(sb.refs);
+        return -1;
+    }
+    size_t n = 0, at = 0, total = sb.len;
+    for (size_t i = 0; i < sb.refs_len; i++) {
+        const sbuf_ref_t *r = &sb.refs[i];
+        if (r->at > at) {
+            iov[n].base = sb.buf + at;
+            iov[n++].len = r->at - at;
+            at = r->at;
+        }
+        iov[n].base = r->data;
+        iov[n++].len = r->len;
+        total += r->len;
+    }
+    if (sb.len > at) {
+        iov[n].base = sb.buf + at;
+        iov[n++].len = sb.len - at;
+    }
+    free(sb.refs);
+
+    out->iov = iov;
+    out->len = n;
+    out->bytes = total;
+    out->scratch = sb.buf;
+    out->scratch_cap = sb.cap;
+    return 0;
+}
+
+void xcdn_iovec_list_free(xcdn_iovec_list_t *list) {
+    if (!list) return;
+    free(list->iov);
+    free(list->scratch);
+    memset(list, 0, sizeof(*list));
+}
+
+/* ── Streaming writer ─────────────────────────────────────────────────── */
+
+/*
+ * The writer produces the text of the tree serializer directly: each
+ * container separator is emitted when the next item (or the closing
+ * bracket) shows where the previous item ended, using the same helpers.
+ */
+
+#define WRITER_FLUSH_AT (64 * 1024)
+
+/* Structural checks cost a few compares; release builds skip them. */
+#ifndef NDEBUG
+#define WRITER_CHECK(w, cond) do { \
+    if (!(cond)) { \
+        (w)->error = XCDN_WRITER_MISUSE; \
+        return; \
+    } \
+} while (0)
+#else
+#define WRITER_CHECK(w, cond) ((void)sizeof(cond))
+#endif
+
+typedef enum {
+    FRAME_DOCUMENT,
+    FRAME_ARRAY,
+    FRAME_OBJECT,
+    FRAME_ANNOTATION,
+} frame_kind_t;
+
+typedef struct {
+    frame_kind_t  kind;
+    xcdn_format_t fmt;        /* annotation arguments are always compact */
+    int           depth;      /* container depth, as in write_value */
+    size_t        count;      /* completed items */
+    bool          in_item;    /* key or decorations written, value pending */
+} wframe_t;
+
+struct xcdn_writer {
+    sbuf_t        sb;
+    xcdn_sink_fn  sink;
+    void         *ctx;
+    wframe_t     *frames;
+    size_t        len;
+    size_t        cap;
+    size_t        directives;
+    bool          in_directive;
+    int           error;
+};
 
-    for (size_t i = 0; i < doc->values_len; i++) {
-        if (i > 0 && fmt.pretty) sbuf_push_char(&sb, '\n');
-        write_node(&sb, doc->values[i], fmt, 0);
-        if (i + 1 < doc->values_len && fmt.pretty)
-            sbuf_push_char(&sb, '\n');
+xcdn_writer_t *xcdn_writer_new(xcdn_format_t fmt, xcdn_sink_fn sink, void *ctx) {
+    xcdn_writer_t *w = (xcdn_writer_t *)calloc(1, sizeof(xcdn_writer_t));
+    if (!w) return NULL;
+    w->frames = (wframe_t *)malloc(16 * sizeof(wframe_t));
+    if (!w->frames) {
+        free(w);
+        return NULL;
     }
+    w->cap = 16;
+    w->len = 1;
+    memset(&w->frames[0], 0, sizeof(wframe_t));
+    w->frames[0].kind = FRAME_DOCUMENT;
+    w->frames[0].fmt = fmt;
+    w->frames[0].depth = -1;
+    w->sink = sink;
+    w->ctx = ctx;
+    sbuf_init(&w->sb);
+    return w;
+}
 
-    return sbuf_finish(&sb);
+static void writer_flush(xcdn_writer_t *w) {
+    if (!w->sink || w->sb.len == 0 || w->error) return;
+    int rc = w->sink(w->ctx, w->sb.buf, w->sb.len);
+    if (rc != 0) w->error = rc;
+    w->sb.len = 0;
 }
 
-char *xcdn_to_string_pretty(const xcdn_document_t *doc) {
-    return xcdn_to_string_with_format(doc, xcdn_format_default());
+static wframe_t *writer_top(xcdn_writer_t *w) {
+    return &w->frames[w->len - 1];
 }
 
-char *xcdn_to_string_compact(const xcdn_document_t *doc) {
-    return xcdn_to_string_with_format(doc, xcdn_format_compact());
+/*
+ * Start an item in the innermost frame unless its key or decorations
+ * already did: close the previous item, then indent.
+ */
+static void writer_begin_item(xcdn_writer_t *w) {
+    wframe_t *f = writer_top(w);
+    if (f->in_item) return;
+    f->in_item = true;
+    sbuf_t *sb = &w->sb;
+    switch (f->kind) {
+        case FRAME_DOCUMENT:
+            if (w->in_directive) break;
+            if (f->count > 0) {
+                write_doc_value_suffix(sb, f->count - 1, f->count + 1, f->fmt);
+                write_doc_value_prefix(sb, f->count, f->fmt);
+            }
+            break;
+        case FRAME_ARRAY:
+        case FRAME_OBJECT:
+            if (f->count == 0) {
+                if (f->fmt.pretty) sbuf_push_char(sb, '\n');
+            } else {
+                write_item_suffix(sb, f->count - 1, f->count + 1, f->fmt);
+            }
+            if (f->fmt.pretty) write_indent(sb, f->depth + 1, f->fmt.indent);
+            break;
+        case FRAME_ANNOTATION:
+            sbuf_push_str(sb, f->count == 0 ? "(" : ", ");
+            break;
+    }
+}
+
+/* A value was completed in the innermost frame. */
+static void writer_end_item(xcdn_writer_t *w) {
+    wframe_t *f = writer_top(w);
+    f->in_item = false;
+    if (f->kind == FRAME_DOCUMENT && w->in_directive) {
+        if (f->fmt.trailing_commas) sbuf_push_char(&w->sb, ',');
+        sbuf_push_char(&w->sb, '\n');
+        w->in_directive = false;
+        w->directives++;
+    } else {
+        f->count++;
+    }
+    if (w->sb.len >= WRITER_FLUSH_AT) writer_flush(w);
+}
+
+/* Common entry of every call that writes a value; false to skip it. */
+static bool writer_value_ok(xcdn_writer_t *w) {
+    if (!w || w->error) return false;
+#ifndef NDEBUG
+    wframe_t *f = writer_top(w);
+    if (f->kind == FRAME_OBJECT && !f->in_item) {
+        w->error = XCDN_WRITER_MISUSE;   /* value without a key */
+        return false;
+    }
+#endif
+    writer_begin_item(w);
+    return true;
+}
+
+static void writer_push(xcdn_writer_t *w, frame_kind_t kind) {
+    if (w->len >= w->cap) {
+        size_t cap = w->cap * 2;
+        wframe_t *frames = (wframe_t *)realloc(w->frames, cap * sizeof(wframe_t));
+        if (!frames) {
+            w->error = -1;
+            return;
+        }
+        w->frames = frames;
+        w->cap = cap;
+    }
+    const wframe_t *parent = writer_top(w);
+    wframe_t *f = &w->frames[w->len++];
+    f->kind = kind;
+    f->fmt = parent->kind == FRAME_ANNOTATION ? xcdn_format_compact() : parent->fmt;
+    f->depth = parent->kind == FRAME_ANNOTATION ? 0 : parent->depth + 1;
+    if (kind == FRAME_ANNOTATION) f->depth = parent->depth;
+    f->count = 0;
+    f->in_item = false;
+}
+
+void xcdn_writer_directive(xcdn_writer_t *w, const char *name) {
+    if (!w || w->error || !name) return;
+    wframe_t *f = writer_top(w);
+    WRITER_CHECK(w, w->len == 1 && f->count == 0 && !f->in_item && !w->in_directive);
+    if (w->directives > 0 && f->fmt.pretty) sbuf_push_char(&w->sb, '\n');
+    sbuf_push_char(&w->sb, '$');
+    sbuf_push_str(&w->sb, name);
+    sbuf_push_str(&w->sb, ": ");
+    w->in_directive = true;
+}
+
+void xcdn_writer_key(xcdn_writer_t *w, const char *key) {
+    if (!w || w->error || !key) return;
+    wframe_t *f = writer_top(w);
+    WRITER_CHECK(w, f->kind == FRAME_OBJECT && !f->in_item);
+    writer_begin_item(w);
+    write_key_text(&w->sb, key, strlen(key), 0);
+    sbuf_push_str(&w->sb, ": ");
+}
+
+void xcdn_writer_tag(xcdn_writer_t *w, const char *name) {
+    if (!w || w->error || !name) return;
+    WRITER_CHECK(w, writer_top(w)->kind != FRAME_ANNOTATION);
+    if (!writer_value_ok(w)) return;
+    sbuf_push_char(&w->sb, '#');
+    sbuf_push_str(&w->sb, name);
+    sbuf_push_char(&w->sb, ' ');
+}
+
+void xcdn_writer_begin_annotation(xcdn_writer_t *w, const char *name) {
+    if (!w || w->error || !name) return;
+    WRITER_CHECK(w, writer_top(w)->kind != FRAME_ANNOTATION);
+    if (!writer_value_ok(w)) return;
+    sbuf_push_char(&w->sb, '@');
+    sbuf_push_str(&w->sb, name);
+    writer_push(w, FRAME_ANNOTATION);
+}
+
+void xcdn_writer_annotation(xcdn_writer_t *w, const char *name) {
+    xcdn_writer_begin_annotation(w, name);
+    xcdn_writer_end(w);
+}
+
+void xcdn_writer_begin_array(xcdn_writer_t *w) {
+    if (!writer_value_ok(w)) return;
+    sbuf_push_char(&w->sb, '[');
+    writer_push(w, FRAME_ARRAY);
+}
+
+void xcdn_writer_begin_object(xcdn_writer_t *w) {
+    if (!writer_value_ok(w)) return;
+    sbuf_push_char(&w->sb, '{');
+    writer_push(w, FRAME_OBJECT);
+}
+
+void xcdn_writer_end(xcdn_writer_t *w) {
+    if (!w || w->error) return;
+    wframe_t *f = writer_top(w);
+    if (f->kind == FRAME_DOCUMENT) {
+        w->error = XCDN_WRITER_MISUSE;   /* nothing to close */
+        return;
+    }
+    WRITER_CHECK(w, !f->in_item);
+    if (f->kind == FRAME_ANNOTATION) {
+        if (f->count > 0) sbuf_push_char(&w->sb, ')');
+        sbuf_push_char(&w->sb, ' ');
+        w->len--;
+        return;
+    }
+    if (f->count > 0) {
+        write_item_suffix(&w->sb, f->count - 1, f->count, f->fmt);
+        if (f->fmt.pretty) write_indent(&w->sb, f->depth, f->fmt.indent);
+    }
+    sbuf_push_char(&w->sb, f->kind == FRAME_ARRAY ? ']' : '}');
+    w->len--;
+    writer_end_item(w);
+}
+
+void xcdn_writer_null(xcdn_writer_t *w) {
+    if (!writer_value_ok(w)) return;
+    sbuf_push_str(&w->sb, "null");
+    writer_end_item(w);
+}
+
+void xcdn_writer_bool(xcdn_writer_t *w, bool v) {
+    if (!writer_value_ok(w)) return;
+    sbuf_push_str(&w->sb, v ? "true" : "false");
+    writer_end_item(w);
+}
+
+void xcdn_writer_int(xcdn_writer_t *w, int64_t v) {
+    if (!writer_value_ok(w)) return;
+    sbuf_push_fmt(&w->sb, "%" PRId64, v);
+    writer_end_item(w);
+}
+
+void xcdn_writer_float(xcdn_writer_t *w, double v) {
+    if (!writer_value_ok(w)) return;
+    write_float(&w->sb, v);
+    writer_end_item(w);
+}
+
+void xcdn_writer_string(xcdn_writer_t *w, const char *s) {
+    if (!writer_value_ok(w)) return;
+    write_escaped_string(&w->sb, s);
+    writer_end_item(w);
+}
+
+static void writer_typed(xcdn_writer_t *w, char prefix, const char *s) {
+    if (!writer_value_ok(w)) return;
+    write_typed_text(&w->sb, prefix, s ? s : "", s ? strlen(s) : 0);
+    writer_end_item(w);
+}
+
+void xcdn_writer_decimal(xcdn_writer_t *w, const char *s)  { writer_typed(w, 'd', s); }
+void xcdn_writer_datetime(xcdn_writer_t *w, const char *s) { writer_typed(w, 't', s); }
+void xcdn_writer_duration(xcdn_writer_t *w, const char *s) { writer_typed(w, 'r', s); }
+void xcdn_writer_uuid(xcdn_writer_t *w, const char *s)     { writer_typed(w, 'u', s); }
+
+void xcdn_writer_bytes(xcdn_writer_t *w, const uint8_t *data, size_t len) {
+    if (!writer_value_ok(w)) return;
+    sbuf_push_str(&w->sb, "b\"");
+    b64_encode(&w->sb, data, data ? len : 0);
+    sbuf_push_char(&w->sb, '"');
+    writer_end_item(w);
+}
+
+void xcdn_writer_node(xcdn_writer_t *w, const xcdn_node_t *node) {
+    if (!node) {
+        xcdn_writer_null(w);
+        return;
+    }
+    if (!writer_value_ok(w)) return;
+    const wframe_t *f = writer_top(w);
+    if (f->kind == FRAME_ANNOTATION)
+        write_value(&w->sb, node->value, f->fmt, 0);
+    else
+        write_node(&w->sb, node, f->fmt, f->depth + 1);
+    writer_end_item(w);
+}
+
+int xcdn_writer_error(const xcdn_writer_t *w) {
+    return w ? w->error : -1;
+}
+
+int xcdn_writer_flush(xcdn_writer_t *w) {
+    if (!w) return -1;
+    writer_flush(w);
+    return w->error;
+}
+
+/* Check that everything was closed; keeps the writer. */
+static int writer_complete(xcdn_writer_t *w) {
+    if (!w->error && (w->len != 1 || w->frames[0].in_item || w->in_directive))
+        w->error = XCDN_WRITER_MISUSE;
+    return w->error;
+}
+
+static void writer_free(xcdn_writer_t *w) {
+    free(w->sb.buf);
+    free(w->frames);
+    free(w);
+}
+
+int xcdn_writer_finish(xcdn_writer_t *w) {
+    if (!w) return -1;
+    if (writer_complete(w) == 0) writer_flush(w);
+    int rc = w->error;
+    writer_free(w);
+    return rc;
+}
+
+char *xcdn_writer_finish_string(xcdn_writer_t *w, size_t *len) {
+    if (!w) return NULL;
+    char *out = NULL;
+    if (!w->sink && writer_complete(w) == 0) {
+        if (len) *len = w->sb.len;
+        out = sbuf_finish(&w->sb);
+        w->sb.buf = NULL;
+    }
+    writer_free(w);
+    return out;
+}
+
+/* ── Parallel serialization ───────────────────────────────────────────── */
+
+/*
+ * The document is cut into an ordered list of segments. Structural glue
+ * around split containers (brackets, keys, separators, decorations) is
+ * rendered while planning; every other segment renders a range of
+ * top-level values or of a container's children into its own buffer, on
+ * whichever worker picks it up. Joining the buffers in order yields exactly
+ * the single-threaded output.
+ */
+
+#if !defined(__STDC_NO_THREADS__) && !defined(__STDC_NO_ATOMICS__)
+#define XCDN_SER_THREADS 1
+#include <threads.h>
+#include <stdatomic.h>
+#endif
+
+#define PAR_MIN_ITEMS  64   /* containers smaller than this are never split */
+#define PAR_MAX_LEVEL  8    /* how deep the planner looks for big children */
+#define PAR_SEGS_PER_THREAD 8
+
+typedef enum {
+    SEG_TEXT,        /* pre-rendered glue */
+    SEG_DOC_RANGE,   /* top-level values [from, to) */
+    SEG_ITEM_RANGE,  /* children [from, to) of `val` at `depth` */
+} seg_kind_t;
+
+typedef struct {
+    seg_kind_t          kind;
+    const xcdn_value_t *val;
+    int                 depth;
+    size_t              from;
+    size_t              to;
+    sbuf_t              out;
+} seg_t;
+
+typedef struct {
+    seg_t                 *segs;
+    size_t                 len;
+    size_t                 cap;
+    const xcdn_document_t *doc;
+    xcdn_format_t          fmt;
+    size_t                 target;   /* desired number of ranges per split */
+    int                    oom;
+} plan_t;
+
+static seg_t *plan_push(plan_t *pl, seg_kind_t kind) {
+    if (pl->len >= pl->cap) {
+        size_t new_cap = (pl->cap == 0) ? 32 : pl->cap * 2;
+        seg_t *new_segs = (seg_t *)realloc(pl->segs, new_cap * sizeof(seg_t));
+        if (!new_segs) {
+            pl->oom = 1;
+            return NULL;
+        }
+        pl->segs = new_segs;
+        pl->cap = new_cap;
+    }
+    seg_t *sg = &pl->segs[pl->len++];
+    memset(sg, 0, sizeof(*sg));
+    sg->kind = kind;
+    sbuf_init(&sg->out);
+    return sg;
+}
+
+/* Buffer receiving glue text: the trailing text segment, or a new one. */
+static sbuf_t *plan_text(plan_t *pl) {
+    if (pl->len > 0 && pl->segs[pl->len - 1].kind == SEG_TEXT)
+        return &pl->segs[pl->len - 1].out;
+    seg_t *sg = plan_push(pl, SEG_TEXT);
+    return sg ? &sg->out : NULL;
+}
+
+static void plan_ranges(plan_t *pl, seg_kind_t kind, const xcdn_value_t *val,
+                        int depth, size_t from, size_t to, size_t total) {
+    size_t grain = (total + pl->target - 1) / pl->target;
+    if (grain == 0) grain = 1;
+    while (from < to) {
+        size_t end = (to - from > grain) ? from + grain : to;
+        seg_t *sg = plan_push(pl, kind);
+        if (!sg) return;
+        sg->val = val;
+        sg->depth = depth;
+        sg->from = from;
+        sg->to = end;
+        from = end;
+    }
+}
+
+static size_t container_len(const xcdn_value_t *val) {
+    if (!val) return 0;
+    if (val->type == XCDN_VAL_ARRAY) return val->data.array.len;
+    if (val->type == XCDN_VAL_OBJECT) return val->data.object.len;
+    return 0;
+}
+
+static void plan_container(plan_t *pl, const xcdn_value_t *val, int depth,
+                           int level) {
+    xcdn_format_t fmt = pl->fmt;
+    size_t len = container_len(val);
+    int is_array = val->type == XCDN_VAL_ARRAY;
+    sbuf_t *sb = plan_text(pl);
+    if (!sb) return;
+    sbuf_push_char(sb, is_array ? '[' : '{');
+    if (fmt.pretty) sbuf_push_char(sb, '\n');
+
+    size_t run = 0;
+    for (size_t i = 0; i < len && !pl->oom; i++) {
+        const xcdn_node_t *child = item_node(val, i);
+        if (level >= PAR_MAX_LEVEL || !child ||
+            container_len(child->value) < PAR_MIN_ITEMS)
+            continue;
+        plan_ranges(pl, SEG_ITEM_RANGE, val, depth, run, i, len);
+        if (!(sb = plan_text(pl))) return;
+        write_item_prefix(sb, val, i, fmt, depth);
+        write_decorations(sb, child);
+        plan_container(pl, child->value, depth + 1, level + 1);
+        if (!(sb = plan_text(pl))) return;
+        write_item_suffix(sb, i, len, fmt);
+        run = i + 1;
+    }
+    plan_ranges(pl, SEG_ITEM_RANGE, val, depth, run, len, len);
+
+    if (!(sb = plan_text(pl))) return;
+    if (fmt.pretty) write_indent(sb, depth, fmt.indent);
+    sbuf_push_char(sb, is_array ? ']' : '}');
+}
+
+static void plan_document(plan_t *pl) {
+    const xcdn_document_t *doc = pl->doc;
+    sbuf_t *sb = plan_text(pl);
+    if (!sb) return;
+    write_prolog(sb, doc, pl->fmt);
+
+    size_t len = doc->values_len;
+    size_t run = 0;
+    for (size_t i = 0; i < len && !pl->oom; i++) {
+        const xcdn_node_t *node = doc->values[i];
+        if (!node || container_len(node->value) < PAR_MIN_ITEMS) continue;
+        plan_ranges(pl, SEG_DOC_RANGE, NULL, 0, run, i, len);
+        if (!(sb = plan_text(pl))) return;
+        write_doc_value_prefix(sb, i, pl->fmt);
+        write_decorations(sb, node);
+        plan_container(pl, node->value, 0, 1);
+        if (!(sb = plan_text(pl))) return;
+        write_doc_value_suffix(sb, i, len, pl->fmt);
+        run = i + 1;
+    }
+    plan_ranges(pl, SEG_DOC_RANGE, NULL, 0, run, len, len);
+}
+
+static void render_segment(const plan_t *pl, seg_t *sg) {
+    switch (sg->kind) {
+        case SEG_DOC_RANGE:
+            write_doc_values(&sg->out, pl->doc, pl->fmt, sg->from, sg->to);
+            break;
+        case SEG_ITEM_RANGE:
+            write_items(&sg->out, sg->val, pl->fmt, sg->depth, sg->from, sg->to);
+            break;
+        default:
+            break;
+    }
+}
+
+#ifdef XCDN_SER_THREADS
+typedef struct {
+    plan_t       *plan;
+    atomic_size_t next;
+} par_queue_t;
+
+static int par_worker(void *arg) {
+    par_queue_t *q = (par_queue_t *)arg;
+    for (;;) {
+        size_t i = atomic_fetch_add(&q->next, 1);
+        if (i >= q->plan->len) break;
+        render_segment(q->plan, &q->plan->segs[i]);
+    }
+    return 0;
+}
+#endif
+
+static void render_plan(plan_t *pl, int threads) {
+#ifdef XCDN_SER_THREADS
+    if (threads > 1) {
+        par_queue_t q;
+        q.plan = pl;
+        atomic_init(&q.next, 0);
+        thrd_t *workers = (thrd_t *)malloc((size_t)(threads - 1) * sizeof(thrd_t));
+        int started = 0;
+        if (workers) {
+            for (; started < threads - 1; started++) {
+                if (thrd_create(&workers[started], par_worker, &q) != thrd_success)
+                    break;
+            }
+        }
+        par_worker(&q);
+        for (int i = 0; i < started; i++) thrd_join(workers[i], NULL);
+        free(workers);
+        return;
+    }
+#else
+    (void)threads;
+#endif
+    for (size_t i = 0; i < pl->len; i++) render_segment(pl, &pl->segs[i]);
+}
+
+static int build_plan(plan_t *pl, const xcdn_document_t *doc,
+                      xcdn_format_t fmt, int threads) {
+    memset(pl, 0, sizeof(*pl));
+    pl->doc = doc;
+    pl->fmt = fmt;
+    pl->target = (size_t)(threads > 1 ? threads : 1) * PAR_SEGS_PER_THREAD;
+    plan_document(pl);
+    if (pl->oom) return -1;
+    render_plan(pl, threads);
+    return 0;
+}
+
+static void free_plan(plan_t *pl) {
+    for (size_t i = 0; i < pl->len; i++) free(pl->segs[i].out.buf);
+    free(pl->segs);
+}
+
+int xcdn_write_parallel(const xcdn_document_t *doc, xcdn_format_t fmt,
+                        int threads, xcdn_sink_fn sink, void *ctx) {
+    if (!doc || !sink) return -1;
+    plan_t pl;
+    int rc = build_plan(&pl, doc, fmt, threads);
+    for (size_t i = 0; rc == 0 && i < pl.len; i++) {
+        if (pl.segs[i].out.len > 0)
+            rc = sink(ctx, pl.segs[i].out.buf, pl.segs[i].out.len);
+    }
+    free_plan(&pl);
+    return rc;
+}
+
+char *xcdn_to_string_parallel(const xcdn_document_t *doc, xcdn_format_t fmt,
+                              int threads) {
+    if (!doc) return NULL;
+    plan_t pl;
+    if (build_plan(&pl, doc, fmt, threads) != 0) {
+        free_plan(&pl);
+        return NULL;
+    }
+    size_t total = 0;
+    for (size_t i = 0; i < pl.len; i++) total += pl.segs[i].out.len;
+    char *out = (char *)malloc(total + 1);
+    if (out) {
+        size_t o = 0;
+        for (size_t i = 0; i < pl.len; i++) {
+            if (pl.segs[i].out.len == 0) continue;
+            memcpy(out + o, pl.segs[i].out.buf, pl.segs[i].out.len);
+            o += pl.segs[i].out.len;
+        }
+        out[o] = '\0';
+    }
+    free_plan(&pl);
+    return out;
 }
@@ -2,7 +2,10 @@
  * xCDN - eXtensible Cognitive Data Notation (C implementation)
  * Serializer for xCDN.
  *
- * Provides pretty and compact string encoders.
+ * Provides pretty and compact string encoders, a parallel encoder for
+ * large documents, a scatter-gather encoder that references large
+ * payloads in place, and a streaming writer that emits xCDN without
+ * building a tree.
  *
  * MIT License
  */
@@ -11,6 +14,7 @@
 #define XCDN_SER_H
 
 #include "ast.h"
+#include "tape.h"
 #include <stddef.h>
 #include <stdbool.h>
 
@@ -49,4 +53,171 @@ char *xcdn_to_string_compact(const xcdn_document_t *doc);
 char *xcdn_to_string_with_format(const xcdn_document_t *doc,
                                  xcdn_format_t fmt);
 
+/*
+ * Serialize one node (decorations and value) as a top-level value.
+ * Caller must free() the returned string; its length goes to *len if
+ * non-NULL.
+ * Returns NULL on error.
+ */
+char *xcdn_node_to_string(const xcdn_node_t *node, xcdn_format_t fmt,
+                          size_t *len);
+
+/*
+ * Serialize a tape (see tape.h). The output is byte-identical to
+ * serializing the document the tape was built from, except that bytes
+ * values are always re-encoded.
+ * Caller must free() the returned string.
+ * Returns NULL on error.
+ */
+char *xcdn_tape_to_string(const xcdn_tape_t *tape, xcdn_format_t fmt);
+
+/*
+ * Output callback used by the streaming serializers.
+ * Must consume all `len` bytes; return 0 on success, nonzero to abort
+ * (the value is passed back to the caller).
+ */
+typedef int (*xcdn_sink_fn)(void *ctx, const char *data, size_t len);
+
+/*
+ * Serialize a Document using up to `threads` threads (including the
+ * calling one). Top-level stream values and the children of large arrays
+ * and objects are rendered into per-thread buffers and joined in order;
+ * the output is byte-identical to xcdn_to_string_with_format().
+ * Caller must free() the returned string.
+ * Returns NULL on error.
+ */
+char *xcdn_to_string_parallel(const xcdn_document_t *doc, xcdn_format_t fmt,
+                              int threads);
+
+/*
+ * Like xcdn_to_string_parallel(), but hands the rendered chunks to `sink`
+ * in document order instead of joining them.
+ * Returns 0 on success, -1 on allocation failure, or the sink's error.
+ */
+int xcdn_write_parallel(const xcdn_document_t *doc, xcdn_format_t fmt,
+                        int threads, xcdn_sink_fn sink, void *ctx);
+
+/* ── Scatter-gather serialization ─────────────────────────────────────── */
+
+/* One piece of output (same fields as POSIX struct iovec, in order). */
+typedef struct {
+    const void *base;
+    size_t      len;
+} xcdn_iovec_t;
+
+/* Serialized text as a list of pieces to write in order. */
+typedef struct {
+    xcdn_iovec_t *iov;
+    size_t        len;       /* number of pieces */
+    size_t        bytes;     /* total text length */
+    char         *scratch;   /* structural text the pieces point into */
+    size_t        scratch_cap;  /* bytes allocated for scratch */
+} xcdn_iovec_list_t;
+
+/* Default minimum length of a referenced run. */
+#define XCDN_IOVEC_MIN_REF 4096
+
+/*
+ * Serialize a Document as a list of pieces whose concatenation is the
+ * text of xcdn_to_string_with_format() (without its terminating NUL).
+ * Literal runs of at least `min_ref` bytes (0 selects XCDN_IOVEC_MIN_REF)
+ * from strings, typed strings and lazily decoded bytes point straight
+ * into the document; everything else is built in one scratch buffer.
+ * Pieces can be handed to writev() in batches of at most IOV_MAX.
+ *
+ * The list borrows from `doc`, which must not be modified or freed
+ * while it is in use. Release it with xcdn_iovec_list_free().
+ * Returns 0 on success, -1 on error.
+ */
+int xcdn_to_iovec(const xcdn_document_t *doc, xcdn_format_t fmt,
+                  size_t min_ref, xcdn_iovec_list_t *out);
+
+void xcdn_iovec_list_free(xcdn_iovec_list_t *list);
+
+/* ── Streaming writer ─────────────────────────────────────────────────── */
+
+/*
+ * Emits xCDN text call by call, with exactly the output the serializer
+ * gives for the same tree and format, without building the tree:
+ *
+ *   xcdn_writer_t *w = xcdn_writer_new(xcdn_format_default(), NULL, NULL);
+ *   xcdn_writer_begin_object(w);
+ *   xcdn_writer_key(w, "name");
+ *   xcdn_writer_string(w, "svc");
+ *   xcdn_writer_key(w, "port");
+ *   xcdn_writer_tag(w, "internal");
+ *   xcdn_writer_int(w, 8080);
+ *   xcdn_writer_end(w);
+ *   char *text = xcdn_writer_finish_string(w, NULL);
+ *
+ * Output is buffered and handed to the sink in chunks of about 64 KiB,
+ * or kept in memory when the sink is NULL. Decorations (tags and
+ * annotations) go before the value they decorate, after its key inside
+ * an object, and are written in call order (the serializer puts
+ * annotations before tags). Values written between
+ * xcdn_writer_begin_annotation() and xcdn_writer_end() are the
+ * annotation's arguments.
+ *
+ * Unless NDEBUG is defined, calls that would produce malformed text
+ * (a value without a key in an object, an unbalanced end, ...) are
+ * ignored and set the XCDN_WRITER_MISUSE error. After an error every call
+ * is a no-op.
+ */
+typedef struct xcdn_writer xcdn_writer_t;
+
+#define XCDN_WRITER_MISUSE (-2)
+
+/* Create a writer. Returns NULL on allocation failure. */
+xcdn_writer_t *xcdn_writer_new(xcdn_format_t fmt, xcdn_sink_fn sink, void *ctx);
+
+/* Start a prolog directive ($name: ...); its value is written next. */
+void xcdn_writer_directive(xcdn_writer_t *w, const char *name);
+
+void xcdn_writer_begin_array(xcdn_writer_t *w);
+void xcdn_writer_begin_object(xcdn_writer_t *w);
+
+/* Key of the next value in an object (quoted if needed). */
+void xcdn_writer_key(xcdn_writer_t *w, const char *key);
+
+/* Decorations of the next value. */
+void xcdn_writer_tag(xcdn_writer_t *w, const char *name);
+void xcdn_writer_annotation(xcdn_writer_t *w, const char *name);
+void xcdn_writer_begin_annotation(xcdn_writer_t *w, const char *name);
+
+/* Close the innermost array, object or annotation. */
+void xcdn_writer_end(xcdn_writer_t *w);
+
+void xcdn_writer_null(xcdn_writer_t *w);
+void xcdn_writer_bool(xcdn_writer_t *w, bool v);
+void xcdn_writer_int(xcdn_writer_t *w, int64_t v);
+void xcdn_writer_float(xcdn_writer_t *w, double v);
+void xcdn_writer_string(xcdn_writer_t *w, const char *s);
+void xcdn_writer_decimal(xcdn_writer_t *w, const char *s);
+void xcdn_writer_datetime(xcdn_writer_t *w, const char *s);
+void xcdn_writer_duration(xcdn_writer_t *w, const char *s);
+void xcdn_writer_uuid(xcdn_writer_t *w, const char *s);
+void xcdn_writer_bytes(xcdn_writer_t *w, const uint8_t *data, size_t len);
+
+/* Write an existing node (decorations and subtree) as the next value. */
+void xcdn_writer_node(xcdn_writer_t *w, const xcdn_node_t *node);
+
+/* First error: -1 (allocation), XCDN_WRITER_MISUSE or the sink's; 0 if none. */
+int xcdn_writer_error(const xcdn_writer_t *w);
+
+/* Hand buffered output to the sink now. Returns xcdn_writer_error(). */
+int xcdn_writer_flush(xcdn_writer_t *w);
+
+/*
+ * Check that every container was closed, flush, and free the writer.
+ * Returns 0 or the first error.
+ */
+int xcdn_writer_finish(xcdn_writer_t *w);
+
+/*
+ * Finish a writer created without a sink and return its text (caller
+ * frees), with its length in *len if non-NULL. Frees the writer.
+ * Returns NULL on error.
+ */
+char *xcdn_writer_finish_string(xcdn_writer_t *w, size_t *len);
+
 #endif /* XCDN_SER_H */
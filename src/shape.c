@@ -0,0 +1,173 @@
+/*
+ * xCDN - eXtensible Cognitive Data Notation (C implementation)
+ * Object shapes.
+ *
+ * MIT License
+ */
+
+#include "shape.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Shapes up to this many keys are searched linearly, without an index. */
+#define SHAPE_LINEAR_MAX 8
+
+struct xcdn_shape_table {
+    xcdn_shape_t **slots;   /* open addressing, NULL = empty */
+    size_t         cap;     /* power of two */
+    size_t         len;
+};
+
+static uint64_t hash_key(uint64_t h, const char *s, size_t len) {
+    for (size_t i = 0; i < len; i++) {   /* FNV-1a */
+        h ^= (unsigned char)s[i];
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+static uint64_t hash_keys(const xcdn_object_entry_t *entries, size_t len) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < len; i++)
+        h = hash_key(h, xcdn_entry_key(&entries[i]), entries[i].key_len + 1);
+    return h;
+}
+
+static bool same_keys(const xcdn_shape_t *s, const xcdn_object_entry_t *entries,
+                      size_t len) {
+    if (s->len != len) return false;
+    for (size_t i = 0; i < len; i++) {
+        if (s->keys[i].key_len != entries[i].key_len ||
+            memcmp(xcdn_entry_key(&s->keys[i]), xcdn_entry_key(&entries[i]),
+                   entries[i].key_len) != 0)
+            return false;
+    }
+    return true;
+}
+
+static size_t find_slot(xcdn_shape_t **slots, size_t cap, uint64_t hash,
+                        const xcdn_object_entry_t *entries, size_t len) {
+    size_t mask = cap - 1;
+    size_t i = (size_t)hash & mask;
+    while (slots[i] &&
+           (slots[i]->hash != hash || !same_keys(slots[i], entries, len)))
+        i = (i + 1) & mask;
+    return i;
+}
+
+static bool grow(xcdn_shape_table_t *t) {
+    size_t cap = t->cap ? t->cap * 2 : 64;
+    xcdn_shape_t **slots = (xcdn_shape_t **)calloc(cap, sizeof(*slots));
+    if (!slots) return false;
+    for (size_t i = 0; i < t->cap; i++) {
+        xcdn_shape_t *s = t->slots[i];
+        if (s) slots[find_slot(slots, cap, s->hash, s->keys, s->len)] = s;
+    }
+    free(t->slots);
+    t->slots = slots;
+    t->cap = cap;
+    return true;
+}
+
+/* Bucket of a key in a shape's index. */
+static size_t index_slot(const xcdn_shape_t *s, const char *key, size_t key_len) {
+    size_t mask = s->index_cap - 1;
+    size_t i = (size_t)hash_key(0xcbf29ce484222325ull, key, key_len) & mask;
+    while (s->index[i] != 0) {
+        const xcdn_object_entry_t *e = &s->keys[s->index[i] - 1];
+        if (e->key_len == key_len && memcmp(xcdn_entry_key(e), key, key_len) == 0)
+            break;
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+/* Copy of the keys of entries[0..len), with an index if it is long. */
+static xcdn_shape_t *shape_new(const xcdn_object_entry_t *entries, size_t len,
+                               uint64_t hash) {
+    xcdn_shape_t *s = (xcdn_shape_t *)calloc(
+        1, sizeof(xcdn_shape_t) + len * sizeof(xcdn_object_entry_t));
+    if (!s) return NULL;
+    s->refs = 1;   /* the table's own reference */
+    s->hash = hash;
+    for (; s->len < len; s->len++) {
+        const xcdn_object_entry_t *e = &entries[s->len];
+        xcdn_object_entry_t *k = &s->keys[s->len];
+        k->key_len = e->key_len;
+        k->key_flags = e->key_flags;
+        if (XCDN_KEY_INLINE(e->key_len)) {
+            memcpy(k->key_sso, e->key_sso, e->key_len + 1);
+        } else if ((k->key_heap = (char *)malloc(e->key_len + 1))) {
+            memcpy(k->key_heap, e->key_heap, e->key_len + 1);
+        } else {
+            xcdn_shape_release(s);
+            return NULL;
+        }
+    }
+    if (len > SHAPE_LINEAR_MAX) {
+        size_t cap = 16;
+        while (cap < len * 2) cap *= 2;
+        if (!(s->index = (uint32_t *)calloc(cap, sizeof(uint32_t)))) {
+            xcdn_shape_release(s);
+            return NULL;
+        }
+        s->index_cap = cap;
+        for (size_t i = 0; i < len; i++)
+            s->index[index_slot(s, xcdn_entry_key(&s->keys[i]), s->keys[i].key_len)] =
+                (uint32_t)(i + 1);
+    }
+    return s;
+}
+
+/* ── Public API ───────────────────────────────────────────────────────── */
+
+xcdn_shape_table_t *xcdn_shape_table_new(void) {
+    return (xcdn_shape_table_t *)calloc(1, sizeof(xcdn_shape_table_t));
+}
+
+void xcdn_shape_table_free(xcdn_shape_table_t *t) {
+    if (!t) return;
+    for (size_t i = 0; i < t->cap; i++)
+        xcdn_shape_release(t->slots[i]);
+    free(t->slots);
+    free(t);
+}
+
+xcdn_shape_t *xcdn_shape_intern(xcdn_shape_table_t *t,
+                                const xcdn_object_entry_t *entries, size_t len) {
+    if (!t || len > UINT32_MAX - 1) return NULL;
+    if ((t->len + 1) * 2 > t->cap && !grow(t)) return NULL;
+    uint64_t hash = hash_keys(entries, len);
+    size_t i = find_slot(t->slots, t->cap, hash, entries, len);
+    xcdn_shape_t *s = t->slots[i];
+    if (!s) {
+        if (!(s = shape_new(entries, len, hash))) return NULL;
+        t->slots[i] = s;
+        t->len++;
+    }
+    s->refs++;
+    return s;
+}
+
+void xcdn_shape_release(xcdn_shape_t *shape) {
+    if (!shape || --shape->refs > 0) return;
+    for (size_t i = 0; i < shape->len; i++) {
+        if (!XCDN_KEY_INLINE(shape->keys[i].key_len)) free(shape->keys[i].key_heap);
+    }
+    free(shape->index);
+    free(shape);
+}
+
+size_t xcdn_shape_find(const xcdn_shape_t *shape, const char *key, size_t key_len) {
+    if (shape->index) {
+        uint32_t at = shape->index[index_slot(shape, key, key_len)];
+        return at ? at - 1 : shape->len;
+    }
+    size_t i = 0;
+    for (; i < shape->len; i++) {
+        const xcdn_object_entry_t *e = &shape->keys[i];
+        if (e->key_len == key_len && memcmp(xcdn_entry_key(e), key, key_len) == 0)
+            break;
+    }
+    return i;
+}
@@ -0,0 +1,41 @@
+/*
+ * xCDN - eXtensible Cognitive Data Notation (C implementation)
+ * Object shapes.
+ *
+ * A shape is the key sequence of an object, interned so that every object
+ * with the same keys in the same order shares one descriptor (see
+ * xcdn_shape_t in ast.h). Shapes are reference counted and immutable, and
+ * outlive the table that interned them.
+ *
+ * MIT License
+ */
+
+#ifndef XCDN_SHAPE_H
+#define XCDN_SHAPE_H
+
+#include "ast.h"
+#include <stddef.h>
+
+typedef struct xcdn_shape_table xcdn_shape_table_t;
+
+/* Create an empty table. Returns NULL on allocation failure. */
+xcdn_shape_table_t *xcdn_shape_table_new(void);
+
+/* Free the table (NULL-safe). Interned shapes stay valid while referenced. */
+void xcdn_shape_table_free(xcdn_shape_table_t *t);
+
+/*
+ * Return the table's shape for the keys of `entries[0..len)` (their nodes
+ * are ignored), adding a copy if needed, with one new reference for the
+ * caller. Returns NULL on allocation failure.
+ */
+xcdn_shape_t *xcdn_shape_intern(xcdn_shape_table_t *t,
+                                const xcdn_object_entry_t *entries, size_t len);
+
+/* Drop one reference to a shape; the last one frees it (NULL-safe). */
+void xcdn_shape_release(xcdn_shape_t *shape);
+
+/* Slot of a key in a shape, or shape->len if the shape has no such key. */
+size_t xcdn_shape_find(const xcdn_shape_t *shape, const char *key, size_t key_len);
+
+#endif /* XCDN_SHAPE_H */
@@ -0,0 +1,89 @@
+/*
+ * xCDN - eXtensible Cognitive Data Notation (C implementation)
+ * Lock-free snapshot holder for frozen documents.
+ *
+ * Epoch scheme: readers register in one of two counters selected by the
+ * parity of the current epoch, then re-check the epoch. A publisher swaps
+ * the document pointer, advances the epoch, and waits for the counter of
+ * the previous epoch to drain. Readers registered under the new epoch can
+ * only observe the new document, so the old one is then unreachable.
+ *
+ * MIT License
+ */
+
+#include "snapshot.h"
+#include <stdlib.h>
+
+#ifdef __STDC_NO_ATOMICS__
+#error "xcdn snapshot holder requires C11 atomics"
+#endif
+#include <stdatomic.h>
+
+#ifndef __STDC_NO_THREADS__
+#include <threads.h>
+#define snapshot_pause() thrd_yield()
+#else
+#define snapshot_pause() ((void)0)
+#endif
+
+struct xcdn_snapshot {
+    _Atomic(xcdn_document_t *) current;
+    atomic_uint                epoch;
+    atomic_uint                readers[2];
+    atomic_flag                publishing;
+};
+
+xcdn_snapshot_t *xcdn_snapshot_new(xcdn_document_t *doc) {
+    xcdn_snapshot_t *snap = (xcdn_snapshot_t *)malloc(sizeof(*snap));
+    if (!snap) return NULL;
+    xcdn_document_freeze(doc);
+    atomic_init(&snap->current, doc);
+    atomic_init(&snap->epoch, 0);
+    atomic_init(&snap->readers[0], 0);
+    atomic_init(&snap->readers[1], 0);
+    atomic_flag_clear(&snap->publishing);
+    return snap;
+}
+
+const xcdn_document_t *xcdn_snapshot_acquire(xcdn_snapshot_t *snap,
+                                             unsigned *ticket) {
+    if (!snap) return NULL;
+    for (;;) {
+        unsigned e = atomic_load(&snap->epoch);
+        atomic_fetch_add(&snap->readers[e & 1u], 1);
+        if (atomic_load(&snap->epoch) == e) {
+            if (ticket) *ticket = e;
+            return atomic_load(&snap->current);
+        }
+        /* A publisher advanced the epoch meanwhile; register again. */
+        atomic_fetch_sub(&snap->readers[e & 1u], 1);
+    }
+}
+
+void xcdn_snapshot_release(xcdn_snapshot_t *snap, unsigned ticket) {
+    if (!snap) return;
+    atomic_fetch_sub_explicit(&snap->readers[ticket & 1u], 1,
+                              memory_order_release);
+}
+
+void xcdn_snapshot_publish(xcdn_snapshot_t *snap, xcdn_document_t *doc) {
+    if (!snap) return;
+    xcdn_document_freeze(doc);
+
+    while (atomic_flag_test_and_set(&snap->publishing))
+        snapshot_pause();
+
+    xcdn_document_t *old = atomic_exchange(&snap->current, doc);
+    unsigned e = atomic_fetch_add(&snap->epoch, 1);
+    while (atomic_load(&snap->readers[e & 1u]) != 0)
+        snapshot_pause();
+
+    atomic_flag_clear(&snap->publishing);
+    xcdn_document_free(old);
+}
+
+void xcdn_snapshot_free(xcdn_snapshot_t *snap) {
+    if (!snap) return;
+    xcdn_document_free(atomic_load(&snap->current));
+    free(snap);
+}
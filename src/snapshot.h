@@ -0,0 +1,60 @@
+/*
+ * xCDN - eXtensible Cognitive Data Notation (C implementation)
+ * Lock-free snapshot holder for frozen documents.
+ *
+ * A snapshot holder publishes one frozen document to many reader threads
+ * while a writer (e.g. a config reload thread) swaps in replacements:
+ *
+ * - Readers never block and never take locks: acquiring a snapshot is a
+ *   couple of atomic operations, retried only if a swap races with it.
+ * - Publishing freezes the new document, swaps it in atomically, waits
+ *   until every reader still holding the previous document has released
+ *   it, then frees the previous document.
+ *
+ *   unsigned ticket;
+ *   const xcdn_document_t *cfg = xcdn_snapshot_acquire(snap, &ticket);
+ *   ... read cfg ...
+ *   xcdn_snapshot_release(snap, ticket);
+ *
+ * MIT License
+ */
+
+#ifndef XCDN_SNAPSHOT_H
+#define XCDN_SNAPSHOT_H
+
+#include "ast.h"
+
+typedef struct xcdn_snapshot xcdn_snapshot_t;
+
+/*
+ * Create a holder publishing `doc` (may be NULL). The holder takes
+ * ownership of the document and freezes it.
+ * Returns NULL on allocation failure.
+ */
+xcdn_snapshot_t *xcdn_snapshot_new(xcdn_document_t *doc);
+
+/*
+ * Enter a read-side section and return the current document.
+ * The document stays valid until xcdn_snapshot_release() is called with
+ * the returned ticket. Never blocks.
+ */
+const xcdn_document_t *xcdn_snapshot_acquire(xcdn_snapshot_t *snap,
+                                             unsigned *ticket);
+
+/* Leave the read-side section entered with `ticket`. */
+void xcdn_snapshot_release(xcdn_snapshot_t *snap, unsigned ticket);
+
+/*
+ * Freeze `doc`, publish it as the current document, and free the previous
+ * one once all readers that may still see it have released it.
+ * Concurrent publishers are serialized; readers are never blocked.
+ */
+void xcdn_snapshot_publish(xcdn_snapshot_t *snap, xcdn_document_t *doc);
+
+/*
+ * Free the holder and its current document.
+ * No reader may be inside a read-side section.
+ */
+void xcdn_snapshot_free(xcdn_snapshot_t *snap);
+
+#endif /* XCDN_SNAPSHOT_H */
@@ -0,0 +1,205 @@
+/*
+ * xCDN - eXtensible Cognitive Data Notation (C implementation)
+ * Source span side table.
+ *
+ * MIT License
+ */
+
+#include "spans.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/* ── Internal helpers ─────────────────────────────────────────────────── */
+
+static size_t hash_node(const xcdn_node_t *node, size_t mask) {
+    uint64_t h = (uint64_t)(uintptr_t)node >> 4;
+    h *= 0x9E3779B97F4A7C15ull;
+    return (size_t)(h >> 32) & mask;
+}
+
+/* Slot holding `node`'s row, or the empty slot where it would go. */
+static size_t find_slot(const xcdn_span_table_t *t, const xcdn_node_t *node) {
+    size_t mask = t->index_cap - 1;
+    size_t slot = hash_node(node, mask);
+    while (t->index[slot] != 0 && t->nodes[t->index[slot] - 1] != node)
+        slot = (slot + 1) & mask;
+    return slot;
+}
+
+/* Drop removed rows and rebuild the index for at least `want` rows. */
+static bool rebuild(xcdn_span_table_t *t, size_t want) {
+    size_t live = 0;
+    for (size_t i = 0; i < t->len; i++) {
+        if (!t->nodes[i]) continue;
+        t->nodes[live] = t->nodes[i];
+        t->start[live] = t->start[i];
+        t->end[live] = t->end[i];
+        live++;
+    }
+    t->len = live;
+    t->dead = 0;
+
+    size_t cap = 16;
+    while (cap < want * 2) cap *= 2;
+    size_t *index = (size_t *)calloc(cap, sizeof(size_t));
+    if (!index) return false;
+    free(t->index);
+    t->index = index;
+    t->index_cap = cap;
+    for (size_t i = 0; i < t->len; i++)
+        t->index[find_slot(t, t->nodes[i])] = i + 1;
+    return true;
+}
+
+static bool grow_rows(xcdn_span_table_t *t) {
+    size_t new_cap = (t->cap == 0) ? 64 : t->cap * 2;
+    const xcdn_node_t **nodes =
+        (const xcdn_node_t **)realloc(t->nodes, new_cap * sizeof(*nodes));
+    if (!nodes) return false;
+    t->nodes = nodes;
+    size_t *start = (size_t *)realloc(t->start, new_cap * sizeof(size_t));
+    if (!start) return false;
+    t->start = start;
+    size_t *end = (size_t *)realloc(t->end, new_cap * sizeof(size_t));
+    if (!end) return false;
+    t->end = end;
+    t->cap = new_cap;
+    return true;
+}
+
+/* ── Public API ───────────────────────────────────────────────────────── */
+
+xcdn_span_table_t *xcdn_span_table_new(void) {
+    return (xcdn_span_table_t *)calloc(1, sizeof(xcdn_span_table_t));
+}
+
+void xcdn_span_table_free(xcdn_span_table_t *t) {
+    if (!t) return;
+    free(t->nodes);
+    free(t->start);
+    free(t->end);
+    free(t->index);
+    free(t->lines);
+    free(t);
+}
+
+bool xcdn_span_table_set(xcdn_span_table_t *t, const xcdn_node_t *node,
+                         size_t start, size_t end) {
+    if (!t || !node) return false;
+    if (t->index_cap > 0) {
+        size_t slot = find_slot(t, node);
+        if (t->index[slot] != 0) {
+            t->start[t->index[slot] - 1] = start;
+            t->end[t->index[slot] - 1] = end;
+            return true;
+        }
+    }
+    if ((t->len + 1) * 2 > t->index_cap &&
+        !rebuild(t, t->len - t->dead + 1))
+        return false;
+    if (t->len >= t->cap && !grow_rows(t)) return false;
+
+    size_t row = t->len++;
+    t->nodes[row] = node;
+    t->start[row] = start;
+    t->end[row] = end;
+    t->index[find_slot(t, node)] = row + 1;
+    return true;
+}
+
+bool xcdn_span_table_get(const xcdn_span_table_t *t, const xcdn_node_t *node,
+                         size_t *start, size_t *end) {
+    if (!t || !node || t->index_cap == 0) return false;
+    size_t slot = find_slot(t, node);
+    if (t->index[slot] == 0) return false;
+    size_t row = t->index[slot] - 1;
+    if (start) *start = t->start[row];
+    if (end) *end = t->end[row];
+    return true;
+}
+
+void xcdn_span_table_remove(xcdn_span_table_t *t, const xcdn_node_t *node) {
+    if (!t || !node || t->index_cap == 0) return;
+    size_t slot = find_slot(t, node);
+    if (t->index[slot] == 0) return;
+    /* The slot stays occupied by the dead row until the next rebuild. */
+    t->nodes[t->index[slot] - 1] = NULL;
+    t->dead++;
+}
+
+void xcdn_span_table_remove_tree(xcdn_span_table_t *t, const xcdn_node_t *node) {
+    if (!t || !node) return;
+    xcdn_span_table_remove(t, node);
+    const xcdn_value_t *v = node->value;
+    if (!v) return;
+    if (v->type == XCDN_VAL_ARRAY) {
+        for (size_t i = 0; i < v->data.array.len; i++)
+            xcdn_span_table_remove_tree(t, v->data.array.items[i]);
+    } else if (v->type == XCDN_VAL_OBJECT) {
+        for (size_t i = 0; i < v->data.object.len; i++)
+            xcdn_span_table_remove_tree(t, *xcdn_object_slot(v, i));
+    }
+}
+
+void xcdn_span_table_shift(xcdn_span_table_t *t, size_t from, ptrdiff_t delta) {
+    if (!t || delta == 0) return;
+    for (size_t i = 0; i < t->len; i++) {
+        if (t->start[i] >= from) t->start[i] = (size_t)((ptrdiff_t)t->start[i] + delta);
+        if (t->end[i] >= from) t->end[i] = (size_t)((ptrdiff_t)t->end[i] + delta);
+    }
+}
+
+bool xcdn_span_table_merge(xcdn_span_table_t *dst, xcdn_span_table_t *src) {
+    if (!dst || !src) return false;
+    for (size_t i = 0; i < src->len; i++) {
+        if (src->nodes[i] &&
+            !xcdn_span_table_set(dst, src->nodes[i], src->start[i], src->end[i]))
+            return false;
+    }
+    src->len = 0;
+    src->dead = 0;
+    if (src->index) memset(src->index, 0, src->index_cap * sizeof(size_t));
+    return true;
+}
+
+bool xcdn_span_table_index_lines(xcdn_span_table_t *t, const char *src,
+                                 size_t src_len) {
+    if (!t) return false;
+    size_t n = 0, cap = t->lines_len;
+    const char *at = src, *stop = src + src_len;
+    while (at < stop && (at = (const char *)memchr(at, '\n', (size_t)(stop - at)))) {
+        at++;
+        if (n >= cap) {
+            size_t new_cap = (cap == 0) ? 64 : cap * 2;
+            size_t *lines = (size_t *)realloc(t->lines, new_cap * sizeof(size_t));
+            if (!lines) return false;
+            t->lines = lines;
+            cap = new_cap;
+        }
+        t->lines[n++] = (size_t)(at - src);
+    }
+    t->lines_len = n;
+    return true;
+}
+
+xcdn_span_t xcdn_span_table_position(const xcdn_span_table_t *t, size_t offset) {
+    /* Number of line starts at or before `offset` */
+    size_t lo = 0, hi = t ? t->lines_len : 0;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (t->lines[mid] <= offset) lo = mid + 1;
+        else hi = mid;
+    }
+    size_t line_start = (lo == 0) ? 0 : t->lines[lo - 1];
+    return xcdn_span_new(offset, lo + 1, offset - line_start + 1);
+}
+
+bool xcdn_node_span(const xcdn_document_t *doc, const xcdn_node_t *node,
+                    xcdn_span_t *start, xcdn_span_t *end) {
+    size_t s, e;
+    if (!doc || !xcdn_span_table_get(doc->spans, node, &s, &e)) return false;
+    if (start) *start = xcdn_span_table_position(doc->spans, s);
+    if (end) *end = xcdn_span_table_position(doc->spans, e);
+    return true;
+}
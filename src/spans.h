@@ -0,0 +1,89 @@
+/*
+ * xCDN - eXtensible Cognitive Data Notation (C implementation)
+ * Source span side table.
+ *
+ * Maps nodes to the [start, end) byte offsets of their value in the source
+ * text without widening xcdn_node_t. Rows are stored struct-of-arrays and
+ * found through an open-addressing index keyed by node address. A sorted
+ * index of line starts turns offsets into line/column on demand.
+ *
+ * MIT License
+ */
+
+#ifndef XCDN_SPANS_H
+#define XCDN_SPANS_H
+
+#include "ast.h"
+#include "error.h"
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef struct xcdn_span_table {
+    const xcdn_node_t **nodes;   /* NULL marks a removed row */
+    size_t             *start;
+    size_t             *end;
+    size_t              len;
+    size_t              cap;
+    size_t              dead;    /* removed rows still occupying slots */
+    size_t             *index;   /* row + 1 per slot, 0 = empty */
+    size_t              index_cap;
+    size_t             *lines;   /* offset of the first byte of lines 2.. */
+    size_t              lines_len;
+} xcdn_span_table_t;
+
+/* Create an empty table. Returns NULL on allocation failure. */
+xcdn_span_table_t *xcdn_span_table_new(void);
+
+/* Free a table (NULL-safe). */
+void xcdn_span_table_free(xcdn_span_table_t *t);
+
+/* Insert or update the span of a node. Returns false on allocation failure. */
+bool xcdn_span_table_set(xcdn_span_table_t *t, const xcdn_node_t *node,
+                         size_t start, size_t end);
+
+/* Look up a node's span. Returns false if the node has no row. */
+bool xcdn_span_table_get(const xcdn_span_table_t *t, const xcdn_node_t *node,
+                         size_t *start, size_t *end);
+
+/* Remove a node's row, if any. */
+void xcdn_span_table_remove(xcdn_span_table_t *t, const xcdn_node_t *node);
+
+/* Remove the rows of a node and of every node below it. */
+void xcdn_span_table_remove_tree(xcdn_span_table_t *t, const xcdn_node_t *node);
+
+/*
+ * Adjust offsets after a text edit: every start/end at or after `from`
+ * moves by `delta` bytes.
+ */
+void xcdn_span_table_shift(xcdn_span_table_t *t, size_t from, ptrdiff_t delta);
+
+/* Move all rows of `src` into `dst`, leaving `src` empty. */
+bool xcdn_span_table_merge(xcdn_span_table_t *dst, xcdn_span_table_t *src);
+
+/*
+ * Index the line starts of the source text the spans refer to.
+ * Returns false on allocation failure.
+ */
+bool xcdn_span_table_index_lines(xcdn_span_table_t *t, const char *src,
+                                 size_t src_len);
+
+/* Line and column (1-based, in bytes) of a source offset. */
+xcdn_span_t xcdn_span_table_position(const xcdn_span_table_t *t, size_t offset);
+
+/*
+ * Source position of a node's value in a document parsed with
+ * `record_spans`: *start is its first byte, *end the position just past
+ * its last byte. Either pointer may be NULL.
+ * Returns false if the document has no span for the node.
+ *
+ * Spans describe the text as parsed. The tree mutators (xcdn_object_set,
+ * xcdn_object_remove, xcdn_array_splice, ...) do not see the document, so
+ * the rows of nodes they free stay in the table, and a node later
+ * allocated at the same address would report the old position. Only query
+ * unmodified documents, or drop a subtree's rows with
+ * xcdn_span_table_remove_tree(doc->spans, node) before freeing it.
+ */
+bool xcdn_node_span(const xcdn_document_t *doc, const xcdn_node_t *node,
+                    xcdn_span_t *start, xcdn_span_t *end);
+
+#endif /* XCDN_SPANS_H */
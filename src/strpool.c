@@ -0,0 +1,122 @@
+/*
+ * xCDN - eXtensible Cognitive Data Notation (C implementation)
+ * String deduplication pool.
+ *
+ * MIT License
+ */
+
+#include "strpool.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef __STDC_NO_ATOMICS__
+#include <stdatomic.h>
+static atomic_uint next_pool_id = 1;
+#else
+static unsigned next_pool_id = 1;
+#endif
+
+/* Every buffer is preceded by this header. */
+typedef struct {
+    size_t   refs;
+    unsigned pool_id;
+    size_t   len;
+    char     text[];
+} pooled_t;
+
+struct xcdn_strpool {
+    pooled_t **slots;   /* open addressing, NULL = empty */
+    size_t     cap;     /* power of two */
+    size_t     len;
+    unsigned   id;
+};
+
+static pooled_t *header_of(const char *text) {
+    return (pooled_t *)(void *)(text - offsetof(pooled_t, text));
+}
+
+static size_t hash_bytes(const char *s, size_t len) {
+    uint64_t h = 0xcbf29ce484222325ull;   /* FNV-1a */
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 0x100000001b3ull;
+    }
+    return (size_t)(h ^ (h >> 32));
+}
+
+static size_t find_slot(pooled_t **slots, size_t cap, const char *s, size_t len) {
+    size_t mask = cap - 1;
+    size_t i = hash_bytes(s, len) & mask;
+    while (slots[i] &&
+           (slots[i]->len != len || memcmp(slots[i]->text, s, len) != 0))
+        i = (i + 1) & mask;
+    return i;
+}
+
+static bool grow(xcdn_strpool_t *pool) {
+    size_t cap = pool->cap ? pool->cap * 2 : 64;
+    pooled_t **slots = (pooled_t **)calloc(cap, sizeof(*slots));
+    if (!slots) return false;
+    for (size_t i = 0; i < pool->cap; i++) {
+        pooled_t *e = pool->slots[i];
+        if (e) slots[find_slot(slots, cap, e->text, e->len)] = e;
+    }
+    free(pool->slots);
+    pool->slots = slots;
+    pool->cap = cap;
+    return true;
+}
+
+xcdn_strpool_t *xcdn_strpool_new(void) {
+    xcdn_strpool_t *pool = (xcdn_strpool_t *)calloc(1, sizeof(*pool));
+    if (!pool) return NULL;
+#ifndef __STDC_NO_ATOMICS__
+    pool->id = atomic_fetch_add(&next_pool_id, 1);
+#else
+    pool->id = next_pool_id++;
+#endif
+    return pool;
+}
+
+void xcdn_strpool_free(xcdn_strpool_t *pool) {
+    if (!pool) return;
+    for (size_t i = 0; i < pool->cap; i++) {
+        if (pool->slots[i]) xcdn_strpool_release(pool->slots[i]->text);
+    }
+    free(pool->slots);
+    free(pool);
+}
+
+char *xcdn_strpool_intern(xcdn_strpool_t *pool, const char *s, size_t len) {
+    if (!pool) return NULL;
+    if ((pool->len + 1) * 2 > pool->cap && !grow(pool)) return NULL;
+    size_t i = find_slot(pool->slots, pool->cap, s, len);
+    pooled_t *e = pool->slots[i];
+    if (!e) {
+        e = (pooled_t *)malloc(sizeof(pooled_t) + len + 1);
+        if (!e) return NULL;
+        e->refs = 1;   /* the pool's own reference */
+        e->pool_id = pool->id;
+        e->len = len;
+        memcpy(e->text, s, len);
+        e->text[len] = '\0';
+        pool->slots[i] = e;
+        pool->len++;
+    }
+    e->refs++;
+    return e->text;
+}
+
+void xcdn_strpool_release(char *text) {
+    if (!text) return;
+    pooled_t *e = header_of(text);
+    if (--e->refs == 0) free(e);
+}
+
+bool xcdn_strpool_same_pool(const char *a, const char *b) {
+    return a && b && header_of(a)->pool_id == header_of(b)->pool_id;
+}
+
+size_t xcdn_strpool_footprint(const char *text) {
+    return text ? sizeof(pooled_t) + header_of(text)->len + 1 : 0;
+}
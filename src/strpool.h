@@ -0,0 +1,47 @@
+/*
+ * xCDN - eXtensible Cognitive Data Notation (C implementation)
+ * String deduplication pool.
+ *
+ * A pool hands out one shared, immutable, reference-counted buffer per
+ * distinct string, so equal strings interned in the same pool share their
+ * storage and compare equal by pointer. Buffers outlive the pool: each
+ * holder releases its reference with xcdn_strpool_release().
+ *
+ * MIT License
+ */
+
+#ifndef XCDN_STRPOOL_H
+#define XCDN_STRPOOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct xcdn_strpool xcdn_strpool_t;
+
+/* Create an empty pool. Returns NULL on allocation failure. */
+xcdn_strpool_t *xcdn_strpool_new(void);
+
+/* Free the pool (NULL-safe). Interned buffers stay valid while referenced. */
+void xcdn_strpool_free(xcdn_strpool_t *pool);
+
+/*
+ * Return the pool's NUL-terminated buffer equal to the `len` bytes at `s`,
+ * adding it if needed, with one new reference for the caller.
+ * Returns NULL on allocation failure.
+ */
+char *xcdn_strpool_intern(xcdn_strpool_t *pool, const char *s, size_t len);
+
+/* Drop one reference to an interned buffer; the last one frees it. */
+void xcdn_strpool_release(char *text);
+
+/*
+ * True if two interned buffers come from the same pool, in which case
+ * they hold equal strings exactly when the pointers are equal.
+ */
+bool xcdn_strpool_same_pool(const char *a, const char *b);
+
+/* Bytes allocated for an interned buffer, its header included. */
+size_t xcdn_strpool_footprint(const char *text);
+
+#endif /* XCDN_STRPOOL_H */
@@ -0,0 +1,506 @@
+/*
+ * xCDN - eXtensible Cognitive Data Notation (C implementation)
+ * Flattened tape representation.
+ *
+ * MIT License
+ */
+
+#include "tape.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Metadata bits carried by tape entries */
+#define TAPE_FLAGS (XCDN_FLAG_ASCII | XCDN_FLAG_PLAIN | XCDN_FLAG_IDENT | \
+                    XCDN_FLAG_SCANNED | XCDN_FLAG_RAW_NUMBER)
+
+/* ── Building ─────────────────────────────────────────────────────────── */
+
+typedef struct {
+    xcdn_tape_t *tape;
+    bool         failed;
+} tape_builder_t;
+
+/* Append an entry; returns its index (meaningless once failed). */
+static size_t tape_push(tape_builder_t *b, uint8_t type, uint32_t flags,
+                        size_t count, uint64_t payload) {
+    xcdn_tape_t *t = b->tape;
+    if (b->failed) return 0;
+    if (count > UINT32_MAX) {
+        b->failed = true;
+        return 0;
+    }
+    if (t->len >= t->cap) {
+        size_t cap = t->cap ? t->cap * 2 : 256;
+        xcdn_tape_entry_t *e =
+            (xcdn_tape_entry_t *)realloc(t->entries, cap * sizeof(*e));
+        if (!e) {
+            b->failed = true;
+            return 0;
+        }
+        t->entries = e;
+        t->cap = cap;
+    }
+    xcdn_tape_entry_t *e = &t->entries[t->len];
+    e->type = type;
+    e->flags = (uint8_t)(flags & TAPE_FLAGS);
+    e->reserved = 0;
+    e->count = (uint32_t)count;
+    e->payload = payload;
+    return t->len++;
+}
+
+/* Copy `len` bytes plus a NUL into the side buffer; returns their offset. */
+static uint64_t tape_text(tape_builder_t *b, const void *s, size_t len) {
+    xcdn_tape_t *t = b->tape;
+    if (b->failed) return 0;
+    if (t->strings_len + len + 1 > t->strings_cap) {
+        size_t cap = t->strings_cap ? t->strings_cap : 1024;
+        while (cap < t->strings_len + len + 1) cap *= 2;
+        char *buf = (char *)realloc(t->strings, cap);
+        if (!buf) {
+            b->failed = true;
+            return 0;
+        }
+        t->strings = buf;
+        t->strings_cap = cap;
+    }
+    uint64_t at = t->strings_len;
+    if (len > 0) memcpy(t->strings + at, s, len);
+    t->strings[at + len] = '\0';
+    t->strings_len += len + 1;
+    return at;
+}
+
+static void tape_string(tape_builder_t *b, uint8_t type, uint32_t flags,
+                        const char *s, size_t len) {
+    uint64_t at = tape_text(b, s, len);
+    tape_push(b, type, flags, len, at);
+}
+
+static void build_node(tape_builder_t *b, const xcdn_node_t *node);
+
+static void build_value(tape_builder_t *b, const xcdn_value_t *val) {
+    if (!val) {
+        tape_push(b, XCDN_VAL_NULL, 0, 0, 0);
+        return;
+    }
+    uint64_t bits = 0;
+    size_t len = 0;
+    const char *text;
+    switch (val->type) {
+        case XCDN_VAL_NULL:
+            tape_push(b, XCDN_VAL_NULL, 0, 0, 0);
+            break;
+        case XCDN_VAL_BOOL:
+            tape_push(b, XCDN_VAL_BOOL, 0, 0, val->data.boolean ? 1 : 0);
+            break;
+        case XCDN_VAL_INT:
+        case XCDN_VAL_FLOAT:
+            if (val->type == XCDN_VAL_INT) {
+                int64_t i = xcdn_value_as_int(val);
+                memcpy(&bits, &i, sizeof(bits));
+            } else {
+                double d = xcdn_value_as_float(val);
+                memcpy(&bits, &d, sizeof(bits));
+            }
+            text = xcdn_value_number_text(val, &len);
+            tape_push(b, (uint8_t)val->type, val->flags, 0, bits);
+            if (text) tape_string(b, XCDN_TAPE_TEXT, 0, text, len);
+            break;
+        case XCDN_VAL_STRING:
+        case XCDN_VAL_DECIMAL:
+        case XCDN_VAL_DATETIME:
+        case XCDN_VAL_DURATION:
+        case XCDN_VAL_UUID:
+            text = val->data.string ? val->data.string : "";
+            len = (val->flags & XCDN_FLAG_SCANNED) ? val->data.string_len
+                                                   : strlen(text);
+            tape_string(b, (uint8_t)val->type, val->flags, text, len);
+            break;
+        case XCDN_VAL_BYTES: {
+            const uint8_t *data = xcdn_value_as_bytes(val, &len);
+            uint64_t at = tape_text(b, data, data ? len : 0);
+            tape_push(b, XCDN_VAL_BYTES, 0, data ? len : 0, at);
+            break;
+        }
+        case XCDN_VAL_ARRAY:
+        case XCDN_VAL_OBJECT: {
+            bool is_object = val->type == XCDN_VAL_OBJECT;
+            size_t n = is_object ? val->data.object.len : val->data.array.len;
+            size_t start = tape_push(b, (uint8_t)val->type, 0, n, 0);
+            for (size_t i = 0; i < n && !b->failed; i++) {
+                if (is_object) {
+                    const xcdn_object_entry_t *e = xcdn_object_key_entry(val, i);
+                    tape_string(b, XCDN_TAPE_KEY, e->key_flags,
+                                xcdn_entry_key(e), e->key_len);
+                    build_node(b, *xcdn_object_slot(val, i));
+                } else {
+                    build_node(b, val->data.array.items[i]);
+                }
+            }
+            tape_push(b, XCDN_TAPE_END, 0, 0, start);
+            if (!b->failed) b->tape->entries[start].payload = b->tape->len;
+            break;
+        }
+    }
+}
+
+static void build_node(tape_builder_t *b, const xcdn_node_t *node) {
+    if (!node) {
+        tape_push(b, XCDN_VAL_NULL, 0, 0, 0);
+        return;
+    }
+    for (size_t i = 0; i < node->annotations_len; i++) {
+        const xcdn_annotation_t *a = &node->annotations[i];
+        uint64_t at = tape_text(b, a->name, strlen(a->name));
+        tape_push(b, XCDN_TAPE_ANNOTATION, 0, a->args_len, at);
+        for (size_t j = 0; j < a->args_len; j++)
+            build_value(b, a->args[j]);
+    }
+    for (size_t i = 0; i < node->tags_len; i++) {
+        const char *name = node->tags[i].name;
+        tape_string(b, XCDN_TAPE_TAG, 0, name, strlen(name));
+    }
+    build_value(b, node->value);
+}
+
+xcdn_tape_t *xcdn_tape_from_document(const xcdn_document_t *doc) {
+    if (!doc) return NULL;
+    xcdn_tape_t *tape = (xcdn_tape_t *)calloc(1, sizeof(xcdn_tape_t));
+    if (!tape) return NULL;
+    tape_builder_t b = { tape, false };
+    for (size_t i = 0; i < doc->prolog_len; i++) {
+        const char *name = doc->prolog[i].name;
+        tape_string(&b, XCDN_TAPE_DIRECTIVE, 0, name, strlen(name));
+        build_value(&b, doc->prolog[i].value);
+    }
+    tape->body = tape->len;
+    for (size_t i = 0; i < doc->values_len; i++)
+        build_node(&b, doc->values[i]);
+    tape->values_len = doc->values_len;
+    if (b.failed) {
+        xcdn_tape_free(tape);
+        return NULL;
+    }
+    return tape;
+}
+
+void xcdn_tape_free(xcdn_tape_t *tape) {
+    if (!tape) return;
+    free(tape->entries);
+    free(tape->strings);
+    free(tape);
+}
+
+/* ── Navigation helpers ───────────────────────────────────────────────── */
+
+/* Index just past the value starting at `at`. */
+static size_t skip_value(const xcdn_tape_t *t, size_t at) {
+    const xcdn_tape_entry_t *e = &t->entries[at];
+    if (e->type == XCDN_VAL_ARRAY || e->type == XCDN_VAL_OBJECT)
+        return (size_t)e->payload;
+    if (e->flags & XCDN_FLAG_RAW_NUMBER) return at + 2;   /* TEXT follows */
+    return at + 1;
+}
+
+/* Index of the value of the node starting at `at`, past its decorations. */
+static size_t skip_decorations(const xcdn_tape_t *t, size_t at) {
+    for (;;) {
+        const xcdn_tape_entry_t *e = &t->entries[at];
+        if (e->type == XCDN_TAPE_TAG) {
+            at++;
+        } else if (e->type == XCDN_TAPE_ANNOTATION) {
+            at++;
+            for (uint32_t i = 0; i < e->count; i++) at = skip_value(t, at);
+        } else {
+            return at;
+        }
+    }
+}
+
+static const xcdn_tape_entry_t *value_entry(const xcdn_tape_cursor_t *cur) {
+    if (!cur || !cur->tape || cur->at >= cur->end) return NULL;
+    return &cur->tape->entries[skip_decorations(cur->tape, cur->at)];
+}
+
+static const char *entry_text(const xcdn_tape_t *t, const xcdn_tape_entry_t *e) {
+    return t->strings + e->payload;
+}
+
+/* ── Cursor ───────────────────────────────────────────────────────────── */
+
+bool xcdn_tape_begin(const xcdn_tape_t *tape, xcdn_tape_cursor_t *cur) {
+    if (!tape || !cur || tape->body >= tape->len) return false;
+    cur->tape = tape;
+    cur->at = tape->body;
+    cur->end = tape->len;
+    return true;
+}
+
+bool xcdn_tape_next(xcdn_tape_cursor_t *cur) {
+    if (!cur || !cur->tape || cur->at >= cur->end) return false;
+    const xcdn_tape_t *t = cur->tape;
+    size_t at = skip_value(t, skip_decorations(t, cur->at));
+    if (at < cur->end && t->entries[at].type == XCDN_TAPE_KEY) at++;
+    if (at >= cur->end) return false;
+    cur->at = at;
+    return true;
+}
+
+bool xcdn_tape_down(xcdn_tape_cursor_t *cur) {
+    const xcdn_tape_entry_t *e = value_entry(cur);
+    if (!e || (e->type != XCDN_VAL_ARRAY && e->type != XCDN_VAL_OBJECT) ||
+        e->count == 0)
+        return false;
+    size_t start = (size_t)(e - cur->tape->entries);
+    cur->at = start + (e->type == XCDN_VAL_OBJECT ? 2 : 1);
+    cur->end = (size_t)e->payload - 1;
+    return true;
+}
+
+bool xcdn_tape_find(const xcdn_tape_cursor_t *cur, const char *key,
+                    xcdn_tape_cursor_t *child) {
+    if (!key || xcdn_tape_type(cur) != XCDN_VAL_OBJECT) return false;
+    xcdn_tape_cursor_t c = *cur;
+    if (!xcdn_tape_down(&c)) return false;
+    size_t len = strlen(key);
+    do {
+        const xcdn_tape_entry_t *k = &c.tape->entries[c.at - 1];
+        if (k->count == len && memcmp(entry_text(c.tape, k), key, len) == 0) {
+            if (child) *child = c;
+            return true;
+        }
+    } while (xcdn_tape_next(&c));
+    return false;
+}
+
+xcdn_value_type_t xcdn_tape_type(const xcdn_tape_cursor_t *cur) {
+    const xcdn_tape_entry_t *e = value_entry(cur);
+    return e ? (xcdn_value_type_t)e->type : XCDN_VAL_NULL;
+}
+
+size_t xcdn_tape_len(const xcdn_tape_cursor_t *cur) {
+    const xcdn_tape_entry_t *e = value_entry(cur);
+    if (!e || (e->type != XCDN_VAL_ARRAY && e->type != XCDN_VAL_OBJECT)) return 0;
+    return e->count;
+}
+
+const char *xcdn_tape_key(const xcdn_tape_cursor_t *cur, size_t *len) {
+    if (!cur || !cur->tape || cur->at == 0 || cur->at >= cur->end ||
+        cur->tape->entries[cur->at - 1].type != XCDN_TAPE_KEY) {
+        if (len) *len = 0;
+        return NULL;
+    }
+    const xcdn_tape_entry_t *k = &cur->tape->entries[cur->at - 1];
+    if (len) *len = k->count;
+    return entry_text(cur->tape, k);
+}
+
+int64_t xcdn_tape_as_int(const xcdn_tape_cursor_t *cur) {
+    const xcdn_tape_entry_t *e = value_entry(cur);
+    if (!e || e->type != XCDN_VAL_INT) return 0;
+    int64_t i;
+    memcpy(&i, &e->payload, sizeof(i));
+    return i;
+}
+
+double xcdn_tape_as_float(const xcdn_tape_cursor_t *cur) {
+    const xcdn_tape_entry_t *e = value_entry(cur);
+    if (!e || e->type != XCDN_VAL_FLOAT) return 0.0;
+    double d;
+    memcpy(&d, &e->payload, sizeof(d));
+    return d;
+}
+
+bool xcdn_tape_as_bool(const xcdn_tape_cursor_t *cur) {
+    const xcdn_tape_entry_t *e = value_entry(cur);
+    return e && e->type == XCDN_VAL_BOOL && e->payload != 0;
+}
+
+const char *xcdn_tape_as_string(const xcdn_tape_cursor_t *cur, size_t *len) {
+    const xcdn_tape_entry_t *e = value_entry(cur);
+    if (!e || (e->type != XCDN_VAL_STRING && e->type != XCDN_VAL_DECIMAL &&
+               e->type != XCDN_VAL_DATETIME && e->type != XCDN_VAL_DURATION &&
+               e->type != XCDN_VAL_UUID)) {
+        if (len) *len = 0;
+        return NULL;
+    }
+    if (len) *len = e->count;
+    return entry_text(cur->tape, e);
+}
+
+const uint8_t *xcdn_tape_as_bytes(const xcdn_tape_cursor_t *cur, size_t *len) {
+    const xcdn_tape_entry_t *e = value_entry(cur);
+    if (!e || e->type != XCDN_VAL_BYTES) {
+        if (len) *len = 0;
+        return NULL;
+    }
+    if (len) *len = e->count;
+    return (const uint8_t *)entry_text(cur->tape, e);
+}
+
+/* Check the decorations of the node at `cur` for a name. */
+static bool has_decoration(const xcdn_tape_cursor_t *cur, uint8_t type,
+                           const char *name) {
+    if (!cur || !cur->tape || !name || cur->at >= cur->end) return false;
+    const xcdn_tape_t *t = cur->tape;
+    size_t at = cur->at;
+    for (;;) {
+        const xcdn_tape_entry_t *e = &t->entries[at];
+        if (e->type != XCDN_TAPE_TAG && e->type != XCDN_TAPE_ANNOTATION)
+            return false;
+        if (e->type == type && strcmp(entry_text(t, e), name) == 0) return true;
+        at++;
+        if (e->type == XCDN_TAPE_ANNOTATION) {
+            for (uint32_t i = 0; i < e->count; i++) at = skip_value(t, at);
+        }
+    }
+}
+
+bool xcdn_tape_has_tag(const xcdn_tape_cursor_t *cur, const char *name) {
+    return has_decoration(cur, XCDN_TAPE_TAG, name);
+}
+
+bool xcdn_tape_has_annotation(const xcdn_tape_cursor_t *cur, const char *name) {
+    return has_decoration(cur, XCDN_TAPE_ANNOTATION, name);
+}
+
+/* ── Conversion back to a document ────────────────────────────────────── */
+
+static xcdn_node_t *read_node(const xcdn_tape_t *t, size_t *at);
+
+static xcdn_value_t *read_value(const xcdn_tape_t *t, size_t *at) {
+    const xcdn_tape_entry_t *e = &t->entries[(*at)++];
+    xcdn_value_t *val = NULL;
+    switch (e->type) {
+        case XCDN_VAL_NULL:
+            return xcdn_value_null();
+        case XCDN_VAL_BOOL:
+            return xcdn_value_bool(e->payload != 0);
+        case XCDN_VAL_INT:
+        case XCDN_VAL_FLOAT:
+            if (e->flags & XCDN_FLAG_RAW_NUMBER) {
+                const xcdn_tape_entry_t *src = &t->entries[(*at)++];
+                return xcdn_value_number_raw(t->strings + src->payload, src->count,
+                                             e->type == XCDN_VAL_FLOAT);
+            }
+            if (e->type == XCDN_VAL_INT) {
+                int64_t i;
+                memcpy(&i, &e->payload, sizeof(i));
+                return xcdn_value_int(i);
+            } else {
+                double d;
+                memcpy(&d, &e->payload, sizeof(d));
+                return xcdn_value_float(d);
+            }
+        case XCDN_VAL_STRING:
+            if (e->flags & XCDN_FLAG_SCANNED) {
+                char *copy = (char *)malloc((size_t)e->count + 1);
+                if (!copy) return NULL;
+                memcpy(copy, entry_text(t, e), (size_t)e->count + 1);
+                return xcdn_value_string_scanned(copy, e->count, e->flags);
+            }
+            return xcdn_value_string(entry_text(t, e));
+        case XCDN_VAL_DECIMAL:
+            return xcdn_value_decimal(entry_text(t, e));
+        case XCDN_VAL_DATETIME:
+            return xcdn_value_datetime(entry_text(t, e));
+        case XCDN_VAL_DURATION:
+            return xcdn_value_duration(entry_text(t, e));
+        case XCDN_VAL_UUID:
+            return xcdn_value_uuid(entry_text(t, e));
+        case XCDN_VAL_BYTES:
+            return xcdn_value_bytes((const uint8_t *)entry_text(t, e), e->count);
+        case XCDN_VAL_ARRAY:
+            if (!(val = xcdn_value_array()) || !xcdn_array_reserve(val, e->count)) {
+                xcdn_value_free(val);
+                return NULL;
+            }
+            for (uint32_t i = 0; i < e->count; i++) {
+                xcdn_node_t *child = read_node(t, at);
+                if (!child) {
+                    xcdn_value_free(val);
+                    return NULL;
+                }
+                xcdn_array_push(val, child);
+            }
+            (*at)++;   /* END */
+            return val;
+        case XCDN_VAL_OBJECT:
+            if (!(val = xcdn_value_object()) || !xcdn_object_reserve(val, e->count)) {
+                xcdn_value_free(val);
+                return NULL;
+            }
+            for (uint32_t i = 0; i < e->count; i++) {
+                /* Keys come from a document, so they are already unique */
+                const xcdn_tape_entry_t *k = &t->entries[(*at)++];
+                xcdn_node_t *child = read_node(t, at);
+                if (!child || !xcdn_object_append(val, t->strings + k->payload,
+                                                  k->count, k->flags, child)) {
+                    xcdn_node_free(child);
+                    xcdn_value_free(val);
+                    return NULL;
+                }
+            }
+            (*at)++;   /* END */
+            return val;
+        default:
+            return NULL;
+    }
+}
+
+static xcdn_node_t *read_node(const xcdn_tape_t *t, size_t *at) {
+    xcdn_node_t *node = xcdn_node_new(NULL);
+    if (!node) return NULL;
+    for (;;) {
+        const xcdn_tape_entry_t *e = &t->entries[*at];
+        if (e->type == XCDN_TAPE_TAG) {
+            xcdn_node_add_tag(node, t->strings + e->payload);
+            (*at)++;
+        } else if (e->type == XCDN_TAPE_ANNOTATION) {
+            xcdn_node_add_annotation(node, t->strings + e->payload);
+            (*at)++;
+            xcdn_annotation_t *a = &node->annotations[node->annotations_len - 1];
+            for (uint32_t i = 0; i < e->count; i++) {
+                xcdn_value_t *arg = read_value(t, at);
+                if (!arg) {
+                    xcdn_node_free(node);
+                    return NULL;
+                }
+                xcdn_annotation_push_arg(a, arg);
+            }
+        } else {
+            break;
+        }
+    }
+    if (!(node->value = read_value(t, at))) {
+        xcdn_node_free(node);
+        return NULL;
+    }
+    return node;
+}
+
+xcdn_document_t *xcdn_tape_to_document(const xcdn_tape_t *tape) {
+    if (!tape) return NULL;
+    xcdn_document_t *doc = xcdn_document_new();
+    if (!doc) return NULL;
+    size_t at = 0;
+    while (at < tape->body) {
+        const char *name = tape->strings + tape->entries[at++].payload;
+        xcdn_value_t *val = read_value(tape, &at);
+        if (!val) {
+            xcdn_document_free(doc);
+            return NULL;
+        }
+        xcdn_document_push_directive(doc, name, val);
+    }
+    for (size_t i = 0; i < tape->values_len; i++) {
+        xcdn_node_t *node = read_node(tape, &at);
+        if (!node) {
+            xcdn_document_free(doc);
+            return NULL;
+        }
+        xcdn_document_push_value(doc, node);
+    }
+    return doc;
+}
@@ -0,0 +1,147 @@
+/*
+ * xCDN - eXtensible Cognitive Data Notation (C implementation)
+ * Flattened tape representation.
+ *
+ * A tape is a read-only copy of a document laid out as one contiguous
+ * array of fixed-size entries in pre-order, plus one side buffer holding
+ * every string, key and byte payload. Containers record the index just
+ * past their closing entry, so a subtree is skipped in O(1), and full
+ * scans walk memory sequentially instead of chasing node pointers.
+ *
+ * Layout of a node: its annotations (each followed by its argument
+ * values), then its tags, then its value. An array is an ARRAY entry, its
+ * child nodes and an END entry; an object interleaves a KEY entry before
+ * each child node. The prolog comes first, as DIRECTIVE entries each
+ * followed by a value.
+ *
+ *   xcdn_tape_t *tape = xcdn_tape_from_document(doc);
+ *   xcdn_tape_cursor_t row;
+ *   if (xcdn_tape_begin(tape, &row) && xcdn_tape_down(&row)) {
+ *       do { total += xcdn_tape_as_int(&row); } while (xcdn_tape_next(&row));
+ *   }
+ *
+ * MIT License
+ */
+
+#ifndef XCDN_TAPE_H
+#define XCDN_TAPE_H
+
+#include "ast.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Entry types beyond the value types: a value entry's `type` is its
+ * xcdn_value_type_t.
+ */
+enum {
+    XCDN_TAPE_END = 0x10,   /* closes an array/object; payload = its start */
+    XCDN_TAPE_KEY,          /* object key of the node that follows */
+    XCDN_TAPE_TAG,
+    XCDN_TAPE_ANNOTATION,   /* count = number of argument values following */
+    XCDN_TAPE_DIRECTIVE,    /* prolog directive; its value follows */
+    XCDN_TAPE_TEXT,         /* source text of the number before it */
+};
+
+/*
+ * One tape entry.
+ * - NULL/BOOL/INT/FLOAT: payload holds the value bits. A number with
+ *   XCDN_FLAG_RAW_NUMBER in `flags` is followed by a TEXT entry.
+ * - Strings, typed strings, bytes, keys, tags, TEXT: payload is the offset
+ *   of the NUL-terminated payload in the side buffer, count its length.
+ * - ARRAY/OBJECT: count = number of children, payload = index just past
+ *   the matching END entry.
+ * - ANNOTATION/DIRECTIVE: payload is the offset of the name.
+ */
+typedef struct {
+    uint8_t  type;
+    uint8_t  flags;     /* XCDN_FLAG_* string and number metadata */
+    uint16_t reserved;
+    uint32_t count;
+    uint64_t payload;
+} xcdn_tape_entry_t;
+
+typedef struct xcdn_tape {
+    xcdn_tape_entry_t *entries;
+    size_t             len;
+    size_t             cap;
+    char              *strings;      /* side buffer */
+    size_t             strings_len;
+    size_t             strings_cap;
+    size_t             body;         /* index of the first top-level node */
+    size_t             values_len;   /* number of top-level nodes */
+} xcdn_tape_t;
+
+/*
+ * Position of a node on a tape: `at` is its first entry, `end` the end of
+ * the sequence of siblings it belongs to.
+ */
+typedef struct {
+    const xcdn_tape_t *tape;
+    size_t             at;
+    size_t             end;
+} xcdn_tape_cursor_t;
+
+/*
+ * Build the tape of a document. Lazy bytes are stored decoded; numbers
+ * kept as text keep that text next to their converted value.
+ * Returns NULL on allocation failure or if a single payload exceeds 4 GiB.
+ */
+xcdn_tape_t *xcdn_tape_from_document(const xcdn_document_t *doc);
+
+/*
+ * Rebuild a document from a tape.
+ * Returns NULL on allocation failure.
+ */
+xcdn_document_t *xcdn_tape_to_document(const xcdn_tape_t *tape);
+
+/* Free a tape (NULL-safe). */
+void xcdn_tape_free(xcdn_tape_t *tape);
+
+/* ── Cursor ───────────────────────────────────────────────────────────── */
+
+/* Point `cur` at the first top-level node. Returns false if there is none. */
+bool xcdn_tape_begin(const xcdn_tape_t *tape, xcdn_tape_cursor_t *cur);
+
+/* Move to the next sibling. Returns false (leaving `cur`) at the last one. */
+bool xcdn_tape_next(xcdn_tape_cursor_t *cur);
+
+/*
+ * Move to the first child of an array/object node.
+ * Returns false (leaving `cur`) for scalars and empty containers.
+ */
+bool xcdn_tape_down(xcdn_tape_cursor_t *cur);
+
+/*
+ * Point `child` at the node stored under `key` in the object at `cur`.
+ * Returns false if `cur` is not an object or has no such key.
+ */
+bool xcdn_tape_find(const xcdn_tape_cursor_t *cur, const char *key,
+                    xcdn_tape_cursor_t *child);
+
+/* Value type of the node at `cur`. */
+xcdn_value_type_t xcdn_tape_type(const xcdn_tape_cursor_t *cur);
+
+/* Number of children of an array/object node (0 for scalars). */
+size_t xcdn_tape_len(const xcdn_tape_cursor_t *cur);
+
+/* Key of a node inside an object, or NULL. *len may be NULL. */
+const char *xcdn_tape_key(const xcdn_tape_cursor_t *cur, size_t *len);
+
+/* Typed access, with the same fallbacks as the xcdn_value_as_* accessors. */
+int64_t xcdn_tape_as_int(const xcdn_tape_cursor_t *cur);
+double xcdn_tape_as_float(const xcdn_tape_cursor_t *cur);
+bool xcdn_tape_as_bool(const xcdn_tape_cursor_t *cur);
+
+/* String payload of a string-like node, or NULL. *len may be NULL. */
+const char *xcdn_tape_as_string(const xcdn_tape_cursor_t *cur, size_t *len);
+
+/* Decoded payload of a bytes node, or NULL. *len may be NULL. */
+const uint8_t *xcdn_tape_as_bytes(const xcdn_tape_cursor_t *cur, size_t *len);
+
+/* Check whether the node at `cur` has a tag / an annotation by that name. */
+bool xcdn_tape_has_tag(const xcdn_tape_cursor_t *cur, const char *name);
+bool xcdn_tape_has_annotation(const xcdn_tape_cursor_t *cur, const char *name);
+
+#endif /* XCDN_TAPE_H */
@@ -0,0 +1,62 @@
+/*
+ * xCDN - eXtensible Cognitive Data Notation (C implementation)
+ * UTF-8 validation.
+ *
+ * MIT License
+ */
+
+#include "utf8.h"
+#include <stdint.h>
+#include <string.h>
+
+#define HIGH_BITS 0x8080808080808080ull
+
+/* Index of the first non-ASCII byte at or after `i`, or `len`. */
+static size_t skip_ascii(const unsigned char *p, size_t i, size_t len) {
+    while (i + 8 <= len) {
+        uint64_t w;
+        memcpy(&w, p + i, sizeof(w));
+        if (w & HIGH_BITS) break;
+        i += 8;
+    }
+    while (i < len && p[i] < 0x80) i++;
+    return i;
+}
+
+xcdn_utf8_status_t xcdn_utf8_validate(const char *s, size_t len, size_t *bad) {
+    const unsigned char *p = (const unsigned char *)s;
+    xcdn_utf8_status_t status = XCDN_UTF8_ASCII;
+    size_t i = skip_ascii(p, 0, len);
+
+    while (i < len) {
+        unsigned char c = p[i];
+        size_t n;                      /* continuation bytes */
+        unsigned char lo = 0x80, hi = 0xBF;   /* range of the first one */
+
+        if (c >= 0xC2 && c <= 0xDF)      n = 1;
+        else if (c == 0xE0)            { n = 2; lo = 0xA0; }   /* no overlongs */
+        else if (c == 0xED)            { n = 2; hi = 0x9F; }   /* no surrogates */
+        else if (c >= 0xE1 && c <= 0xEF) n = 2;
+        else if (c == 0xF0)            { n = 3; lo = 0x90; }   /* no overlongs */
+        else if (c == 0xF4)            { n = 3; hi = 0x8F; }   /* <= U+10FFFF */
+        else if (c >= 0xF1 && c <= 0xF3) n = 3;
+        else goto invalid;
+
+        if (n >= len - i) goto invalid;
+        if (p[i + 1] < lo || p[i + 1] > hi) goto invalid;
+        for (size_t k = 2; k <= n; k++)
+            if ((p[i + k] & 0xC0) != 0x80) goto invalid;
+
+        status = XCDN_UTF8_VALID;
+        i = skip_ascii(p, i + n + 1, len);
+    }
+    return status;
+
+invalid:
+    if (bad) *bad = i;
+    return XCDN_UTF8_INVALID;
+}
+
+bool xcdn_utf8_is_ascii(const char *s, size_t len) {
+    return skip_ascii((const unsigned char *)s, 0, len) == len;
+}
@@ -0,0 +1,33 @@
+/*
+ * xCDN - eXtensible Cognitive Data Notation (C implementation)
+ * UTF-8 validation.
+ *
+ * Strict RFC 3629 validation: overlong forms, UTF-16 surrogates and code
+ * points above U+10FFFF are rejected. ASCII runs are skipped eight bytes
+ * at a time, so mostly-ASCII text costs little more than a read.
+ *
+ * MIT License
+ */
+
+#ifndef XCDN_UTF8_H
+#define XCDN_UTF8_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef enum {
+    XCDN_UTF8_ASCII = 0,   /* valid, and every byte is below 0x80 */
+    XCDN_UTF8_VALID,       /* valid, with multi-byte sequences */
+    XCDN_UTF8_INVALID,
+} xcdn_utf8_status_t;
+
+/*
+ * Validate `len` bytes of `s`. On XCDN_UTF8_INVALID, *bad (if non-NULL)
+ * receives the offset of the first byte of the offending sequence.
+ */
+xcdn_utf8_status_t xcdn_utf8_validate(const char *s, size_t len, size_t *bad);
+
+/* True if all `len` bytes of `s` are ASCII. */
+bool xcdn_utf8_is_ascii(const char *s, size_t len);
+
+#endif /* XCDN_UTF8_H */
@@ -0,0 +1,138 @@
+/*
+ * xCDN - eXtensible Cognitive Data Notation (C implementation)
+ * Depth-first document walker.
+ *
+ * MIT License
+ */
+
+#include "walk.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define walk_prefetch(p) __builtin_prefetch(p)
+#else
+#define walk_prefetch(p) ((void)(p))
+#endif
+
+static bool grow(xcdn_walk_t *w) {
+    size_t cap = w->cap ? w->cap * 2 : 32;
+    xcdn_walk_frame_t *f =
+        (xcdn_walk_frame_t *)realloc(w->frames, cap * sizeof(*f));
+    if (!f) {
+        w->failed = true;
+        return false;
+    }
+    w->frames = f;
+    w->cap = cap;
+    return true;
+}
+
+/* Child i of an array frame (items set) or an object frame. */
+static inline const xcdn_node_t *frame_node(const xcdn_walk_frame_t *f, size_t i) {
+    return f->items ? f->items[i] : *xcdn_object_slot(f->value, i);
+}
+
+static void start(xcdn_walk_t *w, xcdn_node_t *const *items, size_t len) {
+    memset(w, 0, sizeof(*w));
+    if (!grow(w)) return;
+    xcdn_walk_frame_t *f = &w->frames[w->len++];
+    memset(f, 0, sizeof(*f));
+    f->items = items;
+    f->len = len;
+    if (len > 0) walk_prefetch(items[0]);
+}
+
+/* ── Public API ───────────────────────────────────────────────────────── */
+
+void xcdn_walk_begin(xcdn_walk_t *w, const xcdn_document_t *doc) {
+    if (!w) return;
+    start(w, doc ? doc->values : NULL, doc ? doc->values_len : 0);
+}
+
+void xcdn_walk_begin_node(xcdn_walk_t *w, const xcdn_node_t *node) {
+    if (!w) return;
+    start(w, NULL, 0);
+    if (w->len == 0 || !node) return;
+    w->root = (xcdn_node_t *)node;
+    w->frames[0].items = &w->root;
+    w->frames[0].len = 1;
+}
+
+bool xcdn_walk_next(xcdn_walk_t *w, xcdn_walk_event_t *ev) {
+    if (!w || !ev || w->len == 0) return false;
+    xcdn_walk_frame_t *top = &w->frames[w->len - 1];
+
+    if (top->next < top->len) {
+        /* Enter the next child of the current node */
+        size_t i = top->next++;
+        const xcdn_node_t *child = frame_node(top, i);
+        const char *key = NULL;
+        size_t key_len = 0;
+        if (!top->items) {
+            const xcdn_object_entry_t *e = xcdn_object_key_entry(top->value, i);
+            key = xcdn_entry_key(e);
+            key_len = e->key_len;
+        }
+        if (top->next < top->len) walk_prefetch(frame_node(top, top->next));
+
+        const xcdn_value_t *v = child ? child->value : NULL;
+        size_t depth = w->len - 1;
+        if (w->len == w->cap) {
+            if (!grow(w)) return false;
+        }
+        xcdn_walk_frame_t *f = &w->frames[w->len++];
+        f->node = child;
+        f->value = v;
+        f->items = NULL;
+        f->len = 0;
+        f->next = 0;
+        f->key = key;
+        f->key_len = key_len;
+        f->index = i;
+        if (v && v->type == XCDN_VAL_ARRAY) {
+            f->items = v->data.array.items;
+            f->len = v->data.array.len;
+        } else if (v && v->type == XCDN_VAL_OBJECT) {
+            f->len = v->data.object.len;
+        }
+        if (f->len > 0) {
+            const xcdn_node_t *first = frame_node(f, 0);
+            walk_prefetch(first);
+            if (first) walk_prefetch(first->value);
+        }
+
+        ev->kind = XCDN_WALK_ENTER;
+        ev->node = child;
+        ev->value = v;
+        ev->key = key;
+        ev->key_len = key_len;
+        ev->index = i;
+        ev->depth = depth;
+        return true;
+    }
+
+    /* The bottom frame stands for the document and is never left */
+    if (w->len == 1) return false;
+    w->len--;
+    ev->kind = XCDN_WALK_LEAVE;
+    ev->node = top->node;
+    ev->value = top->value;
+    ev->key = top->key;
+    ev->key_len = top->key_len;
+    ev->index = top->index;
+    ev->depth = w->len - 1;
+    return true;
+}
+
+void xcdn_walk_skip(xcdn_walk_t *w) {
+    if (!w || w->len < 2) return;
+    xcdn_walk_frame_t *top = &w->frames[w->len - 1];
+    top->next = top->len;
+}
+
+void xcdn_walk_end(xcdn_walk_t *w) {
+    if (!w) return;
+    free(w->frames);
+    memset(w, 0, sizeof(*w));
+}
@@ -0,0 +1,89 @@
+/*
+ * xCDN - eXtensible Cognitive Data Notation (C implementation)
+ * Depth-first document walker.
+ *
+ * Visits every node of a document (or of one subtree) in document order
+ * without recursion: each node yields an ENTER event, then the events of
+ * its children, then a LEAVE event. The walker keeps its own stack, so
+ * depth is bounded only by memory, and prefetches the nodes it will visit
+ * next while the caller handles the current one.
+ *
+ *   xcdn_walk_t w;
+ *   xcdn_walk_event_t ev;
+ *   xcdn_walk_begin(&w, doc);
+ *   while (xcdn_walk_next(&w, &ev)) {
+ *       if (ev.kind == XCDN_WALK_ENTER && xcdn_node_has_tag(ev.node, "secret"))
+ *           xcdn_walk_skip(&w);
+ *   }
+ *   xcdn_walk_end(&w);
+ *
+ * Annotation arguments are values, not nodes, and are not visited.
+ * The tree must not be modified during a walk.
+ *
+ * MIT License
+ */
+
+#ifndef XCDN_WALK_H
+#define XCDN_WALK_H
+
+#include "ast.h"
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef enum {
+    XCDN_WALK_ENTER,   /* before the node's children */
+    XCDN_WALK_LEAVE,   /* after the node's children */
+} xcdn_walk_kind_t;
+
+typedef struct {
+    xcdn_walk_kind_t    kind;
+    const xcdn_node_t  *node;
+    const xcdn_value_t *value;     /* node->value */
+    const char         *key;       /* key in the parent object, or NULL */
+    size_t              key_len;
+    size_t              index;     /* position in the parent (or the document) */
+    size_t              depth;     /* 0 for top-level nodes */
+} xcdn_walk_event_t;
+
+/* One entered node and the position of its next child. */
+typedef struct {
+    const xcdn_node_t  *node;      /* NULL for the bottom (document) frame */
+    const xcdn_value_t *value;
+    xcdn_node_t *const *items;     /* children of arrays and the bottom frame */
+    size_t              len;
+    size_t              next;
+    const char         *key;
+    size_t              key_len;
+    size_t              index;
+} xcdn_walk_frame_t;
+
+typedef struct {
+    xcdn_walk_frame_t *frames;
+    size_t             len;
+    size_t             cap;
+    xcdn_node_t       *root;       /* single-node walks */
+    bool               failed;     /* allocation failure ended the walk */
+} xcdn_walk_t;
+
+/* Start walking the top-level nodes of a document (NULL walks nothing). */
+void xcdn_walk_begin(xcdn_walk_t *w, const xcdn_document_t *doc);
+
+/* Start walking one node and its subtree, reported at depth 0. */
+void xcdn_walk_begin_node(xcdn_walk_t *w, const xcdn_node_t *node);
+
+/*
+ * Produce the next event. Returns false once the walk is over (or if the
+ * stack could not grow, in which case w->failed is set).
+ */
+bool xcdn_walk_next(xcdn_walk_t *w, xcdn_walk_event_t *ev);
+
+/*
+ * After an ENTER event, skip the node's children: the next event is the
+ * node's LEAVE.
+ */
+void xcdn_walk_skip(xcdn_walk_t *w);
+
+/* Release the walker's stack. */
+void xcdn_walk_end(xcdn_walk_t *w);
+
+#endif /* XCDN_WALK_H */
@@ -12,6 +12,9 @@
  * - ser:    pretty/compact serialization with strong typing (Decimal, UUID,
  *           DateTime, Duration, Bytes).
  *
+ * Frozen documents can be shared between threads through a lock-free
+ * snapshot holder (snapshot.h).
+ *
  * Quick Start:
  *
  *   #include "xcdn.h"
@@ -51,6 +54,16 @@
 #include "lexer.h"
 #include "parser.h"
 #include "ser.h"
+#include "snapshot.h"
+#include "spans.h"
+#include "utf8.h"
+#include "base64.h"
+#include "strpool.h"
+#include "shape.h"
+#include "tape.h"
+#include "walk.h"
+#include "frame.h"
+#include "log.h"
 
 #define XCDN_VERSION "0.1.0"
 
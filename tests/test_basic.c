@@ -180,6 +180,63 @@ static void test_programmatic_construction(void) {
     xcdn_document_free(doc2);
 }
 
+/* ── Test: inline short strings ───────────────────────────────────────── */
+
+static void test_short_strings_inline(void) {
+    printf("  test_short_strings_inline\n");
+    const char *long_text = "a string well past the inline capacity";
+
+    xcdn_value_t *obj = xcdn_value_object();
+    xcdn_object_set(obj, "host", xcdn_node_new(xcdn_value_string("localhost")));
+    xcdn_object_set(obj, "fifteen_chars_k",
+                    xcdn_node_new(xcdn_value_string("exactly15chars!")));
+    xcdn_object_set(obj, "sixteen_chars_ke",
+                    xcdn_node_new(xcdn_value_string(long_text)));
+    for (int i = 0; i < 20; i++) {
+        char key[32];
+        if (i % 2) snprintf(key, sizeof(key), "k%d", i);
+        else snprintf(key, sizeof(key), "a_rather_long_key_%d", i);
+        xcdn_object_set(obj, key, xcdn_node_new(xcdn_value_int(i)));
+    }
+
+    const xcdn_value_t *host = xcdn_object_get(obj, "host")->value;
+    ASSERT(host->data.string == host->data.string_sso, "short value inline");
+    ASSERT_EQ_STR(xcdn_value_as_string(host), "localhost", "short value");
+    const xcdn_value_t *v15 = xcdn_object_get(obj, "fifteen_chars_k")->value;
+    ASSERT(v15->data.string == v15->data.string_sso, "15 bytes fit inline");
+    const xcdn_value_t *big = xcdn_object_get(obj, "sixteen_chars_ke")->value;
+    ASSERT(big->data.string != big->data.string_sso, "long value on the heap");
+    ASSERT_EQ_STR(xcdn_value_as_string(big), long_text, "long value");
+
+    /* Keys survive the entry array growing */
+    ASSERT_EQ_INT((int)xcdn_object_len(obj), 23, "23 entries");
+    ASSERT_EQ_STR(xcdn_object_key_at(obj, 0), "host", "short key");
+    ASSERT_EQ_STR(xcdn_object_key_at(obj, 2), "sixteen_chars_ke", "long key");
+    ASSERT_EQ_STR(xcdn_object_key_at(obj, 22), "k19", "last key");
+    ASSERT_EQ_INT((int)xcdn_value_as_int(
+                      xcdn_object_get(obj, "a_rather_long_key_18")->value),
+                  18, "lookup by long key");
+
+    xcdn_object_set(obj, "host", xcdn_node_new(xcdn_value_string(long_text)));
+    ASSERT_EQ_INT((int)xcdn_object_len(obj), 23, "update keeps length");
+    ASSERT_EQ_STR(xcdn_value_as_string(xcdn_object_get(obj, "host")->value),
+                  long_text, "updated value");
+
+#ifdef XCDN_HEAP_KEYS
+    /* Heap keys keep the `key` field and stable key pointers */
+    const char *first = xcdn_object_key_at(obj, 0);
+    ASSERT(first == obj->data.object.entries[0].key, "entry.key is the key");
+    for (int i = 0; i < 100; i++) {
+        char key[32];
+        snprintf(key, sizeof(key), "more%d", i);
+        xcdn_object_set(obj, key, xcdn_node_new(xcdn_value_int(i)));
+    }
+    ASSERT(xcdn_object_key_at(obj, 0) == first, "key pointer survives growth");
+#endif
+
+    xcdn_value_free(obj);
+}
+
 /* ── Test: document path access ───────────────────────────────────────── */
 
 static void test_path_access(void) {
@@ -255,6 +312,218 @@ static void test_object_iteration(void) {
     xcdn_document_free(doc);
 }
 
+/* ── Test: depth-first walker ─────────────────────────────────────────── */
+
+static void test_walk(void) {
+    printf("  test_walk\n");
+    const char *src = "{ a: [1, #skip { x: 2 }], b: { c: true } }\n\"second\"";
+
+    xcdn_error_t err;
+    xcdn_document_t *doc = xcdn_parse(src, &err);
+    ASSERT(doc != NULL, "parse succeeded");
+
+    /* Event trace: E/L, depth, key or index */
+    char trace[256] = "";
+    xcdn_walk_t w;
+    xcdn_walk_event_t ev;
+    xcdn_walk_begin(&w, doc);
+    while (xcdn_walk_next(&w, &ev)) {
+        char item[32];
+        if (ev.key)
+            snprintf(item, sizeof(item), "%c%zu%s ", ev.kind == XCDN_WALK_ENTER ? 'E' : 'L',
+                     ev.depth, ev.key);
+        else
+            snprintf(item, sizeof(item), "%c%zu#%zu ", ev.kind == XCDN_WALK_ENTER ? 'E' : 'L',
+                     ev.depth, ev.index);
+        strcat(trace, item);
+    }
+    ASSERT(!w.failed, "no allocation failure");
+    xcdn_walk_end(&w);
+    ASSERT_EQ_STR(trace,
+                  "E0#0 E1a E2#0 L2#0 E2#1 E3x L3x L2#1 L1a E1b E2c L2c L1b L0#0 "
+                  "E0#1 L0#1 ", "enter/leave order");
+
+    /* Skipping a subtree, walking a single node */
+    int entered = 0;
+    xcdn_walk_begin_node(&w, doc->values[0]);
+    while (xcdn_walk_next(&w, &ev)) {
+        if (ev.kind != XCDN_WALK_ENTER) continue;
+        entered++;
+        if (xcdn_node_has_tag(ev.node, "skip")) xcdn_walk_skip(&w);
+    }
+    xcdn_walk_end(&w);
+    ASSERT_EQ_INT(entered, 6, "skipped node's children not entered");
+
+    /* Deep nesting needs no recursion */
+    size_t depth = 20000, max_depth = 0;
+    xcdn_node_t *root = xcdn_node_new(xcdn_value_array());
+    xcdn_node_t *at = root;
+    for (size_t i = 1; i < depth; i++) {
+        xcdn_node_t *child = xcdn_node_new(xcdn_value_array());
+        xcdn_array_push(at->value, child);
+        at = child;
+    }
+    xcdn_walk_begin_node(&w, root);
+    while (xcdn_walk_next(&w, &ev)) {
+        if (ev.depth > max_depth) max_depth = ev.depth;
+    }
+    xcdn_walk_end(&w);
+    ASSERT_EQ_INT((int)max_depth, (int)depth - 1, "deepest level reached");
+
+    /* Free the chain iteratively */
+    while (root) {
+        xcdn_node_t *next = xcdn_array_get(root->value, 0);
+        root->value->data.array.len = 0;
+        xcdn_node_free(root);
+        root = next;
+    }
+    xcdn_document_free(doc);
+}
+
+/* ── Test: removing keys and splicing arrays ──────────────────────────── */
+
+static void test_remove_and_splice(void) {
+    printf("  test_remove_and_splice\n");
+    xcdn_parse_options_t opts = xcdn_parse_options_default();
+    opts.shape_objects = true;
+    const char *src = "[{ user: \"a\", password: \"x\", a_rather_long_key_name: 1 },"
+                      " { user: \"b\", password: \"y\", a_rather_long_key_name: 2 }]";
+    xcdn_error_t err;
+    xcdn_document_t *doc = xcdn_parse_str_with_options(src, strlen(src), opts, &err);
+    ASSERT(doc != NULL, "parse succeeded");
+    xcdn_value_t *rows = doc->values[0]->value;
+    xcdn_value_t *first = xcdn_array_get(rows, 0)->value;
+    ASSERT(first->data.object.shape != NULL, "shaped object");
+    ASSERT(xcdn_object_remove(first, "password"), "removed");
+    ASSERT(!xcdn_object_remove(first, "password"), "already gone");
+    ASSERT(first->data.object.shape == NULL, "removal unshapes");
+    ASSERT_EQ_INT((int)xcdn_object_len(first), 2, "two keys left");
+    ASSERT_EQ_STR(xcdn_object_key_at(first, 1), "a_rather_long_key_name", "order kept");
+    ASSERT(xcdn_object_get(xcdn_array_get(rows, 1)->value, "password") != NULL,
+           "sibling with the same shape untouched");
+    ASSERT(xcdn_object_remove(first, "user"), "removed first key");
+    ASSERT_EQ_INT((int)xcdn_value_as_int(
+        xcdn_object_get(first, "a_rather_long_key_name")->value), 1, "lookup after removal");
+
+    xcdn_value_t *arr = xcdn_value_array();
+    for (int i = 0; i < 5; i++) xcdn_array_push(arr, xcdn_node_new(xcdn_value_int(i)));
+    ASSERT(xcdn_array_insert(arr, 0, xcdn_node_new(xcdn_value_int(-1))), "insert at front");
+    ASSERT(xcdn_array_insert(arr, 6, xcdn_node_new(xcdn_value_int(9))), "insert at end");
+    ASSERT(xcdn_array_remove(arr, 3), "remove middle");
+    xcdn_node_t *repl[3] = { xcdn_node_new(xcdn_value_int(7)),
+                             xcdn_node_new(xcdn_value_int(7)),
+                             xcdn_node_new(xcdn_value_int(7)) };
+    ASSERT(xcdn_array_splice(arr, 1, 2, repl, 3), "splice grows");
+    ASSERT(!xcdn_array_splice(arr, 3, 9, NULL, 0), "range out of bounds");
+    xcdn_node_t *stray = xcdn_node_new(xcdn_value_null());
+    ASSERT(!xcdn_array_insert(arr, 99, stray), "index out of bounds");
+    xcdn_node_free(stray);
+
+    char buf[64] = "";
+    for (size_t i = 0; i < xcdn_array_len(arr); i++) {
+        char num[8];
+        snprintf(num, sizeof(num), "%d,", (int)xcdn_value_as_int(xcdn_array_get(arr, i)->value));
+        strcat(buf, num);
+    }
+    ASSERT_EQ_STR(buf, "-1,7,7,7,3,4,9,", "splice result");
+    ASSERT(xcdn_array_splice(arr, 0, xcdn_array_len(arr), NULL, 0), "clear");
+    ASSERT_EQ_INT((int)xcdn_array_len(arr), 0, "empty");
+    xcdn_value_free(arr);
+
+    xcdn_document_freeze(doc);
+    ASSERT(!xcdn_object_remove(xcdn_array_get(rows, 1)->value, "user"), "frozen object");
+    ASSERT(!xcdn_array_remove(rows, 0), "frozen array");
+    xcdn_document_free(doc);
+}
+
+/* ── Test: bulk building ──────────────────────────────────────────────── */
+
+/* Heap copy of a string (strdup is not ISO C). */
+static char *heap_copy(const char *s) {
+    size_t n = strlen(s) + 1;
+    char *out = (char *)malloc(n);
+    if (out) memcpy(out, s, n);
+    return out;
+}
+
+static void test_bulk_build(void) {
+    printf("  test_bulk_build\n");
+    xcdn_value_t *rows = xcdn_value_array();
+    ASSERT(xcdn_array_reserve(rows, 100), "reserved");
+    ASSERT(rows->data.array.cap >= 100, "capacity");
+    xcdn_node_t **before = rows->data.array.items;
+
+    xcdn_node_t *batch[100];
+    for (int i = 0; i < 100; i++) {
+        xcdn_value_t *row = xcdn_value_object();
+        ASSERT(xcdn_object_reserve(row, 2), "object reserved");
+        xcdn_object_append(row, "id", 2, 0, xcdn_node_new(xcdn_value_int(i)));
+        char *key = heap_copy("a_key_that_does_not_fit_inline");
+        ASSERT(key != NULL, "key copied");
+        ASSERT(xcdn_object_append_owned(row, key, strlen(key), xcdn_string_flags(key, strlen(key)),
+                                        xcdn_node_new(xcdn_value_string_owned(heap_copy("v")))),
+               "owned key appended");
+        ASSERT(xcdn_object_key_at(row, 1) == key, "key adopted, not copied");
+        batch[i] = xcdn_node_new(row);
+    }
+    ASSERT(xcdn_array_append(rows, batch, 100), "appended");
+    ASSERT(rows->data.array.items == before, "no reallocation");
+    ASSERT_EQ_INT((int)xcdn_array_len(rows), 100, "length");
+    ASSERT_EQ_INT((int)xcdn_value_as_int(
+        xcdn_object_get(xcdn_array_get(rows, 42)->value, "id")->value), 42, "lookup");
+
+    xcdn_document_t *doc = xcdn_document_new();
+    xcdn_document_push_value(doc, xcdn_node_new(rows));
+    char *out = xcdn_to_string_compact(doc);
+    ASSERT(out && strncmp(out, "[{id: 0,a_key_that_does_not_fit_inline: \"v\"},{id: 1", 51) == 0,
+           "serializes");
+    free(out);
+
+    xcdn_document_freeze(doc);
+    xcdn_node_t *extra = xcdn_node_new(xcdn_value_null());
+    ASSERT(!xcdn_array_append(rows, &extra, 1), "frozen array");
+    ASSERT(!xcdn_object_append(xcdn_array_get(rows, 0)->value, "x", 1, 0, extra),
+           "frozen object");
+    xcdn_node_free(extra);
+    xcdn_document_free(doc);
+}
+
+/* ── Test: memory usage ───────────────────────────────────────────────── */
+
+static void test_memory_usage(void) {
+    printf("  test_memory_usage\n");
+    const char *src =
+        "$version: 1,\n"
+        "{ a: [1, 2, 3, 4, 5], s: \"a string longer than sixteen\",\n"
+        "  k: #t @n(\"x\") true, b: b\"aGk=\" }";
+    xcdn_error_t err;
+    xcdn_document_t *doc = xcdn_parse(src, &err);
+    ASSERT(doc != NULL, "parse succeeded");
+
+    xcdn_memory_stats_t st;
+    ASSERT(xcdn_document_memory_usage(doc, &st), "measured");
+    ASSERT_EQ_INT((int)st.nodes.used, (int)(10 * sizeof(xcdn_node_t)), "ten nodes");
+    ASSERT_EQ_INT((int)st.values.used, (int)(12 * sizeof(xcdn_value_t)),
+                  "prolog and argument values included");
+    ASSERT_EQ_INT((int)st.counts[XCDN_VAL_INT], 6, "ints");
+    ASSERT_EQ_INT((int)st.counts[XCDN_VAL_STRING], 2, "strings");
+    ASSERT_EQ_INT((int)st.counts[XCDN_VAL_BYTES], 1, "bytes");
+    ASSERT_EQ_INT((int)st.strings.used, 29, "long string stored out of line");
+    ASSERT_EQ_INT((int)st.bytes.used, 2, "decoded payload");
+    ASSERT(st.containers.reserved > st.containers.used, "array has spare capacity");
+    ASSERT(st.slack == st.total.reserved - st.total.used && st.slack > 0, "slack");
+
+    ASSERT(xcdn_document_compact(doc), "compacted");
+    xcdn_memory_stats_t cst;
+    ASSERT(xcdn_document_memory_usage(doc, &cst), "measured compacted");
+    ASSERT(memcmp(st.counts, cst.counts, sizeof(st.counts)) == 0, "same counts");
+    ASSERT_EQ_INT((int)cst.nodes.used, (int)st.nodes.used, "same nodes");
+    ASSERT(cst.containers.reserved == cst.containers.used, "no spare capacity");
+    ASSERT_EQ_INT((int)cst.total.used, (int)st.total.used, "same data");
+    ASSERT(cst.slack == cst.total.reserved - cst.total.used, "block padding is slack");
+    xcdn_document_free(doc);
+}
+
 /* ── Main ─────────────────────────────────────────────────────────────── */
 
 int main(void) {
@@ -262,8 +531,13 @@ int main(void) {
 
     test_full_roundtrip();
     test_programmatic_construction();
+    test_short_strings_inline();
     test_path_access();
     test_object_iteration();
+    test_walk();
+    test_remove_and_splice();
+    test_bulk_build();
+    test_memory_usage();
 
     printf("\n%d/%d tests passed\n", tests_passed, tests_run);
     return tests_passed == tests_run ? 0 : 1;
@@ -0,0 +1,296 @@
+/*
+ * Message framing tests for xCDN-C.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "xcdn.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define HAVE_SOCKETPAIR 1
+#include <pthread.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+static int tests_run = 0;
+static int tests_passed = 0;
+
+#define ASSERT(cond, msg) do { \
+    tests_run++; \
+    if (!(cond)) { \
+        fprintf(stderr, "  FAIL [%s:%d]: %s\n", __FILE__, __LINE__, msg); \
+        return; \
+    } \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_EQ_INT(a, b, msg) ASSERT((a) == (b), msg)
+#define ASSERT_EQ_STR(a, b, msg) ASSERT(strcmp((a), (b)) == 0, msg)
+
+/* ── Memory transport ─────────────────────────────────────────────────── */
+
+typedef struct {
+    char  *buf;
+    size_t len;
+    size_t pos;
+    size_t chunk;   /* bytes handed out per read */
+    int    calls;
+} mem_stream_t;
+
+static int mem_sink(void *ctx, const char *data, size_t len) {
+    mem_stream_t *m = (mem_stream_t *)ctx;
+    char *grown = (char *)realloc(m->buf, m->len + len);
+    if (!grown) return -1;
+    m->buf = grown;
+    memcpy(m->buf + m->len, data, len);
+    m->len += len;
+    m->calls++;
+    return 0;
+}
+
+static ptrdiff_t mem_source(void *ctx, char *buf, size_t cap) {
+    mem_stream_t *m = (mem_stream_t *)ctx;
+    size_t n = m->len - m->pos;
+    if (n > cap) n = cap;
+    if (m->chunk && n > m->chunk) n = m->chunk;
+    memcpy(buf, m->buf + m->pos, n);
+    m->pos += n;
+    return (ptrdiff_t)n;
+}
+
+/* ── Test: checksum and prefix ────────────────────────────────────────── */
+
+static void test_frame_prefix(void) {
+    printf("  test_frame_prefix\n");
+    ASSERT_EQ_INT(xcdn_crc32c(0, "123456789", 9), 0xE3069283u, "CRC-32C check value");
+    uint32_t part = xcdn_crc32c(0, "1234", 4);
+    ASSERT_EQ_INT(xcdn_crc32c(part, "56789", 5), 0xE3069283u, "incremental CRC");
+
+    uint8_t p[XCDN_FRAME_MAX_PREFIX];
+    ASSERT_EQ_INT(xcdn_frame_prefix(p, 0, false), 1, "empty frame");
+    ASSERT_EQ_INT(p[0], 0, "empty frame prefix");
+    ASSERT_EQ_INT(xcdn_frame_prefix(p, 63, true), 1, "one-byte prefix");
+    ASSERT_EQ_INT(p[0], 127, "length and flag");
+    ASSERT_EQ_INT(xcdn_frame_prefix(p, 64, false), 2, "two-byte prefix");
+    ASSERT_EQ_INT(p[0], 0x80, "low bits with continuation");
+    ASSERT_EQ_INT(p[1], 1, "high bits");
+}
+
+/* ── Test: round trip through a memory stream ─────────────────────────── */
+
+static void test_frame_roundtrip(void) {
+    printf("  test_frame_roundtrip\n");
+    size_t sizes[] = {0, 1, 63, 64, 8191, 8192, 300000, 5};
+    size_t count = sizeof(sizes) / sizeof(sizes[0]);
+    char *big = (char *)malloc(300000);
+    ASSERT(big != NULL, "payload allocated");
+    for (size_t i = 0; i < 300000; i++) big[i] = (char)(i * 7);
+
+    for (int checked = 0; checked < 2; checked++) {
+        mem_stream_t m = {NULL, 0, 0, 0, 0};
+        xcdn_frame_writer_t *w = xcdn_frame_writer_new(mem_sink, &m, 4096, checked);
+        ASSERT(w != NULL, "writer created");
+        for (size_t i = 0; i < count; i++)
+            ASSERT_EQ_INT(xcdn_frame_write(w, big, sizes[i]), 0, "frame queued");
+        ASSERT_EQ_INT(xcdn_frame_writer_finish(w), 0, "writer finished");
+        ASSERT(m.calls < 20, "frames batched");
+
+        /* Small reads split prefixes, payloads and checksums */
+        size_t chunks[] = {0, 3, 1000};
+        for (int c = 0; c < 3; c++) {
+            m.pos = 0;
+            m.chunk = chunks[c];
+            xcdn_frame_reader_options_t opts = xcdn_frame_reader_options_default();
+            opts.window = 1024;
+            xcdn_frame_reader_t *r = xcdn_frame_reader_new(mem_source, &m, opts);
+            ASSERT(r != NULL, "reader created");
+            for (size_t i = 0; i < count; i++) {
+                const char *payload = NULL;
+                size_t len = 0;
+                ASSERT_EQ_INT(xcdn_frame_next(r, &payload, &len), XCDN_FRAME_OK,
+                              "frame read");
+                ASSERT_EQ_INT(len, sizes[i], "frame length");
+                ASSERT(len == 0 || memcmp(payload, big, len) == 0, "frame payload");
+            }
+            const char *payload;
+            size_t len;
+            ASSERT_EQ_INT(xcdn_frame_next(r, &payload, &len), XCDN_FRAME_EOF,
+                          "clean end");
+            ASSERT_EQ_INT(xcdn_frame_next(r, &payload, &len), XCDN_FRAME_EOF,
+                          "end is sticky");
+            xcdn_frame_reader_free(r);
+        }
+        free(m.buf);
+    }
+    free(big);
+}
+
+/* ── Test: stream errors ──────────────────────────────────────────────── */
+
+static xcdn_frame_status_t read_all(mem_stream_t *m,
+                                    xcdn_frame_reader_options_t opts) {
+    m->pos = 0;
+    xcdn_frame_reader_t *r = xcdn_frame_reader_new(mem_source, m, opts);
+    const char *payload;
+    size_t len;
+    xcdn_frame_status_t st;
+    while ((st = xcdn_frame_next(r, &payload, &len)) == XCDN_FRAME_OK) {}
+    xcdn_frame_reader_free(r);
+    return st;
+}
+
+static void test_frame_errors(void) {
+    printf("  test_frame_errors\n");
+    xcdn_frame_reader_options_t opts = xcdn_frame_reader_options_default();
+    mem_stream_t m = {NULL, 0, 0, 0, 0};
+    xcdn_frame_writer_t *w = xcdn_frame_writer_new(mem_sink, &m, 0, true);
+    xcdn_frame_write(w, "{a: 1}", 6);
+    xcdn_frame_write(w, "{a: 2}", 6);
+    xcdn_frame_writer_finish(w);
+    ASSERT_EQ_INT(m.len, 22, "two checked frames");
+    ASSERT_EQ_INT(read_all(&m, opts), XCDN_FRAME_EOF, "intact stream");
+
+    m.buf[13] ^= 0x20;
+    ASSERT_EQ_INT(read_all(&m, opts), XCDN_FRAME_ERR_CHECKSUM, "corrupted payload");
+    m.buf[13] ^= 0x20;
+
+    m.len = 20;
+    ASSERT_EQ_INT(read_all(&m, opts), XCDN_FRAME_ERR_TRUNCATED, "cut checksum");
+    m.len = 22;
+
+    opts.max_frame = 5;
+    ASSERT_EQ_INT(read_all(&m, opts), XCDN_FRAME_ERR_TOO_LARGE, "frame above limit");
+    opts.max_frame = xcdn_frame_reader_options_default().max_frame;
+
+    memset(m.buf, 0xFF, 11);
+    ASSERT_EQ_INT(read_all(&m, opts), XCDN_FRAME_ERR_PREFIX, "overlong prefix");
+    free(m.buf);
+
+    /* Unchecked frames, and a payload that does not parse */
+    mem_stream_t u = {NULL, 0, 0, 0, 0};
+    w = xcdn_frame_writer_new(mem_sink, &u, 0, false);
+    xcdn_frame_write(w, "{a: ", 4);
+    xcdn_frame_write(w, "[1, 2]", 6);
+    xcdn_frame_writer_finish(w);
+    opts.require_checksum = true;
+    ASSERT_EQ_INT(read_all(&u, opts), XCDN_FRAME_ERR_CHECKSUM, "checksum required");
+
+    opts.require_checksum = false;
+    u.pos = 0;
+    xcdn_frame_reader_t *r = xcdn_frame_reader_new(mem_source, &u, opts);
+    xcdn_document_t *doc = NULL;
+    xcdn_error_t err;
+    ASSERT_EQ_INT(xcdn_frame_read(r, &doc, &err), XCDN_FRAME_ERR_PARSE, "bad payload");
+    ASSERT(doc == NULL && err.kind != XCDN_ERR_NONE, "parser error reported");
+    ASSERT_EQ_INT(xcdn_frame_read(r, &doc, &err), XCDN_FRAME_OK, "next frame still read");
+    char *text = xcdn_to_string_compact(doc);
+    ASSERT_EQ_STR(text, "[1,2]", "document parsed from the window");
+    free(text);
+    xcdn_document_free(doc);
+    xcdn_frame_reader_free(r);
+    free(u.buf);
+}
+
+/* ── Test: documents over a socket pair ───────────────────────────────── */
+
+#ifdef HAVE_SOCKETPAIR
+
+#define SOCKET_MESSAGES 2000
+
+static int fd_sink(void *ctx, const char *data, size_t len) {
+    int fd = *(int *)ctx;
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) return -1;
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static ptrdiff_t fd_source(void *ctx, char *buf, size_t cap) {
+    return (ptrdiff_t)read(*(int *)ctx, buf, cap);
+}
+
+static xcdn_document_t *message(int i) {
+    xcdn_document_t *doc = xcdn_document_new();
+    xcdn_value_t *obj = xcdn_value_object();
+    xcdn_object_set(obj, "seq", xcdn_node_new(xcdn_value_int(i)));
+    char *blob = i % 500 == 7 ? (char *)malloc(200001) : NULL;
+    if (blob) {
+        /* An occasional payload larger than the batch and the window */
+        memset(blob, 'x', 200000);
+        blob[200000] = '\0';
+        xcdn_object_set(obj, "blob", xcdn_node_new(xcdn_value_string(blob)));
+        free(blob);
+    }
+    xcdn_document_push_value(doc, xcdn_node_new(obj));
+    return doc;
+}
+
+static void *sender(void *arg) {
+    int fd = *(int *)arg;
+    xcdn_frame_writer_t *w = xcdn_frame_writer_new(fd_sink, &fd, 0, true);
+    for (int i = 0; i < SOCKET_MESSAGES; i++) {
+        xcdn_document_t *doc = message(i);
+        xcdn_frame_write_document(w, doc, xcdn_format_compact());
+        xcdn_document_free(doc);
+    }
+    xcdn_frame_writer_finish(w);
+    close(fd);
+    return NULL;
+}
+
+static void test_frame_socketpair(void) {
+    printf("  test_frame_socketpair\n");
+    int fds[2];
+    ASSERT_EQ_INT(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0, "socketpair");
+    pthread_t th;
+    ASSERT_EQ_INT(pthread_create(&th, NULL, sender, &fds[1]), 0, "sender started");
+
+    xcdn_frame_reader_t *r = xcdn_frame_reader_new(
+        fd_source, &fds[0], xcdn_frame_reader_options_default());
+    int received = 0, matched = 0;
+    xcdn_document_t *doc;
+    xcdn_error_t err;
+    while (xcdn_frame_read(r, &doc, &err) == XCDN_FRAME_OK) {
+        xcdn_document_t *want = message(received);
+        matched += doc->values_len == 1 &&
+                   xcdn_node_equal(doc->values[0], want->values[0]);
+        xcdn_document_free(want);
+        xcdn_document_free(doc);
+        received++;
+    }
+    const char *payload;
+    size_t len;
+    xcdn_frame_status_t end = xcdn_frame_next(r, &payload, &len);
+    xcdn_frame_reader_free(r);
+    pthread_join(th, NULL);
+    close(fds[0]);
+
+    ASSERT_EQ_INT(end, XCDN_FRAME_EOF, "stream ended cleanly");
+    ASSERT_EQ_INT(received, SOCKET_MESSAGES, "every message received");
+    ASSERT_EQ_INT(matched, SOCKET_MESSAGES, "every message intact");
+}
+
+#endif
+
+/* ── Main ─────────────────────────────────────────────────────────────── */
+
+int main(void) {
+    printf("=== Framing Tests ===\n");
+
+    test_frame_prefix();
+    test_frame_roundtrip();
+    test_frame_errors();
+#ifdef HAVE_SOCKETPAIR
+    test_frame_socketpair();
+#endif
+
+    printf("\n%d/%d tests passed\n", tests_passed, tests_run);
+    return tests_passed == tests_run ? 0 : 1;
+}
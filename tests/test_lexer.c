@@ -280,6 +280,128 @@ static void test_lex_unicode_escape(void) {
     xcdn_token_free(&t);
 }
 
+/* ── Test: compact error state ────────────────────────────────────────── */
+
+static void test_lex_error_state(void) {
+    printf("  test_lex_error_state\n");
+    const char *src = "{ a: 12345678901234567890123 }";
+    xcdn_lexer_t lex;
+    xcdn_error_state_t err = xcdn_error_state_none();
+    xcdn_lexer_init(&lex, src, strlen(src));
+
+    xcdn_token_t t;
+    do {
+        t = xcdn_lexer_scan(&lex, &err);
+        xcdn_token_free(&t);
+    } while (t.type != XCDN_TOK_EOF);
+    ASSERT_EQ_INT(err.kind, XCDN_ERR_INVALID_NUMBER, "integer overflow");
+    ASSERT_EQ_INT((int)err.span.offset, 28, "span after the literal");
+
+    char buf[64];
+    int n = xcdn_error_format(&err, buf, sizeof(buf));
+    ASSERT_EQ_STR(buf, "invalid integer: 12345678901234567890123", "message text");
+    ASSERT_EQ_INT(n, (int)strlen(buf), "full length");
+
+    char small[8];
+    ASSERT_EQ_INT(xcdn_error_format(&err, small, sizeof(small)), n,
+                  "length reported when truncated");
+    ASSERT_EQ_STR(small, "invalid", "truncated text");
+
+    xcdn_error_t full;
+    xcdn_error_state_export(&err, &full);
+    ASSERT_EQ_STR(full.message, buf, "exported message");
+    ASSERT_EQ_INT(err.kind, XCDN_ERR_NONE, "state cleared");
+}
+
+/* ── Test: long comments and triple-quoted strings ───────────────────── */
+
+static void test_lex_long_runs(void) {
+    printf("  test_lex_long_runs\n");
+    const char *src =
+        "/* license\n"
+        " * line two */ // trailing\n"
+        "\"\"\"first\n"
+        "  second \" \"\" quotes\n"
+        "\"\"\"  x";
+    xcdn_lexer_t lex;
+    xcdn_error_t err;
+    xcdn_lexer_init(&lex, src, strlen(src));
+
+    xcdn_token_t t = xcdn_lexer_next(&lex, &err);
+    ASSERT_EQ_INT(t.type, XCDN_TOK_TRIPLE_STRING, "triple string");
+    ASSERT_EQ_INT((int)t.span.line, 3, "starts on line 3");
+    ASSERT_EQ_INT((int)t.span.column, 1, "at column 1");
+    ASSERT_EQ_STR(t.data.string_val.str, "first\n  second \" \"\" quotes\n",
+                  "content copied verbatim");
+    xcdn_token_free(&t);
+
+    t = xcdn_lexer_next(&lex, &err);
+    ASSERT_EQ_INT(t.type, XCDN_TOK_IDENT, "ident after string");
+    ASSERT_EQ_INT((int)t.span.line, 5, "line after string");
+    ASSERT_EQ_INT((int)t.span.column, 6, "column after string");
+    xcdn_token_free(&t);
+
+    const char *open = "\"\"\"never\nclosed";
+    xcdn_lexer_init(&lex, open, strlen(open));
+    t = xcdn_lexer_next(&lex, &err);
+    ASSERT_EQ_INT(err.kind, XCDN_ERR_EOF, "unterminated triple string");
+    xcdn_token_free(&t);
+
+    const char *empty = "\"\"\"\"\"\"";
+    xcdn_lexer_init(&lex, empty, strlen(empty));
+    t = xcdn_lexer_next(&lex, &err);
+    ASSERT_EQ_INT(t.type, XCDN_TOK_TRIPLE_STRING, "empty triple string");
+    ASSERT_EQ_INT((int)t.data.string_val.len, 0, "no content");
+    xcdn_token_free(&t);
+}
+
+/* ── Test: UTF-8 validation ───────────────────────────────────────────── */
+
+static void test_lex_utf8(void) {
+    printf("  test_lex_utf8\n");
+    size_t bad = 0;
+    ASSERT_EQ_INT(xcdn_utf8_validate("plain ascii text", 16, &bad),
+                  XCDN_UTF8_ASCII, "ascii");
+    ASSERT_EQ_INT(xcdn_utf8_validate("caf\xc3\xa9 \xf0\x9f\x99\x82", 10, &bad),
+                  XCDN_UTF8_VALID, "two- and four-byte sequences");
+    ASSERT_EQ_INT(xcdn_utf8_validate("ab\xc0\xaf" "cd", 6, &bad),
+                  XCDN_UTF8_INVALID, "overlong rejected");
+    ASSERT_EQ_INT((int)bad, 2, "offset of overlong");
+    ASSERT_EQ_INT(xcdn_utf8_validate("\xed\xa0\x80", 3, &bad),
+                  XCDN_UTF8_INVALID, "surrogate rejected");
+    ASSERT_EQ_INT(xcdn_utf8_validate("0123456789\xe2\x82", 12, &bad),
+                  XCDN_UTF8_INVALID, "truncated sequence rejected");
+    ASSERT_EQ_INT((int)bad, 10, "offset of truncated sequence");
+
+    /* Lexer: ASCII flag always, exact error span in strict mode */
+    const char *src = "\"id\" \"caf\xc3\xa9\" \"\"\"line\nok \xff\"\"\"";
+    xcdn_lexer_t lex;
+    xcdn_error_t err;
+    xcdn_lexer_init(&lex, src, strlen(src));
+    xcdn_token_t t = xcdn_lexer_next(&lex, &err);
+    ASSERT(t.flags & XCDN_TOKF_ASCII, "ascii string flagged");
+    xcdn_token_free(&t);
+    t = xcdn_lexer_next(&lex, &err);
+    ASSERT(!(t.flags & XCDN_TOKF_ASCII), "non-ascii string not flagged");
+    xcdn_token_free(&t);
+    t = xcdn_lexer_next(&lex, &err);
+    ASSERT(!xcdn_error_is_set(&err), "lenient by default");
+    xcdn_token_free(&t);
+
+    xcdn_lexer_init(&lex, src, strlen(src));
+    lex.strict_utf8 = 1;
+    for (int i = 0; i < 3; i++) {
+        t = xcdn_lexer_next(&lex, &err);
+        xcdn_token_free(&t);
+    }
+    ASSERT_EQ_INT(err.kind, XCDN_ERR_INVALID_UTF8, "strict mode rejects");
+    ASSERT_EQ_INT((int)err.span.offset, 24, "offset of the bad byte");
+    ASSERT_EQ_INT((int)err.span.line, 2, "line of the bad byte");
+    ASSERT_EQ_INT((int)err.span.column, 4, "column of the bad byte");
+    ASSERT_EQ_STR(err.message, "invalid UTF-8 sequence starting with byte 0xff",
+                  "message");
+}
+
 /* ── Main ─────────────────────────────────────────────────────────────── */
 
 int main(void) {
@@ -295,6 +417,9 @@ int main(void) {
     test_lex_position_tracking();
     test_lex_string_escapes();
     test_lex_unicode_escape();
+    test_lex_error_state();
+    test_lex_long_runs();
+    test_lex_utf8();
 
     printf("\n%d/%d tests passed\n", tests_passed, tests_run);
     return tests_passed == tests_run ? 0 : 1;
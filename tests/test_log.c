@@ -0,0 +1,278 @@
+/*
+ * Append-only log tests for xCDN-C.
+ */
+
+#include "xcdn.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int tests_run = 0;
+static int tests_passed = 0;
+
+#define ASSERT(cond, msg) do { \
+    tests_run++; \
+    if (!(cond)) { \
+        fprintf(stderr, "  FAIL [%s:%d]: %s\n", __FILE__, __LINE__, msg); \
+        return; \
+    } \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_EQ_INT(a, b, msg) ASSERT((a) == (b), msg)
+#define ASSERT_EQ_STR(a, b, msg) ASSERT(strcmp((a), (b)) == 0, msg)
+
+#define LOG_PATH "test_log.tmp.xcdn"
+
+/* ── Helpers ──────────────────────────────────────────────────────────── */
+
+static xcdn_node_t *event(int seq) {
+    xcdn_value_t *obj = xcdn_value_object();
+    xcdn_object_set(obj, "seq", xcdn_node_new(xcdn_value_int(seq)));
+    xcdn_object_set(obj, "kind", xcdn_node_new(xcdn_value_string("click\n")));
+    xcdn_node_t *node = xcdn_node_new(obj);
+    xcdn_node_add_tag(node, "evt");
+    return node;
+}
+
+static int append_events(xcdn_log_t *log, int from, int to) {
+    for (int i = from; i < to; i++) {
+        xcdn_node_t *node = event(i);
+        int rc = xcdn_log_append(log, node);
+        xcdn_node_free(node);
+        if (rc) return rc;
+    }
+    return 0;
+}
+
+static int64_t record_seq(const xcdn_document_t *doc) {
+    if (!doc || doc->values_len != 1) return -1;
+    const xcdn_node_t *seq = xcdn_object_get(doc->values[0]->value, "seq");
+    return seq ? xcdn_value_as_int(seq->value) : -1;
+}
+
+static char *read_file(size_t *len) {
+    FILE *f = fopen(LOG_PATH, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *buf = n >= 0 ? (char *)malloc((size_t)n + 1) : NULL;
+    if (!buf) {
+        fclose(f);
+        return NULL;
+    }
+    *len = fread(buf, 1, (size_t)n, f);
+    buf[*len] = '\0';
+    fclose(f);
+    return buf;
+}
+
+static void append_raw(const char *text) {
+    FILE *f = fopen(LOG_PATH, "ab");
+    fputs(text, f);
+    fclose(f);
+}
+
+/* Read every record; returns the final status and the count through *n. */
+static xcdn_log_status_t read_log(int *n, uint64_t *valid) {
+    xcdn_log_reader_t *r =
+        xcdn_log_reader_open(LOG_PATH, xcdn_parse_options_default(), NULL);
+    if (!r) return XCDN_LOG_ERR_IO;
+    xcdn_document_t *doc;
+    xcdn_log_status_t st;
+    *n = 0;
+    while ((st = xcdn_log_next(r, &doc, NULL)) == XCDN_LOG_OK) {
+        if (record_seq(doc) == *n) (*n)++;
+        xcdn_document_free(doc);
+    }
+    *valid = xcdn_log_reader_offset(r);
+    xcdn_log_reader_close(r);
+    return st;
+}
+
+/* ── Test: append, read back, seek ────────────────────────────────────── */
+
+static void test_log_roundtrip(void) {
+    printf("  test_log_roundtrip\n");
+    remove(LOG_PATH);
+    xcdn_log_index_t windex;
+    xcdn_log_index_init(&windex, 64);
+    xcdn_log_options_t opts = xcdn_log_options_default();
+    opts.sync_every = 100;
+    opts.sync_ms = 0;
+    opts.index = &windex;
+
+    xcdn_log_t *log = xcdn_log_open(LOG_PATH, opts);
+    ASSERT(log != NULL, "log created");
+    ASSERT_EQ_INT(append_events(log, 0, 1000), 0, "records appended");
+    ASSERT_EQ_INT(xcdn_log_records(log), 1000, "record count");
+    ASSERT_EQ_INT(xcdn_log_synced(log), 1000, "synced in groups of 100");
+    ASSERT_EQ_INT(append_events(log, 1000, 1050), 0, "more records appended");
+    ASSERT_EQ_INT(xcdn_log_synced(log), 1000, "partial group pending");
+    ASSERT_EQ_INT(xcdn_log_close(log), 0, "log closed");
+
+    /* The file is a stream document, one compact value per line */
+    size_t len = 0;
+    char *text = read_file(&len);
+    ASSERT(text != NULL, "log read back");
+    xcdn_error_t err;
+    xcdn_document_t *doc = xcdn_parse(text, &err);
+    ASSERT(doc != NULL, "log parses as a document");
+    ASSERT_EQ_INT(doc->values_len, 1050, "one value per record");
+    ASSERT(strncmp(text, "#evt {seq: 0,kind: \"click\\n\"}\n", 30) == 0,
+           "compact records");
+    xcdn_document_free(doc);
+
+    int n;
+    uint64_t valid;
+    ASSERT_EQ_INT(read_log(&n, &valid), XCDN_LOG_END, "clean end");
+    ASSERT_EQ_INT(n, 1050, "every record read in order");
+    ASSERT_EQ_INT(valid, len, "whole file valid");
+
+    /* Reader-built index matches the writer's, and seeks */
+    xcdn_log_index_t rindex;
+    xcdn_log_index_init(&rindex, 64);
+    xcdn_log_reader_t *r =
+        xcdn_log_reader_open(LOG_PATH, xcdn_parse_options_default(), &rindex);
+    while (xcdn_log_next(r, &doc, NULL) == XCDN_LOG_OK) xcdn_document_free(doc);
+    ASSERT_EQ_INT(rindex.len, 17, "one entry per 64 records");
+    ASSERT_EQ_INT(windex.len, rindex.len, "writer index complete");
+    ASSERT(memcmp(windex.offsets, rindex.offsets, rindex.len * sizeof(uint64_t)) == 0,
+           "writer and reader agree");
+    ASSERT_EQ_INT(text[rindex.offsets[3] - 1], '\n', "entries at line starts");
+
+    ASSERT_EQ_INT(xcdn_log_reader_seek(r, &rindex, 537), 0, "seek");
+    ASSERT_EQ_INT(xcdn_log_reader_record(r), 537, "positioned");
+    ASSERT_EQ_INT(xcdn_log_next(r, &doc, NULL), XCDN_LOG_OK, "read after seek");
+    ASSERT_EQ_INT(record_seq(doc), 537, "seeked record");
+    xcdn_document_free(doc);
+    ASSERT_EQ_INT(xcdn_log_reader_seek(r, NULL, 3), 0, "seek without index");
+    ASSERT_EQ_INT(xcdn_log_next(r, &doc, NULL), XCDN_LOG_OK, "read from start");
+    ASSERT_EQ_INT(record_seq(doc), 3, "scanned to record");
+    xcdn_document_free(doc);
+    ASSERT_EQ_INT(xcdn_log_reader_seek(r, &rindex, 1050), 0, "seek to the end");
+    ASSERT_EQ_INT(xcdn_log_next(r, &doc, NULL), XCDN_LOG_END, "nothing after it");
+    ASSERT_EQ_INT(xcdn_log_reader_seek(r, &rindex, 1051), -1, "seek past the end");
+    xcdn_log_reader_close(r);
+
+    /* Reopening continues the numbering and the index */
+    log = xcdn_log_open(LOG_PATH, opts);
+    ASSERT_EQ_INT(xcdn_log_records(log), 1050, "existing records counted");
+    ASSERT_EQ_INT(windex.len, 17, "index not duplicated");
+    ASSERT_EQ_INT(append_events(log, 1050, 1100), 0, "appended after reopen");
+    ASSERT_EQ_INT(xcdn_log_close(log), 0, "log closed");
+    ASSERT_EQ_INT(windex.len, 18, "index extended");
+    ASSERT_EQ_INT(read_log(&n, &valid), XCDN_LOG_END, "clean end");
+    ASSERT_EQ_INT(n, 1100, "all records");
+
+    free(text);
+    xcdn_log_index_free(&windex);
+    xcdn_log_index_free(&rindex);
+    remove(LOG_PATH);
+}
+
+/* ── Test: crash recovery ─────────────────────────────────────────────── */
+
+static void test_log_torn_tail(void) {
+    printf("  test_log_torn_tail\n");
+    const char *tails[] = {
+        "#evt {seq: 10,ki",     /* cut mid-record */
+        "12",                   /* parses, but its newline never made it */
+        "\x01\x02garbage\n",    /* unreadable final line */
+    };
+    for (int t = 0; t < 3; t++) {
+        remove(LOG_PATH);
+        xcdn_log_t *log = xcdn_log_open(LOG_PATH, xcdn_log_options_default());
+        append_events(log, 0, 10);
+        xcdn_log_close(log);
+        size_t good = 0;
+        char *text = read_file(&good);
+        ASSERT(text != NULL, "log read back");
+        free(text);
+        append_raw(tails[t]);
+
+        int n;
+        uint64_t valid;
+        ASSERT_EQ_INT(read_log(&n, &valid), XCDN_LOG_TORN, "torn tail detected");
+        ASSERT_EQ_INT(n, 10, "complete records read");
+        ASSERT_EQ_INT(valid, good, "valid length");
+
+        log = xcdn_log_open(LOG_PATH, xcdn_log_options_default());
+        ASSERT(log != NULL, "reopened");
+        ASSERT_EQ_INT(xcdn_log_records(log), 10, "torn record dropped");
+        append_events(log, 10, 12);
+        ASSERT_EQ_INT(xcdn_log_close(log), 0, "closed");
+        ASSERT_EQ_INT(read_log(&n, &valid), XCDN_LOG_END, "log repaired");
+        ASSERT_EQ_INT(n, 12, "appends follow the last good record");
+    }
+
+    /* Damage followed by more records is corruption, not a torn tail */
+    append_raw("{seq: \n#evt {seq: 12}\n");
+    xcdn_log_reader_t *r =
+        xcdn_log_reader_open(LOG_PATH, xcdn_parse_options_default(), NULL);
+    xcdn_document_t *doc;
+    xcdn_error_t err;
+    xcdn_log_status_t st;
+    while ((st = xcdn_log_next(r, &doc, &err)) == XCDN_LOG_OK)
+        xcdn_document_free(doc);
+    ASSERT_EQ_INT(st, XCDN_LOG_CORRUPT, "corruption detected");
+    ASSERT(err.kind != XCDN_ERR_NONE, "parser error reported");
+    ASSERT_EQ_INT(xcdn_log_reader_record(r), 12, "stopped at the bad record");
+    ASSERT_EQ_INT(xcdn_log_next(r, &doc, &err), XCDN_LOG_CORRUPT, "sticky");
+    xcdn_log_reader_close(r);
+    remove(LOG_PATH);
+}
+
+/* ── Test: group commit policy ────────────────────────────────────────── */
+
+static void test_log_group_commit(void) {
+    printf("  test_log_group_commit\n");
+    remove(LOG_PATH);
+    xcdn_log_options_t opts = xcdn_log_options_default();
+    opts.sync_every = 0;
+    opts.sync_ms = 0;
+    opts.buffer = 256;
+    xcdn_log_t *log = xcdn_log_open(LOG_PATH, opts);
+    append_events(log, 0, 50);
+    ASSERT_EQ_INT(xcdn_log_synced(log), 0, "no policy, no sync");
+    size_t len = 0;
+    char *text = read_file(&len);
+    ASSERT(text != NULL, "log read back");
+    free(text);
+    ASSERT(len > 0, "full buffers written early");
+    ASSERT_EQ_INT(xcdn_log_sync(log), 0, "explicit sync");
+    ASSERT_EQ_INT(xcdn_log_synced(log), 50, "all synced");
+    xcdn_log_close(log);
+
+    remove(LOG_PATH);
+    opts.sync_ms = 2;
+    log = xcdn_log_open(LOG_PATH, opts);
+    append_events(log, 0, 1);
+    ASSERT_EQ_INT(xcdn_log_synced(log), 0, "first record pending");
+    clock_t start = clock();
+    struct timespec t0, t1;
+    timespec_get(&t0, TIME_UTC);
+    do {
+        timespec_get(&t1, TIME_UTC);
+    } while ((t1.tv_sec - t0.tv_sec) * 1000 + (t1.tv_nsec - t0.tv_nsec) / 1000000 < 3 &&
+             clock() - start < CLOCKS_PER_SEC);
+    append_events(log, 1, 2);
+    ASSERT_EQ_INT(xcdn_log_synced(log), 2, "synced once the oldest aged");
+    xcdn_log_close(log);
+    remove(LOG_PATH);
+}
+
+/* ── Main ─────────────────────────────────────────────────────────────── */
+
+int main(void) {
+    printf("=== Log Tests ===\n");
+
+    test_log_roundtrip();
+    test_log_torn_tail();
+    test_log_group_commit();
+
+    printf("\n%d/%d tests passed\n", tests_passed, tests_run);
+    return tests_passed == tests_run ? 0 : 1;
+}
@@ -347,6 +347,498 @@ static void test_parse_trailing_commas(void) {
     xcdn_document_free(doc);
 }
 
+/* ── Test: pipelined mode matches sequential parsing ────────────────── */
+
+static void test_parse_pipelined(void) {
+    printf("  test_parse_pipelined\n");
+    /* Large enough to wrap the token ring several times */
+    size_t cap = 1 << 17, len = 0;
+    char *src = (char *)malloc(cap);
+    len += (size_t)snprintf(src + len, cap - len, "items: [");
+    for (int i = 0; i < 2000; i++)
+        len += (size_t)snprintf(src + len, cap - len,
+                                "#t { id: %d, name: \"n%d\", f: %d.5 },", i, i, i);
+    len += (size_t)snprintf(src + len, cap - len, "]");
+
+    xcdn_parse_options_t opts = xcdn_parse_options_default();
+    opts.pipelined = true;
+
+    xcdn_error_t err;
+    xcdn_document_t *seq = xcdn_parse_str(src, len, &err);
+    xcdn_document_t *pip = xcdn_parse_str_with_options(src, len, opts, &err);
+    ASSERT(seq != NULL && pip != NULL, "both parses succeeded");
+    char *a = xcdn_to_string_compact(seq);
+    char *b = xcdn_to_string_compact(pip);
+    ASSERT(strcmp(a, b) == 0, "same document");
+    free(a);
+    free(b);
+    xcdn_document_free(seq);
+    xcdn_document_free(pip);
+
+    /* Lexer error deep in the input */
+    src[len - 10] = '%';
+    xcdn_error_t err_seq, err_pip;
+    ASSERT(xcdn_parse_str(src, len, &err_seq) == NULL, "sequential fails");
+    ASSERT(xcdn_parse_str_with_options(src, len, opts, &err_pip) == NULL,
+           "pipelined fails");
+    ASSERT_EQ_INT(err_pip.kind, err_seq.kind, "same error kind");
+    ASSERT_EQ_INT((int)err_pip.span.offset, (int)err_seq.span.offset,
+                  "same error offset");
+
+    /* Parser error early on while the lexer still has most of the input */
+    src[2] = ':';
+    ASSERT(xcdn_parse_str_with_options(src, len, opts, &err_pip) == NULL,
+           "early parse error");
+    ASSERT_EQ_INT(err_pip.kind, XCDN_ERR_EXPECTED, "expected-token error");
+
+    free(src);
+}
+
+/* ── Test: incremental reparsing ──────────────────────────────────────── */
+
+/* Does the session's document match a fresh parse of its text? */
+static int incr_matches_full(const xcdn_incr_t *inc) {
+    size_t len;
+    const char *text = xcdn_incr_text(inc, &len);
+    xcdn_error_t err;
+    xcdn_document_t *full = xcdn_parse_str(text, len, &err);
+    const xcdn_document_t *cur = xcdn_incr_document(inc);
+    if (!full || !cur) {
+        xcdn_document_free(full);
+        return !full && !cur;
+    }
+    char *a = xcdn_to_string_compact(full);
+    char *b = xcdn_to_string_compact(cur);
+    int same = strcmp(a, b) == 0;
+    free(a);
+    free(b);
+    xcdn_document_free(full);
+    return same;
+}
+
+static size_t offset_of(const xcdn_incr_t *inc, const char *needle) {
+    const char *text = xcdn_incr_text(inc, NULL);
+    return (size_t)(strstr(text, needle) - text);
+}
+
+static void test_parse_incremental(void) {
+    printf("  test_parse_incremental\n");
+    const char *src =
+        "config: {\n"
+        "  name: \"svc\",\n"
+        "  ports: [80, 443],  // public\n"
+        "  debug: false\n"
+        "}\n";
+    xcdn_error_t err;
+    xcdn_incr_t *inc = xcdn_incr_new(src, strlen(src),
+                                     xcdn_parse_options_default(), &err);
+    ASSERT(inc != NULL && xcdn_incr_document(inc) != NULL, "session created");
+
+    const xcdn_document_t *doc = xcdn_incr_document(inc);
+    xcdn_node_t *config = xcdn_document_get_key(doc, "config");
+    xcdn_node_t *name = xcdn_object_get(config->value, "name");
+    xcdn_node_t *ports = xcdn_object_get(config->value, "ports");
+
+    /* Edit inside a nested array: only that element is rebuilt */
+    doc = xcdn_incr_edit(inc, offset_of(inc, "443"), 3, "8443", 4, &err);
+    ASSERT(doc != NULL, "edit applied");
+    ASSERT(xcdn_incr_changed_parent(inc) == ports, "spliced into ports");
+    ASSERT_EQ_INT((int)xcdn_incr_changed_count(inc), 1, "one new node");
+    ASSERT_EQ_INT((int)xcdn_value_as_int(xcdn_incr_changed_at(inc, 0)->value),
+                  8443, "new value");
+    ASSERT(xcdn_object_get(config->value, "name") == name, "siblings kept");
+    ASSERT(incr_matches_full(inc), "matches full parse");
+
+    /* Append an element */
+    doc = xcdn_incr_edit(inc, offset_of(inc, "]"), 0, ", 9000", 6, &err);
+    ASSERT(xcdn_incr_changed_parent(inc) == ports, "append spliced");
+    ASSERT_EQ_INT((int)xcdn_array_len(ports->value), 3, "three ports");
+    ASSERT(incr_matches_full(inc), "matches after append");
+
+    /* Insert an entry into the object, after the comment */
+    doc = xcdn_incr_edit(inc, offset_of(inc, "  debug"), 0, "  tls: true,\n", 13,
+                         &err);
+    ASSERT(xcdn_incr_changed_parent(inc) == config, "entry spliced");
+    ASSERT(xcdn_object_get(config->value, "tls") != NULL, "tls present");
+    ASSERT(xcdn_object_get(config->value, "ports") == ports, "ports kept");
+    ASSERT(incr_matches_full(inc), "matches after insert");
+
+    /* A duplicate key changes other entries: full reparse */
+    doc = xcdn_incr_edit(inc, offset_of(inc, "tls"), 3, "name", 4, &err);
+    ASSERT(doc != NULL, "duplicate key parses");
+    ASSERT(xcdn_incr_changed_parent(inc) == NULL, "fell back to full parse");
+    ASSERT(incr_matches_full(inc), "matches after fallback");
+
+    /* Opening a block comment swallows the rest: error, then recovery */
+    size_t at = offset_of(inc, "false");
+    ASSERT(xcdn_incr_edit(inc, at, 0, "/*", 2, &err) == NULL, "edit breaks text");
+    ASSERT(xcdn_incr_document(inc) == NULL, "no document");
+    ASSERT(xcdn_incr_edit(inc, at, 2, "", 0, &err) != NULL, "text fixed");
+    ASSERT(incr_matches_full(inc), "matches after recovery");
+
+    ASSERT(xcdn_incr_edit(inc, 1000, 0, "x", 1, &err) == NULL, "out of range");
+    ASSERT(incr_matches_full(inc), "text unchanged");
+    xcdn_incr_free(inc);
+
+    /* Random edits always agree with a full parse */
+    const char *base = "{ a: [1, 2, [3, \"x\"]], b: { c: 4, d: \"y\" }, e: 5 } [6]";
+    const char alphabet[] = " ,:[]{}1a\"/*\n#";
+    inc = xcdn_incr_new(base, strlen(base), xcdn_parse_options_default(), &err);
+    unsigned seed = 12345;
+    int agree = 1;
+    for (int i = 0; i < 3000 && agree; i++) {
+        size_t len;
+        xcdn_incr_text(inc, &len);
+        seed = seed * 1103515245u + 12345u;
+        size_t off = (seed >> 8) % (len + 1);
+        seed = seed * 1103515245u + 12345u;
+        size_t removed = (len - off) > 0 ? (seed >> 8) % 3 % (len - off + 1) : 0;
+        seed = seed * 1103515245u + 12345u;
+        char ch = alphabet[(seed >> 8) % (sizeof(alphabet) - 1)];
+        size_t ins = ((seed >> 20) & 1) ? 1 : 0;
+        xcdn_incr_edit(inc, off, removed, &ch, ins, &err);
+        agree = incr_matches_full(inc);
+        if (i % 200 == 199) {
+            /* Start over from the valid text now and then */
+            xcdn_incr_text(inc, &len);
+            xcdn_incr_edit(inc, 0, len, base, strlen(base), &err);
+        }
+    }
+    ASSERT(agree, "random edits match full parses");
+    xcdn_incr_free(inc);
+}
+
+static void test_parse_incremental_dup_keys(void) {
+    printf("  test_parse_incremental_dup_keys\n");
+    const char *src = "{a: 1, b: [1, 2, 3], c: {d: \"x\", e: [4, 5]}}";
+    xcdn_error_t err;
+    xcdn_incr_t *inc = xcdn_incr_new(src, strlen(src),
+                                     xcdn_parse_options_default(), &err);
+    ASSERT(inc != NULL && xcdn_incr_document(inc) != NULL, "session created");
+
+    /* The second `c` takes the first entry's slot: out of source order */
+    ASSERT(xcdn_incr_edit(inc, 1, 1, "c", 1, &err) != NULL, "rename parses");
+    ASSERT(incr_matches_full(inc), "matches after rename");
+    ASSERT(xcdn_incr_edit(inc, offset_of(inc, "c: {") + 1, 0, "2", 1, &err)
+               != NULL, "insert parses");
+    ASSERT(incr_matches_full(inc), "matches after edit past a duplicate");
+    const xcdn_node_t *c = xcdn_document_get_key(xcdn_incr_document(inc), "c");
+    ASSERT(c && xcdn_value_as_int(c->value) == 1, "c keeps the later value");
+
+    /* Once the duplicate is gone, edits splice again */
+    ASSERT(xcdn_incr_edit(inc, 1, 1, "a", 1, &err) != NULL, "rename back");
+    ASSERT(xcdn_incr_edit(inc, offset_of(inc, "3"), 1, "7", 1, &err) != NULL,
+           "array edit");
+    ASSERT(xcdn_incr_changed_parent(inc) != NULL, "spliced again");
+    ASSERT(incr_matches_full(inc), "matches after splice");
+    xcdn_incr_free(inc);
+
+    /* Random key edits, so duplicates come and go */
+    const char *base = "{a: 1, b: [1, 2], c: {a: 2, b: 3}, d: 4}";
+    const char alphabet[] = "abcd ,:1{}[]";
+    inc = xcdn_incr_new(base, strlen(base), xcdn_parse_options_default(), &err);
+    unsigned seed = 54321;
+    int agree = 1;
+    for (int i = 0; i < 3000 && agree; i++) {
+        size_t len;
+        xcdn_incr_text(inc, &len);
+        seed = seed * 1103515245u + 12345u;
+        size_t off = (seed >> 8) % (len + 1);
+        seed = seed * 1103515245u + 12345u;
+        size_t removed = (len - off) > 0 ? (seed >> 8) % 2 % (len - off + 1) : 0;
+        seed = seed * 1103515245u + 12345u;
+        char ch = alphabet[(seed >> 8) % (sizeof(alphabet) - 1)];
+        size_t ins = ((seed >> 20) & 3) ? 1 : 0;
+        xcdn_incr_edit(inc, off, removed, &ch, ins, &err);
+        agree = incr_matches_full(inc);
+        if (i % 100 == 99) {
+            xcdn_incr_text(inc, &len);
+            xcdn_incr_edit(inc, 0, len, base, strlen(base), &err);
+        }
+    }
+    ASSERT(agree, "random key edits match full parses");
+    xcdn_incr_free(inc);
+}
+
+/* ── Test: recorded source spans ──────────────────────────────────────── */
+
+static void test_parse_spans(void) {
+    printf("  test_parse_spans\n");
+    const char *src =
+        "name: \"svc\",\n"
+        "limits: {\n"
+        "  timeout: @unit(\"ms\") 250,\n"
+        "  hosts: [\"a\", \"bb\"]\n"
+        "}\n";
+    xcdn_parse_options_t opts = xcdn_parse_options_default();
+    opts.record_spans = true;
+
+    xcdn_error_t err;
+    xcdn_document_t *doc = xcdn_parse_str_with_options(src, strlen(src), opts, &err);
+    ASSERT(doc != NULL, "parse succeeded");
+
+    xcdn_node_t *limits = xcdn_document_get_key(doc, "limits");
+    xcdn_node_t *timeout = xcdn_object_get(limits->value, "timeout");
+    xcdn_node_t *hosts = xcdn_object_get(limits->value, "hosts");
+    xcdn_span_t start, end;
+
+    ASSERT(xcdn_node_span(doc, timeout, &start, &end), "timeout has a span");
+    ASSERT_EQ_INT((int)start.line, 3, "timeout line");
+    ASSERT_EQ_INT((int)start.column, 24, "timeout column");
+    ASSERT_EQ_INT((int)(end.offset - start.offset), 3, "timeout length");
+
+    ASSERT(xcdn_node_span(doc, xcdn_array_get(hosts->value, 1), &start, NULL),
+           "array item has a span");
+    ASSERT_EQ_INT((int)start.line, 4, "item line");
+    ASSERT_EQ_INT((int)start.column, 16, "item column");
+
+    ASSERT(xcdn_node_span(doc, limits, &start, &end), "object has a span");
+    ASSERT_EQ_INT((int)start.line, 2, "object starts at its brace");
+    ASSERT_EQ_INT((int)start.column, 9, "object column");
+    ASSERT_EQ_INT((int)end.line, 5, "object end line");
+    ASSERT_EQ_INT((int)end.column, 2, "object end column");
+
+    /* The implicit top-level object has no text of its own */
+    ASSERT(!xcdn_node_span(doc, doc->values[0], NULL, NULL), "no implicit span");
+    xcdn_document_free(doc);
+
+    /* Off by default */
+    doc = xcdn_parse(src, &err);
+    limits = xcdn_document_get_key(doc, "limits");
+    ASSERT(!xcdn_node_span(doc, limits, &start, &end), "no spans recorded");
+    xcdn_document_free(doc);
+}
+
+/* ── Test: strict UTF-8 option ────────────────────────────────────────── */
+
+static void test_parse_validate_utf8(void) {
+    printf("  test_parse_validate_utf8\n");
+    const char *good = "name: \"Jos\xc3\xa9\", id: \"a1\"";
+    const char *bad = "name: \"ok\",\nnote: \"bad \xc3(\"";
+    xcdn_parse_options_t opts = xcdn_parse_options_default();
+    opts.validate_utf8 = true;
+
+    xcdn_error_t err;
+    xcdn_document_t *doc = xcdn_parse_str_with_options(good, strlen(good), opts, &err);
+    ASSERT(doc != NULL, "valid UTF-8 accepted");
+    ASSERT(!xcdn_value_is_ascii(xcdn_document_get_key(doc, "name")->value),
+           "name is not ascii");
+    const xcdn_value_t *id = xcdn_document_get_key(doc, "id")->value;
+    ASSERT(id->flags & XCDN_FLAG_ASCII, "id flagged ascii by the lexer");
+    ASSERT(xcdn_value_is_ascii(id), "id is ascii");
+    xcdn_document_free(doc);
+
+    ASSERT(xcdn_parse_str_with_options(bad, strlen(bad), opts, &err) == NULL,
+           "invalid UTF-8 rejected");
+    ASSERT_EQ_INT(err.kind, XCDN_ERR_INVALID_UTF8, "utf8 error kind");
+    ASSERT_EQ_INT((int)err.span.line, 2, "error line");
+    ASSERT_EQ_INT((int)err.span.column, 12, "error column");
+
+    opts.pipelined = true;
+    ASSERT(xcdn_parse_str_with_options(bad, strlen(bad), opts, &err) == NULL,
+           "pipelined mode validates too");
+    ASSERT_EQ_INT((int)err.span.column, 12, "same column when pipelined");
+
+    doc = xcdn_parse(bad, &err);
+    ASSERT(doc != NULL, "accepted without the option");
+    xcdn_document_free(doc);
+}
+
+/* ── Test: lazy bytes option ──────────────────────────────────────────── */
+
+static void test_parse_lazy_bytes(void) {
+    printf("  test_parse_lazy_bytes\n");
+    const char *src = "icon: b\"aGVs bG8=\", url: b\"-_8\", empty: b\"\"";
+    xcdn_parse_options_t opts = xcdn_parse_options_default();
+    opts.lazy_bytes = true;
+
+    xcdn_error_t err;
+    xcdn_document_t *doc = xcdn_parse_str_with_options(src, strlen(src), opts, &err);
+    ASSERT(doc != NULL, "parse succeeded");
+    const xcdn_value_t *icon = xcdn_document_get_key(doc, "icon")->value;
+    ASSERT(icon->data.bytes.data == NULL, "not decoded at parse time");
+
+    char *text = xcdn_to_string_compact(doc);
+    ASSERT(strstr(text, "b\"aGVs bG8=\"") != NULL, "original text written back");
+    free(text);
+
+    size_t len = 0;
+    const uint8_t *data = xcdn_value_as_bytes(icon, &len);
+    ASSERT(data != NULL && len == 5 && memcmp(data, "hello", 5) == 0,
+           "decoded on first access");
+    ASSERT(xcdn_value_as_bytes(icon, &len) == data, "decoded once");
+    data = xcdn_value_as_bytes(xcdn_document_get_key(doc, "url")->value, &len);
+    ASSERT(len == 2 && data[0] == 0xfb && data[1] == 0xff, "url-safe alphabet");
+    xcdn_value_as_bytes(xcdn_document_get_key(doc, "empty")->value, &len);
+    ASSERT_EQ_INT((int)len, 0, "empty payload");
+    xcdn_document_free(doc);
+
+    const char *bad = "icon: b\"aGVs*\"";
+    ASSERT(xcdn_parse_str_with_options(bad, strlen(bad), opts, &err) == NULL,
+           "invalid base64 still rejected at parse time");
+    ASSERT_EQ_INT(err.kind, XCDN_ERR_INVALID_BASE64, "base64 error kind");
+}
+
+/* ── Test: raw numbers option ─────────────────────────────────────────── */
+
+static void test_parse_raw_numbers(void) {
+    printf("  test_parse_raw_numbers\n");
+    const char *src = "a: 0042, b: -1.50e+3, c: 123456789012345678901234567890,"
+                      " d: [1.0, +7]";
+    xcdn_parse_options_t opts = xcdn_parse_options_default();
+    opts.raw_numbers = true;
+
+    for (int pipelined = 0; pipelined < 2; pipelined++) {
+        opts.pipelined = pipelined;
+        xcdn_error_t err;
+        xcdn_document_t *doc = xcdn_parse_str_with_options(src, strlen(src), opts, &err);
+        ASSERT(doc != NULL, "parse succeeded");
+
+        const xcdn_value_t *a = xcdn_document_get_key(doc, "a")->value;
+        ASSERT(a->flags & XCDN_FLAG_PENDING, "not converted at parse time");
+        ASSERT_EQ_INT((int)xcdn_value_as_int(a), 42, "a converted on access");
+        ASSERT(!(a->flags & XCDN_FLAG_PENDING), "conversion kept");
+        const xcdn_value_t *b = xcdn_document_get_key(doc, "b")->value;
+        ASSERT(b->type == XCDN_VAL_FLOAT && xcdn_value_as_float(b) == -1500.0,
+               "b converted on access");
+        size_t len = 0;
+        const char *text = xcdn_value_number_text(
+            xcdn_document_get_key(doc, "c")->value, &len);
+        ASSERT(text && len == 30 && strncmp(text, "1234567890", 10) == 0,
+               "long lexeme kept");
+
+        char *out = xcdn_to_string_compact(doc);
+        ASSERT(strcmp(out, "{a: 0042,b: -1.50e+3,"
+                           "c: 123456789012345678901234567890,d: [1.0,+7]}") == 0,
+               "lexemes echoed byte-for-byte");
+        free(out);
+
+        xcdn_document_freeze(doc);
+        const xcdn_value_t *d0 = xcdn_array_get(
+            xcdn_document_get_key(doc, "d")->value, 0)->value;
+        ASSERT(!(d0->flags & XCDN_FLAG_PENDING), "freeze converts");
+        xcdn_document_free(doc);
+    }
+
+    xcdn_error_t err;
+    opts.pipelined = false;
+    ASSERT(xcdn_parse_str_with_options("v: -.e5", 7, opts, &err) == NULL,
+           "unreadable number still rejected");
+    ASSERT_EQ_INT(err.kind, XCDN_ERR_INVALID_NUMBER, "number error kind");
+}
+
+/* ── Test: string deduplication option ────────────────────────────────── */
+
+static void test_parse_dedup_strings(void) {
+    printf("  test_parse_dedup_strings\n");
+    const char *src =
+        "a: \"primary.example.org\", b: \"primary.example.org\","
+        " c: \"replica.example.org\", d: \"role\", e: \"role\","
+        " f: t\"2024-01-01T00:00:00Z\", g: [t\"2024-01-01T00:00:00Z\"],"
+        " h: \"primary.example.org\"";
+    xcdn_parse_options_t opts = xcdn_parse_options_default();
+    opts.dedup_strings = 64;
+
+    xcdn_error_t err;
+    xcdn_document_t *doc = xcdn_parse_str_with_options(src, strlen(src), opts, &err);
+    ASSERT(doc != NULL, "parse succeeded");
+    const xcdn_value_t *a = xcdn_document_get_key(doc, "a")->value;
+    const xcdn_value_t *b = xcdn_document_get_key(doc, "b")->value;
+    const xcdn_value_t *c = xcdn_document_get_key(doc, "c")->value;
+    ASSERT(a->flags & XCDN_FLAG_POOLED, "long string pooled");
+    ASSERT(a->data.string == b->data.string, "equal strings share a buffer");
+    ASSERT(xcdn_value_string_equal(a, b), "equal");
+    ASSERT(!xcdn_value_string_equal(a, c), "not equal");
+    const xcdn_value_t *d = xcdn_document_get_key(doc, "d")->value;
+    ASSERT(!(d->flags & XCDN_FLAG_POOLED), "short string stays inline");
+    ASSERT(xcdn_value_string_equal(d, xcdn_document_get_key(doc, "e")->value),
+           "inline strings compare by content");
+    const xcdn_value_t *f = xcdn_document_get_key(doc, "f")->value;
+    const xcdn_value_t *g0 = xcdn_array_get(xcdn_document_get_key(doc, "g")->value,
+                                            0)->value;
+    ASSERT(f->type == XCDN_VAL_DATETIME && f->data.string == g0->data.string,
+           "datetimes pooled");
+
+    /* Shared buffers outlive the values replaced before them */
+    xcdn_object_set(doc->values[0]->value, "a", xcdn_node_new(xcdn_value_int(1)));
+    ASSERT_EQ_STR(xcdn_value_as_string(b), "primary.example.org",
+                  "buffer still referenced");
+
+    xcdn_document_t *plain = xcdn_parse(src, &err);
+    ASSERT(xcdn_value_string_equal(b, xcdn_document_get_key(plain, "h")->value),
+           "pooled and unpooled values compare by content");
+    xcdn_object_set(plain->values[0]->value, "a", xcdn_node_new(xcdn_value_int(1)));
+    char *x = xcdn_to_string_compact(plain);
+    char *y = xcdn_to_string_compact(doc);
+    ASSERT_EQ_STR(x, y, "same output as without the pool");
+    free(x);
+    free(y);
+    xcdn_document_free(plain);
+    xcdn_document_free(doc);
+}
+
+/* ── Test: shaped objects ─────────────────────────────────────────────── */
+
+static void test_parse_shape_objects(void) {
+    printf("  test_parse_shape_objects\n");
+    const char *src =
+        "rows: [{ id: 1, name: \"a\", a_rather_long_key_name: true },"
+        " { id: 2, name: \"b\", a_rather_long_key_name: false },"
+        " { name: \"c\", id: 3 }],"
+        " wide: { k0: 0, k1: 1, k2: 2, k3: 3, k4: 4, k5: 5, k6: 6, k7: 7, k8: 8, k9: 9 }";
+    xcdn_parse_options_t opts = xcdn_parse_options_default();
+    opts.shape_objects = true;
+
+    xcdn_error_t err;
+    xcdn_document_t *doc = xcdn_parse_str_with_options(src, strlen(src), opts, &err);
+    ASSERT(doc != NULL, "parse succeeded");
+    xcdn_value_t *rows = xcdn_document_get_key(doc, "rows")->value;
+    xcdn_value_t *r0 = xcdn_array_get(rows, 0)->value;
+    xcdn_value_t *r1 = xcdn_array_get(rows, 1)->value;
+    xcdn_value_t *r2 = xcdn_array_get(rows, 2)->value;
+    ASSERT(r0->data.object.shape != NULL, "record shaped");
+    ASSERT(r0->data.object.shape == r1->data.object.shape, "same keys share a shape");
+    ASSERT(r0->data.object.shape != r2->data.object.shape, "key order matters");
+    ASSERT_EQ_STR(xcdn_object_key_at(r1, 2), "a_rather_long_key_name", "key from shape");
+    ASSERT(!xcdn_value_as_bool(xcdn_object_get(r1, "a_rather_long_key_name")->value),
+           "lookup through shape");
+    ASSERT(xcdn_object_get(r1, "missing") == NULL, "missing key");
+
+    size_t hint = 0;
+    int64_t sum = 0;
+    for (size_t i = 0; i < xcdn_array_len(rows); i++)
+        sum += xcdn_value_as_int(
+            xcdn_object_get_cached(xcdn_array_get(rows, i)->value, "id", &hint)->value);
+    ASSERT_EQ_INT((int)sum, 6, "cached lookups across shapes");
+
+    xcdn_value_t *wide = xcdn_document_get_key(doc, "wide")->value;
+    ASSERT(wide->data.object.shape->index != NULL, "long shape indexed");
+    ASSERT_EQ_INT((int)xcdn_value_as_int(xcdn_object_get(wide, "k7")->value), 7,
+                  "indexed lookup");
+
+    /* Replacing a value keeps the shape; adding a key leaves it */
+    xcdn_object_set(r0, "id", xcdn_node_new(xcdn_value_int(10)));
+    ASSERT(r0->data.object.shape == r1->data.object.shape, "update keeps shape");
+    xcdn_object_set(r0, "extra", xcdn_node_new(xcdn_value_null()));
+    ASSERT(r0->data.object.shape == NULL, "new key unshapes");
+    ASSERT_EQ_INT((int)xcdn_object_len(r0), 4, "entry added");
+    ASSERT_EQ_STR(xcdn_object_key_at(r0, 2), "a_rather_long_key_name", "keys kept");
+    ASSERT_EQ_STR(xcdn_object_key_at(r1, 2), "a_rather_long_key_name",
+                  "shape still valid for others");
+
+    xcdn_document_t *plain = xcdn_parse(src, &err);
+    xcdn_value_t *p0 = xcdn_array_get(xcdn_document_get_key(plain, "rows")->value, 0)->value;
+    xcdn_object_set(p0, "id", xcdn_node_new(xcdn_value_int(10)));
+    xcdn_object_set(p0, "extra", xcdn_node_new(xcdn_value_null()));
+    char *x = xcdn_to_string_pretty(plain);
+    char *y = xcdn_to_string_pretty(doc);
+    ASSERT_EQ_STR(x, y, "same output as without shapes");
+    free(x);
+    free(y);
+    xcdn_document_free(plain);
+    xcdn_document_free(doc);
+}
+
 /* ── Main ─────────────────────────────────────────────────────────────── */
 
 int main(void) {
@@ -362,6 +854,15 @@ int main(void) {
     test_parse_multiple_decorations();
     test_parse_empty_document();
     test_parse_trailing_commas();
+    test_parse_pipelined();
+    test_parse_spans();
+    test_parse_validate_utf8();
+    test_parse_lazy_bytes();
+    test_parse_raw_numbers();
+    test_parse_dedup_strings();
+    test_parse_shape_objects();
+    test_parse_incremental();
+    test_parse_incremental_dup_keys();
 
     printf("\n%d/%d tests passed\n", tests_passed, tests_run);
     return tests_passed == tests_run ? 0 : 1;
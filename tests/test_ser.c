@@ -106,6 +106,50 @@ static void test_serialize_string_escapes(void) {
     xcdn_document_free(doc);
 }
 
+/* ── Test: string metadata flags ──────────────────────────────────────── */
+
+static void test_serialize_string_flags(void) {
+    printf("  test_serialize_string_flags\n");
+    const uint32_t plain_ident = XCDN_FLAG_SCANNED | XCDN_FLAG_ASCII |
+                                 XCDN_FLAG_PLAIN | XCDN_FLAG_IDENT;
+    xcdn_error_t err;
+    xcdn_document_t *doc = xcdn_parse(
+        "{ id: \"snake_case\", \"two words\": \"caf\xc3\xa9\","
+        " esc: \"a\\tb\", raw: \"\"\"x\"y\"\"\" }", &err);
+    ASSERT(doc != NULL, "parse succeeded");
+
+    const xcdn_value_t *obj = doc->values[0]->value;
+    const xcdn_object_entry_t *e = obj->data.object.entries;
+    ASSERT_EQ_INT((int)e[0].key_flags, (int)plain_ident, "bare key flags");
+    ASSERT_EQ_INT((int)e[0].key_len, 2, "bare key length");
+    ASSERT_EQ_INT((int)e[1].key_flags,
+                  (int)(XCDN_FLAG_SCANNED | XCDN_FLAG_ASCII | XCDN_FLAG_PLAIN),
+                  "quoted key is plain but not an identifier");
+
+    const xcdn_value_t *v = e[0].node->value;
+    ASSERT_EQ_INT((int)(v->flags & plain_ident), (int)plain_ident,
+                  "identifier-like value");
+    ASSERT_EQ_INT((int)v->data.string_len, 10, "value length");
+    v = e[1].node->value;
+    ASSERT((v->flags & XCDN_FLAG_PLAIN) && !(v->flags & XCDN_FLAG_ASCII),
+           "non-ASCII plain value");
+    ASSERT(!(e[2].node->value->flags & XCDN_FLAG_PLAIN), "escape is not plain");
+    ASSERT(!(e[3].node->value->flags & XCDN_FLAG_PLAIN), "quote is not plain");
+
+    xcdn_value_t *built = xcdn_value_string("tab\there");
+    ASSERT((built->flags & XCDN_FLAG_SCANNED) && !(built->flags & XCDN_FLAG_PLAIN),
+           "constructed value scanned");
+    xcdn_value_free(built);
+
+    char *s = xcdn_to_string_compact(doc);
+    ASSERT(s != NULL, "serialized ok");
+    ASSERT(strcmp(s, "{id: \"snake_case\",\"two words\": \"caf\xc3\xa9\","
+                     "esc: \"a\\\\tb\",raw: \"x\\\"y\"}") == 0,
+           "fast paths write the same text");
+    free(s);
+    xcdn_document_free(doc);
+}
+
 /* ── Test: all types serialize ────────────────────────────────────────── */
 
 static void test_serialize_all_types(void) {
@@ -251,6 +295,348 @@ static void test_serialize_prolog(void) {
     xcdn_document_free(doc);
 }
 
+/* ── Test: parallel serializer matches the sequential one ─────────────── */
+
+static xcdn_document_t *build_large_doc(void) {
+    xcdn_document_t *doc = xcdn_document_new();
+    xcdn_document_push_directive(doc, "schema", xcdn_value_string("s"));
+
+    /* records: [ {id, name, tags: [..]} x 500 ], grid: [[..] x 70] */
+    xcdn_value_t *root = xcdn_value_object();
+    xcdn_value_t *records = xcdn_value_array();
+    char name[32];
+    for (int i = 0; i < 500; i++) {
+        xcdn_value_t *rec = xcdn_value_object();
+        snprintf(name, sizeof(name), "rec \"%d\"", i);
+        xcdn_object_set(rec, "id", xcdn_node_new(xcdn_value_int(i)));
+        xcdn_object_set(rec, "name", xcdn_node_new(xcdn_value_string(name)));
+        xcdn_node_t *rn = xcdn_node_new(rec);
+        if (i % 7 == 0) xcdn_node_add_tag(rn, "odd");
+        xcdn_array_push(records, rn);
+    }
+    xcdn_node_t *records_node = xcdn_node_new(records);
+    xcdn_node_add_annotation(records_node, "table");
+    xcdn_object_set(root, "records", records_node);
+
+    xcdn_value_t *grid = xcdn_value_array();
+    for (int i = 0; i < 70; i++) {
+        xcdn_value_t *row = xcdn_value_array();
+        for (int j = 0; j < 70; j++)
+            xcdn_array_push(row, xcdn_node_new(xcdn_value_int(i * j)));
+        xcdn_array_push(grid, xcdn_node_new(row));
+    }
+    xcdn_object_set(root, "grid", xcdn_node_new(grid));
+    xcdn_object_set(root, "empty", xcdn_node_new(xcdn_value_array()));
+    xcdn_document_push_value(doc, xcdn_node_new(root));
+
+    /* A stream tail of small values */
+    for (int i = 0; i < 100; i++)
+        xcdn_document_push_value(doc, xcdn_node_new(xcdn_value_int(i)));
+    return doc;
+}
+
+typedef struct {
+    char  *buf;
+    size_t len;
+    int    calls;
+} collect_t;
+
+static int collect_sink(void *ctx, const char *data, size_t len) {
+    collect_t *c = (collect_t *)ctx;
+    c->buf = (char *)realloc(c->buf, c->len + len + 1);
+    memcpy(c->buf + c->len, data, len);
+    c->len += len;
+    c->buf[c->len] = '\0';
+    c->calls++;
+    return 0;
+}
+
+static void test_serialize_parallel(void) {
+    printf("  test_serialize_parallel\n");
+    xcdn_document_t *doc = build_large_doc();
+    ASSERT(doc != NULL, "doc built");
+
+    xcdn_format_t fmts[3] = {
+        xcdn_format_default(), xcdn_format_compact(), {true, 4, false}
+    };
+    int thread_counts[3] = {1, 2, 4};
+    for (int f = 0; f < 3; f++) {
+        char *seq = xcdn_to_string_with_format(doc, fmts[f]);
+        for (int t = 0; t < 3; t++) {
+            char *par = xcdn_to_string_parallel(doc, fmts[f], thread_counts[t]);
+            ASSERT(par != NULL, "parallel serialize ok");
+            ASSERT(strcmp(seq, par) == 0, "parallel output identical");
+            free(par);
+        }
+        free(seq);
+    }
+
+    collect_t c = {NULL, 0, 0};
+    ASSERT_EQ_INT(xcdn_write_parallel(doc, xcdn_format_default(), 4,
+                                      collect_sink, &c), 0, "sink write ok");
+    char *seq = xcdn_to_string_pretty(doc);
+    ASSERT(c.calls > 1, "output delivered in several chunks");
+    ASSERT(c.buf && strcmp(seq, c.buf) == 0, "sink output identical");
+    free(seq);
+    free(c.buf);
+
+    xcdn_document_free(doc);
+}
+
+/* ── Test: scatter-gather serialization ──────────────────────────────── */
+
+static char *join_iovec(const xcdn_iovec_list_t *list) {
+    char *buf = (char *)malloc(list->bytes + 1);
+    if (!buf) return NULL;
+    size_t at = 0;
+    for (size_t i = 0; i < list->len; i++) {
+        memcpy(buf + at, list->iov[i].base, list->iov[i].len);
+        at += list->iov[i].len;
+    }
+    buf[at] = '\0';
+    return buf;
+}
+
+static void test_serialize_iovec(void) {
+    printf("  test_serialize_iovec\n");
+    size_t big = 100000;
+    char *payload = (char *)malloc(big + 1);
+    ASSERT(payload != NULL, "payload allocated");
+    for (size_t i = 0; i < big; i++) payload[i] = (char)('a' + i % 26);
+    payload[big] = '\0';
+
+    xcdn_document_t *doc = xcdn_document_new();
+    xcdn_value_t *obj = xcdn_value_object();
+    xcdn_object_set(obj, "plain", xcdn_node_new(xcdn_value_string(payload)));
+    payload[big / 2] = '\n';   /* escaped in the middle */
+    xcdn_object_set(obj, "escaped", xcdn_node_new(xcdn_value_string(payload)));
+    xcdn_object_set(obj, "small", xcdn_node_new(xcdn_value_int(1)));
+    xcdn_document_push_value(doc, xcdn_node_new(obj));
+    const char *plain = xcdn_object_get(obj, "plain")->value->data.string;
+
+    xcdn_format_t fmts[3] = {
+        xcdn_format_default(), xcdn_format_compact(), {true, 4, false}
+    };
+    for (int f = 0; f < 3; f++) {
+        xcdn_iovec_list_t list;
+        ASSERT_EQ_INT(xcdn_to_iovec(doc, fmts[f], 0, &list), 0, "gather ok");
+        char *seq = xcdn_to_string_with_format(doc, fmts[f]);
+        char *joined = join_iovec(&list);
+        ASSERT(seq != NULL && joined != NULL, "outputs built");
+        ASSERT_EQ_INT(list.bytes, strlen(seq), "total length");
+        ASSERT(strcmp(joined, seq) == 0, "pieces join to the serializer output");
+
+        int referenced = 0;
+        for (size_t i = 0; i < list.len; i++)
+            if (list.iov[i].base == plain && list.iov[i].len == big) referenced = 1;
+        ASSERT(referenced, "large string referenced in place");
+        ASSERT(list.len == 7, "two runs of the escaped string referenced");
+        ASSERT(list.scratch_cap < 1024, "scratch holds only the structure");
+        free(joined);
+        free(seq);
+        xcdn_iovec_list_free(&list);
+    }
+
+    /* Lazily decoded bytes echo their source text in place */
+    xcdn_error_t err;
+    size_t b64_len = 8000;
+    char *src = (char *)malloc(b64_len + 16);
+    ASSERT(src != NULL, "source allocated");
+    memcpy(src, "[b\"", 3);
+    memset(src + 3, 'A', b64_len);
+    memcpy(src + 3 + b64_len, "\", d\"1.5\"]", 11);
+    xcdn_parse_options_t opts = xcdn_parse_options_default();
+    opts.lazy_bytes = true;
+    xcdn_document_t *bytes_doc =
+        xcdn_parse_str_with_options(src, strlen(src), opts, &err);
+    ASSERT(bytes_doc != NULL, "bytes document parses");
+    xcdn_iovec_list_t list;
+    ASSERT_EQ_INT(xcdn_to_iovec(bytes_doc, xcdn_format_compact(), 0, &list), 0,
+                  "gather ok");
+    ASSERT_EQ_INT(list.len, 3, "bytes text referenced");
+    char *joined = join_iovec(&list);
+    char *seq = xcdn_to_string_compact(bytes_doc);
+    ASSERT(seq != NULL && joined != NULL, "outputs built");
+    ASSERT(strcmp(joined, seq) == 0, "bytes output identical");
+    free(joined);
+    free(seq);
+    xcdn_iovec_list_free(&list);
+
+    /* A threshold above every run copies everything into one piece */
+    ASSERT_EQ_INT(xcdn_to_iovec(doc, xcdn_format_compact(), 1u << 30, &list), 0,
+                  "gather ok");
+    ASSERT_EQ_INT(list.len, 1, "single piece");
+    ASSERT(list.iov[0].base == list.scratch, "piece is the scratch buffer");
+    xcdn_iovec_list_free(&list);
+    ASSERT_EQ_INT(xcdn_to_iovec(NULL, xcdn_format_compact(), 0, &list), -1,
+                  "NULL document rejected");
+
+    xcdn_document_free(bytes_doc);
+    free(src);
+    xcdn_document_free(doc);
+    free(payload);
+}
+
+/* ── Test: streaming writer ───────────────────────────────────────────── */
+
+static void write_sample(xcdn_writer_t *w) {
+    xcdn_writer_directive(w, "schema");
+    xcdn_writer_string(w, "https://example.com/s.xcdn");
+
+    xcdn_writer_begin_object(w);
+    xcdn_writer_key(w, "name");
+    xcdn_writer_string(w, "svc \"a\"");
+    xcdn_writer_key(w, "needs quotes");
+    xcdn_writer_int(w, -7);
+    xcdn_writer_key(w, "ports");
+    xcdn_writer_begin_array(w);
+    xcdn_writer_int(w, 8080);
+    xcdn_writer_float(w, 1.5);
+    xcdn_writer_bool(w, true);
+    xcdn_writer_null(w);
+    xcdn_writer_end(w);
+    xcdn_writer_key(w, "empty");
+    xcdn_writer_begin_object(w);
+    xcdn_writer_end(w);
+    xcdn_writer_key(w, "none");
+    xcdn_writer_begin_array(w);
+    xcdn_writer_end(w);
+    xcdn_writer_key(w, "admin");
+    xcdn_writer_annotation(w, "deprecated");
+    xcdn_writer_begin_annotation(w, "range");
+    xcdn_writer_int(w, 1);
+    xcdn_writer_begin_array(w);
+    xcdn_writer_string(w, "x");
+    xcdn_writer_int(w, 2);
+    xcdn_writer_end(w);
+    xcdn_writer_end(w);
+    xcdn_writer_tag(w, "user");
+    xcdn_writer_begin_object(w);
+    xcdn_writer_key(w, "id");
+    xcdn_writer_uuid(w, "550e8400-e29b-41d4-a716-446655440000");
+    xcdn_writer_key(w, "cost");
+    xcdn_writer_decimal(w, "19.99");
+    xcdn_writer_key(w, "at");
+    xcdn_writer_datetime(w, "2025-01-15T10:30:00Z");
+    xcdn_writer_key(w, "ttl");
+    xcdn_writer_duration(w, "PT30S");
+    xcdn_writer_end(w);
+    xcdn_writer_key(w, "icon");
+    xcdn_writer_annotation(w, "mime");
+    xcdn_writer_bytes(w, (const uint8_t *)"hello", 5);
+    xcdn_writer_end(w);
+
+    xcdn_writer_int(w, 42);
+    xcdn_writer_tag(w, "last");
+    xcdn_writer_begin_array(w);
+    xcdn_writer_string(w, "tail");
+    xcdn_writer_end(w);
+}
+
+static void test_writer(void) {
+    printf("  test_writer\n");
+    xcdn_format_t fmts[3] = {
+        xcdn_format_default(), xcdn_format_compact(), {true, 4, false}
+    };
+    for (int f = 0; f < 3; f++) {
+        xcdn_writer_t *w = xcdn_writer_new(fmts[f], NULL, NULL);
+        ASSERT(w != NULL, "writer created");
+        write_sample(w);
+        size_t len = 0;
+        char *text = xcdn_writer_finish_string(w, &len);
+        ASSERT(text != NULL, "writer finished");
+        ASSERT_EQ_INT(len, strlen(text), "length reported");
+
+        /* Same text as serializing the parsed document */
+        xcdn_error_t err;
+        xcdn_document_t *doc = xcdn_parse(text, &err);
+        ASSERT(doc != NULL, "writer output parses");
+        ASSERT_EQ_INT(doc->values_len, 3, "three top-level values");
+        char *ser = xcdn_to_string_with_format(doc, fmts[f]);
+        ASSERT(strcmp(ser, text) == 0, "writer output matches serializer");
+        free(ser);
+
+        /* Writing existing nodes gives the same text */
+        w = xcdn_writer_new(fmts[f], NULL, NULL);
+        xcdn_writer_directive(w, "schema");
+        xcdn_writer_string(w, "https://example.com/s.xcdn");
+        for (size_t i = 0; i < doc->values_len; i++)
+            xcdn_writer_node(w, doc->values[i]);
+        char *copy = xcdn_writer_finish_string(w, NULL);
+        ASSERT(copy && strcmp(copy, text) == 0, "node output matches");
+        free(copy);
+        xcdn_document_free(doc);
+        free(text);
+    }
+
+    xcdn_writer_t *w = xcdn_writer_new(xcdn_format_compact(), NULL, NULL);
+    xcdn_writer_begin_object(w);
+    xcdn_writer_key(w, "a");
+    xcdn_writer_tag(w, "t");
+    xcdn_writer_begin_array(w);
+    xcdn_writer_int(w, 1);
+    xcdn_writer_int(w, 2);
+    xcdn_writer_end(w);
+    xcdn_writer_key(w, "b c");
+    xcdn_writer_annotation(w, "x");
+    xcdn_writer_string(w, "tab\there");
+    xcdn_writer_end(w);
+    char *text = xcdn_writer_finish_string(w, NULL);
+    ASSERT(text && strcmp(text, "{a: #t [1,2],\"b c\": @x \"tab\\there\"}") == 0,
+           "compact writer output");
+    free(text);
+
+    /* Sink mode delivers large output in chunks */
+    collect_t c = {NULL, 0, 0};
+    w = xcdn_writer_new(xcdn_format_default(), collect_sink, &c);
+    xcdn_document_t *doc = xcdn_document_new();
+    xcdn_value_t *arr = xcdn_value_array();
+    xcdn_writer_begin_array(w);
+    for (int i = 0; i < 50000; i++) {
+        xcdn_writer_begin_object(w);
+        xcdn_writer_key(w, "id");
+        xcdn_writer_int(w, i);
+        xcdn_writer_end(w);
+        xcdn_value_t *obj = xcdn_value_object();
+        xcdn_object_set(obj, "id", xcdn_node_new(xcdn_value_int(i)));
+        xcdn_array_push(arr, xcdn_node_new(obj));
+    }
+    xcdn_writer_end(w);
+    xcdn_document_push_value(doc, xcdn_node_new(arr));
+    ASSERT_EQ_INT(xcdn_writer_finish(w), 0, "sink writer finished");
+    char *seq = xcdn_to_string_pretty(doc);
+    ASSERT(c.calls > 1, "output delivered in several chunks");
+    ASSERT(c.buf && strcmp(seq, c.buf) == 0, "sink output matches serializer");
+    free(seq);
+    free(c.buf);
+    xcdn_document_free(doc);
+
+#ifndef NDEBUG
+    w = xcdn_writer_new(xcdn_format_compact(), NULL, NULL);
+    xcdn_writer_begin_object(w);
+    xcdn_writer_int(w, 1);
+    ASSERT_EQ_INT(xcdn_writer_error(w), XCDN_WRITER_MISUSE, "value without key");
+    ASSERT(xcdn_writer_finish_string(w, NULL) == NULL, "failed writer has no text");
+
+    w = xcdn_writer_new(xcdn_format_compact(), NULL, NULL);
+    xcdn_writer_int(w, 1);
+    xcdn_writer_end(w);
+    ASSERT_EQ_INT(xcdn_writer_error(w), XCDN_WRITER_MISUSE, "unbalanced end");
+    ASSERT_EQ_INT(xcdn_writer_finish(w), XCDN_WRITER_MISUSE, "finish reports misuse");
+
+    w = xcdn_writer_new(xcdn_format_compact(), NULL, NULL);
+    xcdn_writer_begin_array(w);
+    xcdn_writer_key(w, "k");
+    ASSERT_EQ_INT(xcdn_writer_error(w), XCDN_WRITER_MISUSE, "key in an array");
+    ASSERT_EQ_INT(xcdn_writer_finish(w), XCDN_WRITER_MISUSE, "error is sticky");
+
+    w = xcdn_writer_new(xcdn_format_compact(), NULL, NULL);
+    xcdn_writer_begin_array(w);
+    xcdn_writer_int(w, 1);
+    ASSERT_EQ_INT(xcdn_writer_finish(w), XCDN_WRITER_MISUSE, "open container at finish");
+#endif
+}
+
 /* ── Main ─────────────────────────────────────────────────────────────── */
 
 int main(void) {
@@ -259,11 +645,15 @@ int main(void) {
     test_serialize_roundtrip_pretty_and_compact();
     test_serialize_trailing_commas();
     test_serialize_string_escapes();
+    test_serialize_string_flags();
     test_serialize_all_types();
     test_serialize_roundtrip_reparse();
     test_serialize_compact();
     test_serialize_decorations();
     test_serialize_prolog();
+    test_serialize_parallel();
+    test_serialize_iovec();
+    test_writer();
 
     printf("\n%d/%d tests passed\n", tests_passed, tests_run);
     return tests_passed == tests_run ? 0 : 1;
@@ -0,0 +1,305 @@
+/*
+ * Freeze and snapshot holder tests for xCDN-C.
+ */
+
+#include "xcdn.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef __STDC_NO_THREADS__
+#include <threads.h>
+#include <stdatomic.h>
+#endif
+
+static int tests_run = 0;
+static int tests_passed = 0;
+
+#define ASSERT(cond, msg) do { \
+    tests_run++; \
+    if (!(cond)) { \
+        fprintf(stderr, "  FAIL [%s:%d]: %s\n", __FILE__, __LINE__, msg); \
+        return; \
+    } \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_EQ_INT(a, b, msg) ASSERT((a) == (b), msg)
+
+/* ── Test: frozen documents reject mutation ───────────────────────────── */
+
+static void test_freeze_blocks_mutators(void) {
+    printf("  test_freeze_blocks_mutators\n");
+    xcdn_error_t err;
+    xcdn_document_t *doc = xcdn_parse("{ a: @range(1, 2) 1, list: [1, 2] }", &err);
+    ASSERT(doc != NULL, "parse succeeded");
+    ASSERT(!xcdn_document_is_frozen(doc), "not frozen after parse");
+
+    xcdn_document_freeze(doc);
+    ASSERT(xcdn_document_is_frozen(doc), "frozen");
+
+    xcdn_value_t *obj = doc->values[0]->value;
+    xcdn_node_t *extra = xcdn_node_new(xcdn_value_int(9));
+    xcdn_object_set(obj, "b", extra);
+    ASSERT_EQ_INT((int)xcdn_object_len(obj), 2, "object_set ignored");
+
+    xcdn_value_t *list = xcdn_object_get(obj, "list")->value;
+    xcdn_array_push(list, extra);
+    ASSERT_EQ_INT((int)xcdn_array_len(list), 2, "array_push ignored");
+    xcdn_node_free(extra);
+
+    xcdn_node_add_tag(doc->values[0], "late");
+    ASSERT(!xcdn_node_has_tag(doc->values[0], "late"), "add_tag ignored");
+
+    xcdn_node_t *a = xcdn_object_get(obj, "a");
+    xcdn_value_t *arg = xcdn_value_int(3);
+    xcdn_annotation_push_arg(&a->annotations[0], arg);
+    ASSERT_EQ_INT((int)xcdn_annotation_arg_count(&a->annotations[0]), 2,
+                  "annotation_push_arg ignored");
+    xcdn_value_free(arg);
+
+    xcdn_node_t *more = xcdn_node_new(xcdn_value_null());
+    xcdn_document_push_value(doc, more);
+    ASSERT_EQ_INT((int)doc->values_len, 1, "push_value ignored");
+    xcdn_node_free(more);
+
+    xcdn_document_free(doc);
+}
+
+/* ── Test: identical subtrees are shared ──────────────────────────────── */
+
+static void test_share_subtrees(void) {
+    printf("  test_share_subtrees\n");
+    const char *src =
+        "{ a: @mime(\"x\") #t { port: 80, hosts: [\"h1\", \"h2\"] },\n"
+        "  b: @mime(\"x\") #t { port: 80, hosts: [\"h1\", \"h2\"] },\n"
+        "  c: @mime(\"y\") #t { port: 80, hosts: [\"h1\", \"h2\"] },\n"
+        "  d: [1.0, 1.00, 1.0] }";
+    xcdn_parse_options_t opts = xcdn_parse_options_default();
+    opts.raw_numbers = true;
+    opts.record_spans = true;
+    xcdn_error_t err;
+    xcdn_document_t *doc = xcdn_parse_str_with_options(src, strlen(src), opts, &err);
+    ASSERT(doc != NULL, "parse succeeded");
+    char *before = xcdn_to_string_compact(doc);
+
+    size_t replaced = xcdn_document_share_subtrees(doc);
+    ASSERT(replaced > 0, "some nodes replaced");
+    xcdn_value_t *root = doc->values[0]->value;
+    xcdn_node_t *a = xcdn_object_get(root, "a");
+    xcdn_node_t *b = xcdn_object_get(root, "b");
+    xcdn_node_t *c = xcdn_object_get(root, "c");
+    ASSERT(a == b, "identical decorated subtrees shared");
+    ASSERT(a != c, "different annotation arguments not shared");
+    ASSERT(xcdn_object_get(a->value, "hosts") == xcdn_object_get(c->value, "hosts"),
+           "common child shared");
+    ASSERT(a->flags & XCDN_FLAG_FROZEN, "shared node frozen");
+    ASSERT(!(c->flags & XCDN_FLAG_FROZEN), "unique node stays mutable");
+    xcdn_value_t *arg = xcdn_value_int(1);
+    xcdn_annotation_push_arg(&a->annotations[0], arg);
+    ASSERT_EQ_INT((int)xcdn_annotation_arg_count(&b->annotations[0]), 1,
+                  "shared annotation not extended");
+    xcdn_value_free(arg);
+
+    xcdn_value_t *d = xcdn_object_get(root, "d")->value;
+    ASSERT(xcdn_array_get(d, 0) == xcdn_array_get(d, 2), "same number text shared");
+    ASSERT(xcdn_array_get(d, 0) != xcdn_array_get(d, 1), "different text kept");
+
+    ASSERT(xcdn_node_equal(a, b), "shared nodes equal");
+    ASSERT(!xcdn_node_equal(a, c), "different nodes not equal");
+    ASSERT(xcdn_node_span(doc, a, NULL, NULL), "canonical node keeps its span");
+
+    char *after = xcdn_to_string_compact(doc);
+    ASSERT(before && after && strcmp(before, after) == 0, "serialization unchanged");
+    free(before);
+    free(after);
+
+    /* Replacing one owner's reference leaves the other intact */
+    xcdn_object_set(root, "a", xcdn_node_new(xcdn_value_null()));
+    ASSERT_EQ_INT((int)xcdn_value_as_int(xcdn_object_get(b->value, "port")->value),
+                  80, "other owner still valid");
+    xcdn_document_free(doc);
+
+    xcdn_document_t *x = xcdn_parse("[{ k: [1, 2] }]", &err);
+    xcdn_document_t *y = xcdn_parse("[{ k: [1, 2] }]", &err);
+    ASSERT(xcdn_node_equal(x->values[0], y->values[0]), "deep equality across documents");
+    xcdn_document_freeze(x);
+    ASSERT_EQ_INT((int)xcdn_document_share_subtrees(x), 0, "frozen document untouched");
+    xcdn_document_free(x);
+    xcdn_document_free(y);
+}
+
+/* ── Test: compaction keeps the document readable ────────────────────── */
+
+static void test_document_compact(void) {
+    printf("  test_document_compact\n");
+    const char *src =
+        "$schema: \"https://example.org/a-rather-long-schema-url.xcdn\",\n"
+        "{ rows: [{ id: 1, name: \"first row with a long name\" },\n"
+        "         { id: 2, name: \"first row with a long name\" }],\n"
+        "  a_key_longer_than_sixteen: @range(1, [2.50, 123456789012345678901]) #hard\n"
+        "      { blob: b\"aGVsbG8gd29ybGQ=\", n: 1.250000000000000000 },\n"
+        "  same: [\"x\", \"x\"], shared: { k: [1, 2] }, again: { k: [1, 2] } }";
+    xcdn_parse_options_t opts = xcdn_parse_options_default();
+    opts.raw_numbers = true;
+    opts.record_spans = true;
+    opts.lazy_bytes = true;
+    opts.dedup_strings = 1;
+    opts.shape_objects = true;
+    opts.share_subtrees = true;
+    xcdn_error_t err;
+    xcdn_document_t *doc = xcdn_parse_str_with_options(src, strlen(src), opts, &err);
+    ASSERT(doc != NULL, "parse succeeded");
+    char *before = xcdn_to_string_pretty(doc);
+    xcdn_node_t *old_root = doc->values[0];
+
+    ASSERT(xcdn_document_compact(doc), "compacted");
+    ASSERT(xcdn_document_is_frozen(doc), "compaction freezes");
+    ASSERT(doc->values[0] != old_root, "tree relocated");
+    char *after = xcdn_to_string_pretty(doc);
+    ASSERT(before && after && strcmp(before, after) == 0, "serialization unchanged");
+    free(before);
+    free(after);
+
+    xcdn_value_t *root = doc->values[0]->value;
+    ASSERT(xcdn_object_get(root, "shared") == xcdn_object_get(root, "again"),
+           "shared subtree still shared");
+    xcdn_node_t *rows = xcdn_object_get(root, "rows");
+    ASSERT(xcdn_array_get(rows->value, 0)->value->data.object.shape ==
+           xcdn_array_get(rows->value, 1)->value->data.object.shape, "shape shared");
+    ASSERT_EQ_INT((int)xcdn_value_as_int(
+        xcdn_object_get(xcdn_array_get(rows->value, 1)->value, "id")->value), 2,
+        "shaped lookup");
+    xcdn_node_t *n = xcdn_get_path(doc, "a_key_longer_than_sixteen");
+    ASSERT(n && xcdn_node_has_tag(n, "hard"), "tag kept");
+    ASSERT_EQ_INT((int)xcdn_annotation_arg_count(xcdn_node_find_annotation(n, "range")),
+                  2, "annotation args kept");
+    size_t len;
+    const uint8_t *blob = xcdn_value_as_bytes(xcdn_object_get(n->value, "blob")->value, &len);
+    ASSERT(blob && len == 11 && memcmp(blob, "hello world", 11) == 0, "lazy bytes decode");
+    xcdn_span_t start;
+    ASSERT(xcdn_node_span(doc, n, &start, NULL) && start.line == 5, "span follows node");
+
+    xcdn_node_t *extra = xcdn_node_new(xcdn_value_null());
+    xcdn_array_push(rows->value, extra);
+    ASSERT_EQ_INT((int)xcdn_array_len(rows->value), 2, "mutators are no-ops");
+    xcdn_node_free(extra);
+    xcdn_value_t *arg = xcdn_value_int(3);
+    xcdn_annotation_push_arg(&n->annotations[0], arg);
+    ASSERT_EQ_INT((int)xcdn_annotation_arg_count(&n->annotations[0]), 2,
+                  "annotation args stay in the block");
+    xcdn_value_free(arg);
+    ASSERT(xcdn_document_compact(doc), "compacting again");
+    ASSERT(xcdn_get_path(doc, "a_key_longer_than_sixteen") != NULL, "still readable");
+    xcdn_document_free(doc);
+}
+
+/* ── Test: publish replaces the current document ──────────────────────── */
+
+static void test_snapshot_publish(void) {
+    printf("  test_snapshot_publish\n");
+    xcdn_error_t err;
+    xcdn_snapshot_t *snap = xcdn_snapshot_new(xcdn_parse("v: 1", &err));
+    ASSERT(snap != NULL, "holder created");
+
+    unsigned ticket;
+    const xcdn_document_t *d = xcdn_snapshot_acquire(snap, &ticket);
+    ASSERT(xcdn_document_is_frozen(d), "published document is frozen");
+    ASSERT_EQ_INT((int)xcdn_value_as_int(xcdn_document_get_key(d, "v")->value),
+                  1, "v=1");
+    xcdn_snapshot_release(snap, ticket);
+
+    xcdn_snapshot_publish(snap, xcdn_parse("v: 2", &err));
+    d = xcdn_snapshot_acquire(snap, &ticket);
+    ASSERT_EQ_INT((int)xcdn_value_as_int(xcdn_document_get_key(d, "v")->value),
+                  2, "v=2 after publish");
+    xcdn_snapshot_release(snap, ticket);
+
+    xcdn_snapshot_free(snap);
+}
+
+/* ── Test: concurrent readers during reloads ──────────────────────────── */
+
+#ifndef __STDC_NO_THREADS__
+
+typedef struct {
+    xcdn_snapshot_t *snap;
+    atomic_int      *stop;
+    int              bad;
+} reader_ctx_t;
+
+static int reader_main(void *arg) {
+    reader_ctx_t *ctx = (reader_ctx_t *)arg;
+    while (!atomic_load(ctx->stop)) {
+        unsigned ticket;
+        const xcdn_document_t *d = xcdn_snapshot_acquire(ctx->snap, &ticket);
+        xcdn_node_t *a = xcdn_document_get_key(d, "a");
+        xcdn_node_t *b = xcdn_document_get_key(d, "b");
+        /* Every published document satisfies b == a * 2 */
+        if (!a || !b ||
+            xcdn_value_as_int(b->value) != 2 * xcdn_value_as_int(a->value))
+            ctx->bad++;
+        xcdn_snapshot_release(ctx->snap, ticket);
+        thrd_yield();
+    }
+    return 0;
+}
+
+static void test_snapshot_concurrent_readers(void) {
+    printf("  test_snapshot_concurrent_readers\n");
+    xcdn_error_t err;
+    xcdn_snapshot_t *snap = xcdn_snapshot_new(xcdn_parse("a: 0, b: 0", &err));
+    ASSERT(snap != NULL, "holder created");
+
+    atomic_int stop;
+    atomic_init(&stop, 0);
+    reader_ctx_t ctx[4];
+    thrd_t threads[4];
+    for (int i = 0; i < 4; i++) {
+        ctx[i].snap = snap;
+        ctx[i].stop = &stop;
+        ctx[i].bad = 0;
+        thrd_create(&threads[i], reader_main, &ctx[i]);
+    }
+
+    char src[64];
+    for (int i = 1; i <= 200; i++) {
+        snprintf(src, sizeof(src), "a: %d, b: %d", i, 2 * i);
+        xcdn_snapshot_publish(snap, xcdn_parse(src, &err));
+    }
+
+    atomic_store(&stop, 1);
+    int bad = 0;
+    for (int i = 0; i < 4; i++) {
+        thrd_join(threads[i], NULL);
+        bad += ctx[i].bad;
+    }
+    ASSERT_EQ_INT(bad, 0, "readers always saw a consistent document");
+
+    unsigned ticket;
+    const xcdn_document_t *d = xcdn_snapshot_acquire(snap, &ticket);
+    ASSERT_EQ_INT((int)xcdn_value_as_int(xcdn_document_get_key(d, "a")->value),
+                  200, "last publish wins");
+    xcdn_snapshot_release(snap, ticket);
+
+    xcdn_snapshot_free(snap);
+}
+
+#endif
+
+/* ── Main ─────────────────────────────────────────────────────────────── */
+
+int main(void) {
+    printf("=== Snapshot Tests ===\n");
+
+    test_freeze_blocks_mutators();
+    test_share_subtrees();
+    test_document_compact();
+    test_snapshot_publish();
+#ifndef __STDC_NO_THREADS__
+    test_snapshot_concurrent_readers();
+#endif
+
+    printf("\n%d/%d tests passed\n", tests_passed, tests_run);
+    return tests_passed == tests_run ? 0 : 1;
+}
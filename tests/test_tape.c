@@ -0,0 +1,163 @@
+/*
+ * Tape representation tests for xCDN-C.
+ */
+
+#include "xcdn.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int tests_run = 0;
+static int tests_passed = 0;
+
+#define ASSERT(cond, msg) do { \
+    tests_run++; \
+    if (!(cond)) { \
+        fprintf(stderr, "  FAIL [%s:%d]: %s\n", __FILE__, __LINE__, msg); \
+        return; \
+    } \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_EQ_INT(a, b, msg) ASSERT((a) == (b), msg)
+#define ASSERT_EQ_STR(a, b, msg) ASSERT(strcmp((a), (b)) == 0, msg)
+
+static const char *SAMPLE =
+    "$schema: \"https://example.org/s.xcdn\",\n"
+    "$version: 2,\n"
+    "name: \"svc\",\n"
+    "limits: @range(1, [2, 3]) #hard { cpu: 2.5, mem: d\"512.0\", \"odd key\": -7 },\n"
+    "ids: [u\"550e8400-e29b-41d4-a716-446655440000\", t\"2024-01-01T00:00:00Z\",\n"
+    "      r\"PT5M\", b\"aGVsbG8=\", null, true, \"line\\nbreak\"],\n"
+    "empty: { list: [], obj: {} }\n";
+
+/* ── Test: tape output matches the tree ───────────────────────────────── */
+
+static void test_tape_roundtrip(void) {
+    printf("  test_tape_roundtrip\n");
+    xcdn_error_t err;
+    xcdn_document_t *doc = xcdn_parse(SAMPLE, &err);
+    ASSERT(doc != NULL, "parse succeeded");
+    xcdn_tape_t *tape = xcdn_tape_from_document(doc);
+    ASSERT(tape != NULL, "tape built");
+
+    xcdn_format_t fmts[2] = { xcdn_format_default(), xcdn_format_compact() };
+    for (int i = 0; i < 2; i++) {
+        char *a = xcdn_to_string_with_format(doc, fmts[i]);
+        char *b = xcdn_tape_to_string(tape, fmts[i]);
+        ASSERT_EQ_STR(a, b, "tape serializes like the tree");
+        free(a);
+        free(b);
+    }
+
+    xcdn_document_t *back = xcdn_tape_to_document(tape);
+    ASSERT(back != NULL, "document rebuilt");
+    char *a = xcdn_to_string_pretty(doc);
+    char *b = xcdn_to_string_pretty(back);
+    ASSERT_EQ_STR(a, b, "rebuilt document serializes the same");
+    free(a);
+    free(b);
+
+    xcdn_document_free(back);
+    xcdn_tape_free(tape);
+    xcdn_document_free(doc);
+}
+
+/* ── Test: cursor navigation ──────────────────────────────────────────── */
+
+static void test_tape_cursor(void) {
+    printf("  test_tape_cursor\n");
+    xcdn_error_t err;
+    xcdn_document_t *doc = xcdn_parse(SAMPLE, &err);
+    xcdn_tape_t *tape = xcdn_tape_from_document(doc);
+    xcdn_document_free(doc);
+    ASSERT(tape != NULL, "tape built");
+
+    xcdn_tape_cursor_t root, c;
+    ASSERT(xcdn_tape_begin(tape, &root), "has a top-level node");
+    ASSERT(xcdn_tape_type(&root) == XCDN_VAL_OBJECT, "root object");
+    ASSERT_EQ_INT((int)xcdn_tape_len(&root), 4, "four keys");
+    ASSERT(!xcdn_tape_next(&root), "single top-level node");
+
+    ASSERT(xcdn_tape_find(&root, "limits", &c), "find limits");
+    ASSERT(xcdn_tape_has_tag(&c, "hard"), "tag");
+    ASSERT(xcdn_tape_has_annotation(&c, "range"), "annotation");
+    ASSERT(!xcdn_tape_has_tag(&c, "range"), "annotation is not a tag");
+    xcdn_tape_cursor_t f;
+    ASSERT(xcdn_tape_find(&c, "cpu", &f) && xcdn_tape_as_float(&f) == 2.5, "float");
+    ASSERT(xcdn_tape_find(&c, "odd key", &f) && xcdn_tape_as_int(&f) == -7, "int");
+    size_t len;
+    ASSERT(xcdn_tape_find(&c, "mem", &f), "find mem");
+    ASSERT_EQ_STR(xcdn_tape_as_string(&f, &len), "512.0", "decimal text");
+    ASSERT_EQ_INT((int)len, 5, "decimal length");
+
+    /* Siblings skip whole subtrees, decorations included */
+    ASSERT(xcdn_tape_next(&c), "next after limits");
+    ASSERT_EQ_STR(xcdn_tape_key(&c, NULL), "ids", "key of sibling");
+    ASSERT(xcdn_tape_down(&c), "into ids");
+    int n = 1;
+    while (xcdn_tape_next(&c)) n++;
+    ASSERT_EQ_INT(n, 7, "seven items");
+    ASSERT(xcdn_tape_key(&c, NULL) == NULL, "array items have no key");
+    ASSERT_EQ_STR(xcdn_tape_as_string(&c, NULL), "line\\nbreak", "raw escapes kept");
+
+    ASSERT(xcdn_tape_find(&root, "ids", &c) && xcdn_tape_down(&c), "ids again");
+    xcdn_tape_next(&c);
+    xcdn_tape_next(&c);
+    xcdn_tape_next(&c);
+    const uint8_t *bytes = xcdn_tape_as_bytes(&c, &len);
+    ASSERT(bytes && len == 5 && memcmp(bytes, "hello", 5) == 0, "decoded bytes");
+
+    ASSERT(xcdn_tape_find(&root, "empty", &c), "find empty");
+    ASSERT(xcdn_tape_find(&c, "list", &f), "find list");
+    ASSERT(!xcdn_tape_down(&f), "empty array has no child");
+    ASSERT(xcdn_tape_next(&f) && xcdn_tape_type(&f) == XCDN_VAL_OBJECT, "obj follows");
+    ASSERT(!xcdn_tape_next(&f), "last key");
+    ASSERT(!xcdn_tape_find(&root, "missing", &c), "missing key");
+
+    xcdn_tape_free(tape);
+}
+
+/* ── Test: numbers kept as text ───────────────────────────────────────── */
+
+static void test_tape_raw_numbers(void) {
+    printf("  test_tape_raw_numbers\n");
+    const char *src = "[1.50, 1e3, 12345678901234567890, 7]";
+    xcdn_parse_options_t opts = xcdn_parse_options_default();
+    opts.raw_numbers = true;
+    xcdn_error_t err;
+    xcdn_document_t *doc = xcdn_parse_str_with_options(src, strlen(src), opts, &err);
+    ASSERT(doc != NULL, "parse succeeded");
+    xcdn_tape_t *tape = xcdn_tape_from_document(doc);
+    char *out = xcdn_tape_to_string(tape, xcdn_format_compact());
+    ASSERT_EQ_STR(out, "[1.50,1e3,12345678901234567890,7]", "source text echoed");
+    free(out);
+
+    xcdn_tape_cursor_t c;
+    ASSERT(xcdn_tape_begin(tape, &c) && xcdn_tape_down(&c), "into array");
+    ASSERT(xcdn_tape_as_float(&c) == 1.5, "converted float");
+    ASSERT(xcdn_tape_next(&c) && xcdn_tape_as_float(&c) == 1000.0, "converted exponent");
+    ASSERT(xcdn_tape_next(&c) && xcdn_tape_next(&c) && xcdn_tape_as_int(&c) == 7,
+           "skips number text");
+
+    xcdn_document_t *back = xcdn_tape_to_document(tape);
+    out = xcdn_to_string_compact(back);
+    ASSERT_EQ_STR(out, "[1.50,1e3,12345678901234567890,7]", "rebuilt keeps text");
+    free(out);
+    xcdn_document_free(back);
+    xcdn_tape_free(tape);
+    xcdn_document_free(doc);
+}
+
+/* ── Main ─────────────────────────────────────────────────────────────── */
+
+int main(void) {
+    printf("=== Tape Tests ===\n");
+
+    test_tape_roundtrip();
+    test_tape_cursor();
+    test_tape_raw_numbers();
+
+    printf("\n%d/%d tests passed\n", tests_passed, tests_run);
+    return tests_passed == tests_run ? 0 : 1;
+}